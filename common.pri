@@ -69,6 +69,12 @@ snapshot_boot {
     LIBS += -lsnapshot-boot
 }
 
+################################################################################
+# Compile out debug level logs, e.g. EXTRA_QMAKEVARS_PRE += "CONFIG_BUILD+=disable_debug_log"
+contains(CONFIG_BUILD, disable_debug_log) {
+    DEFINES += DISABLE_DEBUG_LOG
+}
+
 
 ################################################################################
 # Path and CFLAGS
@@ -86,10 +92,17 @@ PKGCONFIG += glib-2.0
 
 INCLUDEPATH += $$VPATH
 
-isEmpty(CHROMIUM_SRC_DIR) {
-    error("CHROMIUM_SRC_DIR was not set")
+# EXTRA_QMAKEVARS_PRE += "CONFIG_BUILD+=headless" builds core and the
+# benchmarks against the stub engine headers instead of Chromium
+contains(CONFIG_BUILD, headless) {
+    INCLUDEPATH += ./src/benchmark/stub
+    !contains(PKGCONFIG, PmLogLib): PKGCONFIG += PmLogLib
+} else {
+    isEmpty(CHROMIUM_SRC_DIR) {
+        error("CHROMIUM_SRC_DIR was not set")
+    }
+    INCLUDEPATH += $${CHROMIUM_SRC_DIR}
 }
-INCLUDEPATH += $${CHROMIUM_SRC_DIR}
 
 DEFINES += PRELOADMANAGER_ENABLED
 
@@ -111,4 +124,4 @@ OBJECTS_DIR = $$DESTDIR/.obj
 MOC_DIR = $$DESTDIR/.moc
 LIBS += -L$$DESTDIR
 
-LIBS += -lcbe
+!contains(CONFIG_BUILD, headless): LIBS += -lcbe
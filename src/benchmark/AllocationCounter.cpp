@@ -0,0 +1,125 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <errno.h>
+#include <malloc.h>
+#include <stddef.h>
+
+// glibc entry points behind malloc, so the wrappers below do not recurse
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+}
+
+static std::atomic<uint64_t> s_count(0);
+static std::atomic<uint64_t> s_bytes(0);
+static std::atomic<int64_t> s_liveCount(0);
+static std::atomic<int64_t> s_liveBytes(0);
+
+static inline void countAllocation(size_t size)
+{
+    s_count.fetch_add(1, std::memory_order_relaxed);
+    s_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+static inline void* countLive(void* ptr)
+{
+    if (ptr) {
+        s_liveCount.fetch_add(1, std::memory_order_relaxed);
+        s_liveBytes.fetch_add(malloc_usable_size(ptr), std::memory_order_relaxed);
+    }
+    return ptr;
+}
+
+static inline void countFree(void* ptr)
+{
+    if (ptr) {
+        s_liveCount.fetch_sub(1, std::memory_order_relaxed);
+        s_liveBytes.fetch_sub(malloc_usable_size(ptr), std::memory_order_relaxed);
+    }
+}
+
+extern "C" void* malloc(size_t size)
+{
+    countAllocation(size);
+    return countLive(__libc_malloc(size));
+}
+
+extern "C" void* calloc(size_t count, size_t size)
+{
+    countAllocation(count * size);
+    return countLive(__libc_calloc(count, size));
+}
+
+extern "C" void* realloc(void* ptr, size_t size)
+{
+    // Growing a buffer in place still costs the allocator a call
+    countAllocation(size);
+
+    size_t oldSize = ptr ? malloc_usable_size(ptr) : 0;
+    void* result = __libc_realloc(ptr, size);
+    if (!result && size)
+        return 0;
+
+    // realloc(ptr, 0) frees ptr
+    if (ptr) {
+        s_liveCount.fetch_sub(1, std::memory_order_relaxed);
+        s_liveBytes.fetch_sub(oldSize, std::memory_order_relaxed);
+    }
+    return countLive(result);
+}
+
+extern "C" void* memalign(size_t alignment, size_t size)
+{
+    countAllocation(size);
+    return countLive(__libc_memalign(alignment, size));
+}
+
+extern "C" void* aligned_alloc(size_t alignment, size_t size)
+{
+    return memalign(alignment, size);
+}
+
+extern "C" int posix_memalign(void** ptr, size_t alignment, size_t size)
+{
+    void* result = memalign(alignment, size);
+    if (!result)
+        return ENOMEM;
+    *ptr = result;
+    return 0;
+}
+
+extern "C" void free(void* ptr)
+{
+    countFree(ptr);
+    __libc_free(ptr);
+}
+
+AllocationCount allocationCount()
+{
+    AllocationCount result;
+    result.count = s_count.load(std::memory_order_relaxed);
+    result.bytes = s_bytes.load(std::memory_order_relaxed);
+    result.liveCount = s_liveCount.load(std::memory_order_relaxed);
+    result.liveBytes = s_liveBytes.load(std::memory_order_relaxed);
+    return result;
+}
@@ -0,0 +1,34 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <stdint.h>
+
+// Heap allocations made by the whole process so far, and the blocks still
+// allocated. The allocator entry points are wrapped in AllocationCounter.cpp,
+// which covers operator new and the Qt containers as well.
+struct AllocationCount {
+    uint64_t count;
+    uint64_t bytes;
+    int64_t liveCount;
+    int64_t liveBytes;   // usable size of the live blocks
+};
+
+AllocationCount allocationCount();
+
+#endif // ALLOCATIONCOUNTER_H
@@ -0,0 +1,54 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <stdio.h>
+
+#include <QElapsedTimer>
+
+// Keeps a result for the --json output and the --baseline comparison,
+// see BenchmarkMain.cpp
+void recordBenchmarkResult(const char* name, int iterations, double nsPerOp);
+
+// Runs body() iterations times and prints the average cost of one call.
+// Keep the body free of work that does not belong to the measured path.
+template <typename Body>
+double runBenchmark(const char* name, int iterations, Body body)
+{
+    // Warm up caches and lazy initialization outside of the measurement
+    for (int i = 0; i < iterations / 10; i++)
+        body(i);
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; i++)
+        body(i);
+    double nsPerCall = static_cast<double>(timer.nsecsElapsed()) / iterations;
+
+    printf("%-48s %12d iterations %10.1f ns/op\n", name, iterations, nsPerCall);
+    recordBenchmarkResult(name, iterations, nsPerCall);
+    return nsPerCall;
+}
+
+// Benchmark groups, see BenchmarkMain.cpp
+void runCoreBenchmarks();
+void runLifecycleBenchmarks();
+void runLogBenchmarks();
+
+#endif // BENCHMARK_H
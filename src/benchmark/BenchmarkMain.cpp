@@ -0,0 +1,145 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+
+#include "Benchmark.h"
+
+struct BenchmarkGroup {
+    const char* name;
+    void (*run)();
+};
+
+static const BenchmarkGroup s_groups[] = {
+    { "log", runLogBenchmarks },
+    { "lifecycle", runLifecycleBenchmarks },
+    { "core", runCoreBenchmarks },
+};
+
+struct BenchmarkResult {
+    std::string name;
+    int iterations;
+    double nsPerOp;
+};
+
+static std::vector<BenchmarkResult> s_results;
+
+void recordBenchmarkResult(const char* name, int iterations, double nsPerOp)
+{
+    BenchmarkResult result;
+    result.name = name;
+    result.iterations = iterations;
+    result.nsPerOp = nsPerOp;
+    s_results.push_back(result);
+}
+
+static bool writeResults(const char* path)
+{
+    QJsonArray benchmarks;
+    for (std::vector<BenchmarkResult>::const_iterator it = s_results.begin(); it != s_results.end(); ++it) {
+        QJsonObject result;
+        result["name"] = QString::fromStdString(it->name);
+        result["iterations"] = it->iterations;
+        result["nsPerOp"] = it->nsPerOp;
+        benchmarks.append(result);
+    }
+
+    QJsonObject results;
+    results["benchmarks"] = benchmarks;
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    file.write(QJsonDocument(results).toJson());
+    return true;
+}
+
+// Prints the change of every result against the same benchmark in the
+// --json output of an earlier run
+static bool compareResults(const char* path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QMap<QString, double> baseline;
+    QJsonArray benchmarks = QJsonDocument::fromJson(file.readAll()).object()["benchmarks"].toArray();
+    for (int i = 0; i < benchmarks.size(); i++) {
+        QJsonObject result = benchmarks.at(i).toObject();
+        baseline[result["name"].toString()] = result["nsPerOp"].toDouble();
+    }
+
+    printf("== baseline %s\n", path);
+    for (std::vector<BenchmarkResult>::const_iterator it = s_results.begin(); it != s_results.end(); ++it) {
+        QMap<QString, double>::const_iterator before = baseline.find(QString::fromStdString(it->name));
+        if (before == baseline.end() || before.value() <= 0) {
+            printf("%-48s %10s -> %10.1f ns/op\n", it->name.c_str(), "new", it->nsPerOp);
+            continue;
+        }
+        printf("%-48s %10.1f -> %10.1f ns/op %+7.1f%%\n", it->name.c_str(), before.value(), it->nsPerOp,
+            (it->nsPerOp - before.value()) * 100 / before.value());
+    }
+    return true;
+}
+
+// Usage: WebAppMgrBenchmark [--json=<file>] [--baseline=<file>] [group...]
+// All groups run when none is given. --json writes the results, which a
+// later run, e.g. of the next commit, compares itself to with --baseline.
+int main(int argc, char** argv)
+{
+    const char* jsonPath = 0;
+    const char* baselinePath = 0;
+    std::vector<const char*> groups;
+    for (int arg = 1; arg < argc; arg++) {
+        if (!strncmp(argv[arg], "--json=", 7))
+            jsonPath = argv[arg] + 7;
+        else if (!strncmp(argv[arg], "--baseline=", 11))
+            baselinePath = argv[arg] + 11;
+        else
+            groups.push_back(argv[arg]);
+    }
+
+    for (size_t i = 0; i < sizeof(s_groups) / sizeof(s_groups[0]); i++) {
+        bool selected = groups.empty();
+        for (size_t group = 0; group < groups.size() && !selected; group++)
+            selected = !strcmp(groups[group], s_groups[i].name);
+
+        if (!selected)
+            continue;
+
+        printf("== %s\n", s_groups[i].name);
+        s_groups[i].run();
+    }
+
+    if (jsonPath && !writeResults(jsonPath)) {
+        fprintf(stderr, "Cannot write %s\n", jsonPath);
+        return 1;
+    }
+    if (baselinePath && !compareResults(baselinePath)) {
+        fprintf(stderr, "Cannot read %s\n", baselinePath);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,298 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "Benchmark.h"
+#include "StubWebEngine.h"
+
+#include <string>
+
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include "ApplicationDescription.h"
+#include "WebAppManager.h"
+#include "WebProcessManager.h"
+
+static const int kWaitTimeoutMs = 10000;
+static const int kAppCounts[] = { 5, 50, 200 };
+static const int kPolicyGroupCounts[] = { 10, 200 };
+static const int kDeviceInfoKeyCount = 30;
+
+class AppCountListener : public StubEngineListener {
+public:
+    void loadFinished(const QString& appId) override { m_loaded.insert(appId); }
+    void appDeleted(const QString& appId) override { m_loaded.remove(appId); }
+
+    int loadedCount() const { return m_loaded.size(); }
+
+private:
+    QSet<QString> m_loaded;
+};
+
+static std::string scaledName(const char* name, int count)
+{
+    return std::string(name) + "/" + std::to_string(count);
+}
+
+// Description of a store app as the application manager sends it, about 3 KB
+static std::string realisticAppDescription()
+{
+    const QString appId = QStringLiteral("com.vendor.app.realistic");
+    const QString folder = QStringLiteral("/media/cryptofs/apps/usr/palm/applications/") + appId;
+
+    QJsonObject desc = QJsonDocument::fromJson(QByteArray::fromStdString(StubWebEngine::appDescription(appId))).object();
+    desc["main"] = folder + QStringLiteral("/index.html");
+    desc["folderPath"] = folder;
+    desc["title"] = QStringLiteral("Realistic App");
+    desc["vendor"] = QStringLiteral("Vendor Inc.");
+    desc["icon"] = folder + QStringLiteral("/icon.png");
+    desc["largeIcon"] = folder + QStringLiteral("/largeIcon.png");
+    desc["bgImage"] = folder + QStringLiteral("/bgImage.png");
+    desc["trustLevel"] = QStringLiteral("trusted");
+    desc["version"] = QStringLiteral("3.2.17");
+    desc["resolution"] = QStringLiteral("1920x1080");
+    desc["handlesRelaunch"] = true;
+    desc["disableBackHistoryAPI"] = true;
+    desc["v8SnapshotFile"] = folder + QStringLiteral("/snapshot_blob.bin");
+
+    QJsonArray keyFilterTable;
+    for (int key = 0; key < 24; key++) {
+        QJsonObject entry;
+        entry["from"] = QString::number(400 + key);
+        entry["to"] = QString::number(10000 + key);
+        entry["modifier"] = QStringLiteral("0");
+        keyFilterTable.append(entry);
+    }
+    desc["keyFilterTable"] = keyFilterTable;
+
+    QJsonArray layers;
+    for (int layer = 0; layer < 4; layer++) {
+        QJsonObject entry;
+        entry["name"] = QStringLiteral("layer%1").arg(layer);
+        entry["z"] = QString::number(layer * 100);
+        layers.append(entry);
+    }
+    QJsonObject ownerInfo;
+    ownerInfo["allowAnonymous"] = false;
+    ownerInfo["layers"] = layers;
+    QJsonObject windowGroup;
+    windowGroup["name"] = QStringLiteral("realisticGroup");
+    windowGroup["owner"] = true;
+    windowGroup["ownerInfo"] = ownerInfo;
+    desc["windowGroup"] = windowGroup;
+
+    QJsonObject accessibility;
+    accessibility["supportsAudioGuidance"] = true;
+    desc["accessibility"] = accessibility;
+
+    QJsonArray bundleVersions;
+    bundleVersions.append(QStringLiteral("2.5.0"));
+    bundleVersions.append(QStringLiteral("2.6.0"));
+    bundleVersions.append(QStringLiteral("2.7.0"));
+    desc["supportedEnyoBundleVersions"] = bundleVersions;
+
+    QJsonArray permissions;
+    for (int permission = 0; permission < 12; permission++)
+        permissions.append(QStringLiteral("permission.group%1.read").arg(permission));
+    QJsonObject vendorExtension;
+    vendorExtension["requiredPermissions"] = permissions;
+    vendorExtension["userAgent"] = QStringLiteral("Mozilla/5.0 (Web0S; Linux/SmartTV) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/53.0 Safari/537.36");
+    vendorExtension["allowCrossDomain"] = true;
+    desc["vendorExtension"] = vendorExtension;
+
+    return QJsonDocument(desc).toJson(QJsonDocument::Compact).toStdString();
+}
+
+// Web process policy with groupCount groups of four app ids each. Every
+// tenth group is a wildcard group, the policy ends with trust level groups.
+static QByteArray webProcessPolicy(int groupCount)
+{
+    QJsonArray groups;
+    for (int group = 0; group < groupCount; group++) {
+        QJsonObject entry;
+        if (group % 10 == 9) {
+            entry["id"] = QStringLiteral("com.vendor.wild%1.*").arg(group);
+        } else {
+            QStringList ids;
+            for (int app = 0; app < 4; app++)
+                ids.append(QStringLiteral("com.vendor.group%1.app%2").arg(group).arg(app));
+            entry["id"] = ids.join(',');
+        }
+        entry["memoryCache"] = QStringLiteral("32MB");
+        entry["codeCache"] = QStringLiteral("8MB");
+        groups.append(entry);
+    }
+
+    QJsonObject trusted;
+    trusted["trustLevel"] = QStringLiteral("trusted");
+    groups.append(trusted);
+    QJsonObject defaultTrust;
+    defaultTrust["trustLevel"] = QStringLiteral("default,community");
+    groups.append(defaultTrust);
+
+    QJsonObject policy;
+    policy["createProcessForEachApp"] = false;
+    policy["webProcessList"] = groups;
+    return QJsonDocument(policy).toJson();
+}
+
+static ApplicationDescription* policyAppDescription(const QString& appId, const char* trustLevel)
+{
+    QJsonObject desc = QJsonDocument::fromJson(QByteArray::fromStdString(StubWebEngine::appDescription(appId))).object();
+    desc["trustLevel"] = QString::fromLatin1(trustLevel);
+    return ApplicationDescription::fromJsonString(QJsonDocument(desc).toJson(QJsonDocument::Compact).constData());
+}
+
+static void runDescriptionBenchmarks()
+{
+    const std::string desc = realisticAppDescription();
+    std::string name = "fromJsonString/" + std::to_string(desc.size()) + "B";
+    runBenchmark(name.c_str(), 10000, [&](int) {
+        delete ApplicationDescription::fromJsonString(desc.c_str());
+    });
+}
+
+static void runProcessKeyBenchmarks()
+{
+    const QString policyPath = QDir::tempPath() + QStringLiteral("/wam-benchmark-policy.json");
+
+    for (size_t i = 0; i < sizeof(kPolicyGroupCounts) / sizeof(kPolicyGroupCounts[0]); i++) {
+        int groups = kPolicyGroupCounts[i];
+
+        QFile file(policyPath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            printf("cannot write %s\n", qPrintable(policyPath));
+            return;
+        }
+        file.write(webProcessPolicy(groups));
+        file.close();
+
+        // The policy is read when the web process manager is created
+        StubWebAppManagerConfig::setWebProcessConfigPath(policyPath);
+        StubWebProcessManager manager;
+
+        ApplicationDescription* exact = policyAppDescription(QStringLiteral("com.vendor.group%1.app3").arg(groups - 2), "default");
+        ApplicationDescription* wildcard = policyAppDescription(QStringLiteral("com.vendor.wild%1.tv").arg(groups - 1), "default");
+        ApplicationDescription* trust = policyAppDescription(QStringLiteral("com.other.app"), "community");
+
+        runBenchmark(scaledName("getProcessKey exact id", groups).c_str(), 10000, [&](int) {
+            manager.getProcessKey(exact);
+        });
+        runBenchmark(scaledName("getProcessKey wildcard", groups).c_str(), 10000, [&](int) {
+            manager.getProcessKey(wildcard);
+        });
+        runBenchmark(scaledName("getProcessKey trust level", groups).c_str(), 10000, [&](int) {
+            manager.getProcessKey(trust);
+        });
+
+        delete exact;
+        delete wildcard;
+        delete trust;
+    }
+
+    StubWebAppManagerConfig::setWebProcessConfigPath(QString());
+    QFile::remove(policyPath);
+}
+
+static bool runRunningAppBenchmarks(int count)
+{
+    WebAppManager* manager = WebAppManager::instance();
+    AppCountListener listener;
+    StubWebEngine::setListener(&listener);
+
+    int errCode = 0;
+    std::string errMsg;
+    for (int app = 0; app < count; app++) {
+        QString appId = QStringLiteral("com.webos.app.core%1").arg(app);
+        if (manager->launch(StubWebEngine::appDescription(appId), "{}", "", errCode, errMsg).empty()) {
+            printf("%s: launch failed, %d %s\n", qPrintable(appId), errCode, errMsg.c_str());
+            break;
+        }
+    }
+
+    bool ok = StubWebEngine::runMainLoopUntil([&]() { return listener.loadedCount() == count; }, kWaitTimeoutMs);
+    if (ok) {
+        const QString lastAppId = QStringLiteral("com.webos.app.core%1").arg(count - 1);
+        const QString missingAppId = QStringLiteral("com.webos.app.missing");
+
+        runBenchmark(scaledName("findAppById hit", count).c_str(), 100000, [&](int) {
+            manager->findAppById(lastAppId);
+        });
+        runBenchmark(scaledName("findAppById miss", count).c_str(), 100000, [&](int) {
+            manager->findAppById(missingAppId);
+        });
+        runBenchmark(scaledName("runningApps", count).c_str(), 10000, [&](int) {
+            manager->runningApps();
+        });
+        runBenchmark(scaledName("list", count).c_str(), 10000, [&](int) {
+            manager->list(true);
+        });
+        runBenchmark(scaledName("postRunningAppList", count).c_str(), 1000, [&](int) {
+            manager->postRunningAppList();
+        });
+    }
+
+    manager->closeAllApps();
+    ok = StubWebEngine::runMainLoopUntil([&]() { return listener.loadedCount() == 0; }, kWaitTimeoutMs) && ok;
+
+    StubWebEngine::setListener(0);
+    return ok;
+}
+
+static void runDeviceInfoBenchmarks()
+{
+    DeviceInfo* deviceInfo = StubWebEngine::deviceInfo();
+    for (int key = 0; key < kDeviceInfoKeyCount; key++)
+        deviceInfo->setDeviceInfo(QStringLiteral("property%1").arg(key), QStringLiteral("value%1").arg(key));
+
+    const QString hit = QStringLiteral("property%1").arg(kDeviceInfoKeyCount - 1);
+    const QString miss = QStringLiteral("missingProperty");
+    QString value;
+
+    runBenchmark("getDeviceInfo hit", 1000000, [&](int) {
+        WebAppManager::instance()->getDeviceInfo(hit, value);
+    });
+    runBenchmark("getDeviceInfo miss", 1000000, [&](int) {
+        WebAppManager::instance()->getDeviceInfo(miss, value);
+    });
+}
+
+// Calls on the launch path and the queries behind listRunningApps and
+// PalmSystem, at the app, policy and property counts of a loaded device.
+// Scaled benchmarks are named "<call>/<count>".
+void runCoreBenchmarks()
+{
+    StubWebEngine::install();
+
+    runDescriptionBenchmarks();
+    runProcessKeyBenchmarks();
+
+    for (size_t i = 0; i < sizeof(kAppCounts) / sizeof(kAppCounts[0]); i++) {
+        if (!runRunningAppBenchmarks(kAppCounts[i])) {
+            printf("timed out after %d ms waiting for %d apps\n", kWaitTimeoutMs, kAppCounts[i]);
+            break;
+        }
+    }
+
+    runDeviceInfoBenchmarks();
+}
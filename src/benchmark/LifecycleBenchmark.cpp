@@ -0,0 +1,231 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "AllocationCounter.h"
+#include "Benchmark.h"
+#include "LaunchTimeline.h"
+#include "StubWebEngine.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QSet>
+#include <QStringList>
+
+static const int kDefaultAppCount = 16;
+static const int kWaitTimeoutMs = 10000;
+
+// Latency and heap allocation samples of one lifecycle phase, one sample per app
+struct Phase {
+    explicit Phase(const char* phaseName)
+        : name(phaseName)
+        , allocations(0)
+        , allocatedBytes(0)
+    {
+    }
+
+    const char* name;
+    std::vector<double> samplesMs;
+    uint64_t allocations;
+    uint64_t allocatedBytes;
+};
+
+class PhaseTimer {
+public:
+    PhaseTimer()
+    {
+        m_allocations = allocationCount();
+        m_timer.start();
+    }
+
+    void stop(Phase& phase)
+    {
+        phase.samplesMs.push_back(static_cast<double>(m_timer.nsecsElapsed()) / 1000000);
+        AllocationCount now = allocationCount();
+        phase.allocations += now.count - m_allocations.count;
+        phase.allocatedBytes += now.bytes - m_allocations.bytes;
+    }
+
+private:
+    QElapsedTimer m_timer;
+    AllocationCount m_allocations;
+};
+
+class LifecycleListener : public StubEngineListener {
+public:
+    void loadFinished(const QString& appId) override { m_loaded.insert(appId); }
+    void firstFrame(const QString& appId) override { m_framed.insert(appId); }
+    void appDeleted(const QString& appId) override { m_deleted.insert(appId); }
+
+    bool isLoaded(const QString& appId) const { return m_loaded.contains(appId); }
+    bool isFramed(const QString& appId) const { return m_framed.contains(appId); }
+    bool isDeleted(const QString& appId) const { return m_deleted.contains(appId); }
+
+    void reset(const QString& appId)
+    {
+        m_loaded.remove(appId);
+        m_framed.remove(appId);
+        m_deleted.remove(appId);
+    }
+
+private:
+    QSet<QString> m_loaded;
+    QSet<QString> m_framed;
+    QSet<QString> m_deleted;
+};
+
+static double percentile(std::vector<double> samples, int percent)
+{
+    std::sort(samples.begin(), samples.end());
+    return samples.at((samples.size() - 1) * percent / 100);
+}
+
+static void printPhase(const Phase& phase)
+{
+    if (phase.samplesMs.empty()) {
+        printf("%-40s no samples\n", phase.name);
+        return;
+    }
+
+    int count = static_cast<int>(phase.samplesMs.size());
+    double p50 = percentile(phase.samplesMs, 50);
+    printf("%-40s %4d apps  p50 %8.2f  p90 %8.2f  max %8.2f ms %10.1f allocs/op %12.0f bytes/op\n",
+        phase.name, count,
+        p50, percentile(phase.samplesMs, 90),
+        *std::max_element(phase.samplesMs.begin(), phase.samplesMs.end()),
+        static_cast<double>(phase.allocations) / count,
+        static_cast<double>(phase.allocatedBytes) / count);
+
+    // The median goes to --json, the tail is too noisy for a comparison
+    std::string name = std::string("lifecycle/") + phase.name + " p50";
+    recordBenchmarkResult(name.c_str(), count, p50 * 1000000);
+}
+
+// Launches, relaunches, suspends, resumes, crashes and closes N apps one
+// after another through WebAppManager on the stub engine. "call" phases are
+// the synchronous WebAppManager call, the others run until the stub engine
+// reports the asynchronous step, so they include the synthetic delays.
+// The number of apps is WAM_BENCHMARK_APPS, the delays are StubEngineDelays.
+void runLifecycleBenchmarks()
+{
+    StubWebEngine::install();
+    LifecycleListener listener;
+    StubWebEngine::setListener(&listener);
+
+    int appCount = qgetenv("WAM_BENCHMARK_APPS").toInt();
+    if (appCount <= 0)
+        appCount = kDefaultAppCount;
+
+    const StubEngineDelays& delays = StubWebEngine::delays();
+    printf("%d apps, delays: load %d ms, frame %d ms, unload %d ms\n",
+        appCount, delays.loadMs, delays.frameMs, delays.unloadMs);
+
+    Phase launchCall("launch (call)");
+    Phase launchLoaded("launch to load finished");
+    Phase launchFramed("launch to first frame");
+    Phase relaunchCall("relaunch (call)");
+    Phase suspendCall("suspend (call)");
+    Phase resumeCall("resume (call)");
+    Phase crashReloaded("crash to reload finished");
+    Phase closeCall("close (call)");
+    Phase closeDeleted("close to teardown");
+
+    WebAppManager* manager = WebAppManager::instance();
+    QStringList appIds;
+    for (int i = 0; i < appCount; i++)
+        appIds.append(QStringLiteral("com.webos.app.benchmark%1").arg(i));
+
+    bool ok = true;
+    for (int i = 0; i < appCount && ok; i++) {
+        const QString& appId = appIds.at(i);
+        const std::string desc = StubWebEngine::appDescription(appId);
+        int errCode = 0;
+        std::string errMsg;
+        listener.reset(appId);
+
+        // Same bracketing of the launch as the luna launchApp handler
+        PhaseTimer launch;
+        LaunchTimeline::begin(appId.toStdString());
+        std::string instanceId = manager->launch(desc, "{}", "", errCode, errMsg);
+        LaunchTimeline::endRequest(!instanceId.empty());
+        launch.stop(launchCall);
+        if (instanceId.empty()) {
+            printf("%s: launch failed, %d %s\n", qPrintable(appId), errCode, errMsg.c_str());
+            ok = false;
+            break;
+        }
+        ok = StubWebEngine::runMainLoopUntil([&]() { return listener.isLoaded(appId); }, kWaitTimeoutMs);
+        launch.stop(launchLoaded);
+        ok = ok && StubWebEngine::runMainLoopUntil([&]() { return listener.isFramed(appId); }, kWaitTimeoutMs);
+        launch.stop(launchFramed);
+        if (!ok)
+            break;
+
+        PhaseTimer relaunch;
+        LaunchTimeline::begin(appId.toStdString());
+        LaunchTimeline::endRequest(!manager->launch(desc, "{}", "", errCode, errMsg).empty());
+        relaunch.stop(relaunchCall);
+
+        WebAppBase* app = manager->findAppById(appId);
+        if (!app) {
+            printf("%s: not running after launch\n", qPrintable(appId));
+            ok = false;
+            break;
+        }
+
+        PhaseTimer suspend;
+        app->onStageDeactivated();
+        suspend.stop(suspendCall);
+
+        PhaseTimer resume;
+        app->onStageActivated();
+        resume.stop(resumeCall);
+
+        listener.reset(appId);
+        PhaseTimer crash;
+        static_cast<StubWebPage*>(app->page())->simulateCrash();
+        ok = ok && StubWebEngine::runMainLoopUntil([&]() { return listener.isLoaded(appId); }, kWaitTimeoutMs);
+        crash.stop(crashReloaded);
+    }
+
+    // Close in launch order, like the oldest apps going away first
+    for (int i = 0; i < appCount && ok; i++) {
+        const QString& appId = appIds.at(i);
+
+        PhaseTimer close;
+        manager->onKillApp(appId.toStdString());
+        close.stop(closeCall);
+        ok = StubWebEngine::runMainLoopUntil([&]() { return listener.isDeleted(appId); }, kWaitTimeoutMs);
+        close.stop(closeDeleted);
+    }
+
+    if (!ok)
+        printf("timed out after %d ms waiting for the stub engine\n", kWaitTimeoutMs);
+
+    printPhase(launchCall);
+    printPhase(launchLoaded);
+    printPhase(launchFramed);
+    printPhase(relaunchCall);
+    printPhase(suspendCall);
+    printPhase(resumeCall);
+    printPhase(crashReloaded);
+    printPhase(closeCall);
+    printPhase(closeDeleted);
+
+    StubWebEngine::setListener(0);
+}
@@ -0,0 +1,68 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "Benchmark.h"
+#include "LogManager.h"
+
+#include <QByteArray>
+#include <QString>
+
+static const int kLogIterations = 1000000;
+
+// Cost of log statements on the launch path while their level is disabled.
+// "unchecked" is a plain PmLog call, which formats its arguments before
+// PmLogLib looks at the level; the LOG_* macros check the level first.
+// The last case is LOG_DEBUG with the binary logger running.
+void runLogBenchmarks()
+{
+    PmLogContext context = GetWAMPmLogContext();
+    PmLogLevel savedLevel = kPmLogLevel_Info;
+    PmLogGetContextLevel(context, &savedLevel);
+    PmLogSetContextLevel(context, kPmLogLevel_Warning);
+
+    const QString appId = QStringLiteral("com.webos.app.benchmark");
+    const QString url = QStringLiteral("file:///usr/palm/applications/com.webos.app.benchmark/index.html");
+
+    runBenchmark("info disabled, unchecked", kLogIterations, [&](int i) {
+        PmLogInfo(context, MSGID_APP_LOADED, 2, PMLOGKS("APP_ID", qPrintable(appId)), PMLOGKFV("PID", "%d", i),
+            "url: %s", qPrintable(QStringLiteral("%1?%2").arg(url).arg(i)));
+    });
+
+    runBenchmark("info disabled, LOG_INFO", kLogIterations, [&](int i) {
+        LOG_INFO(MSGID_APP_LOADED, 2, PMLOGKS("APP_ID", qPrintable(appId)), PMLOGKFV("PID", "%d", i),
+            "url: %s", qPrintable(QStringLiteral("%1?%2").arg(url).arg(i)));
+    });
+
+    runBenchmark("debug disabled, unchecked", kLogIterations, [&](int i) {
+        PmLogDebug(context, "[%s] progress %d", qPrintable(appId), i);
+    });
+
+    runBenchmark("debug disabled, LOG_DEBUG", kLogIterations, [&](int i) {
+        LOG_DEBUG("[%s] progress %d", qPrintable(appId), i);
+    });
+
+    // Records the flush thread cannot keep up with are dropped, which costs
+    // about the same as a stored record
+    BinaryLogger::start("/dev/null");
+    const QByteArray appIdUtf8 = appId.toUtf8();
+    runBenchmark("debug, BinaryLogger", kLogIterations, [&](int i) {
+        LOG_DEBUG("[%s] progress %d", appIdUtf8.constData(), i);
+    });
+    BinaryLogger::stop();
+
+    PmLogSetContextLevel(context, savedLevel);
+}
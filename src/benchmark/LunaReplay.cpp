@@ -0,0 +1,374 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Replays a luna trace recorded by WAM (WAM_LUNA_TRACE=<path>, see
+// LunaTrace.h) against WebAppManager on the stub engine:
+//   wam-lunareplay [--speed=<factor>] [--settle=<ms>] [--json=<file>] <trace>
+// --speed=2 replays twice as fast as recorded, 0 sends the calls back to
+// back. Every app runs on the stub app factory, whatever its subType.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <glib.h>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "LaunchTimeline.h"
+#include "LunaTrace.h"
+#include "StagedLaunch.h"
+#include "StubWebEngine.h"
+#include "WebAppManagerService.h"
+
+static const int kDefaultSettleMs = 1000;
+
+// Counts the staged launches of a replay as their stages finish
+class ReplayLaunchClient : public StagedLaunch::Client {
+public:
+    ReplayLaunchClient(int* finished, int* failed)
+        : m_finished(finished)
+        , m_failed(failed)
+    {
+    }
+
+    void launchFinished(const std::string& instanceId, int errCode, const std::string& errMsg) override
+    {
+        (*m_finished)++;
+        if (instanceId.empty())
+            (*m_failed)++;
+        delete this;
+    }
+
+private:
+    int* m_finished;
+    int* m_failed;
+};
+
+// Serves the methods the stub engine can, through the request handling of
+// WebAppManagerServiceLuna. Cold launches are staged as on the bus.
+class ReplayService : public WebAppManagerService {
+public:
+    ReplayService()
+        : m_subscriptions(0)
+        , m_stagedLaunches(0)
+        , m_stagedFinished(0)
+        , m_stagedFailed(0)
+    {
+    }
+
+    int subscriptions() const { return m_subscriptions; }
+    int stagedLaunches() const { return m_stagedLaunches; }
+    int stagedFinished() const { return m_stagedFinished; }
+    int stagedFailed() const { return m_stagedFailed; }
+
+    bool startService() override { return true; }
+
+    QJsonObject launchApp(QJsonObject request) override
+    {
+        StagedLaunch* staged = 0;
+        QJsonObject reply = onLaunchAppRequest(stubRequest(request), &staged);
+        if (!staged)
+            return reply;
+
+        m_stagedLaunches++;
+        staged->setClient(new ReplayLaunchClient(&m_stagedFinished, &m_stagedFailed));
+        return success();
+    }
+
+    QJsonObject launchApps(QJsonObject request)
+    {
+        QJsonArray apps = request["apps"].toArray();
+        for (int i = 0; i < apps.size(); i++)
+            apps[i] = stubRequest(apps[i].toObject());
+        request["apps"] = apps;
+        return onLaunchAppsRequest(request);
+    }
+
+    QJsonObject closeApps(QJsonObject request) { return onCloseAppsRequest(request); }
+
+    QJsonObject killApp(QJsonObject request) override { return onKillAppRequest(request); }
+
+    QJsonObject logControl(QJsonObject request) override
+    {
+        return onLogControl(request["keys"].toString().toStdString(), request["value"].toString().toStdString());
+    }
+
+    QJsonObject setInspectorEnable(QJsonObject request) override { return success(); }
+
+    QJsonObject closeAllApps(QJsonObject request) override
+    {
+        QJsonObject reply;
+        reply["returnValue"] = onCloseAllApps();
+        return reply;
+    }
+
+    QJsonObject discardCodeCache(QJsonObject request) override { return success(); }
+
+    QJsonObject listRunningApps(QJsonObject request, bool subscribed) override
+    {
+        if (subscribed)
+            m_subscriptions++;
+        return runningAppsReply(list(request["includeSysApps"].toBool()));
+    }
+
+    QJsonObject closeByProcessId(QJsonObject request) override
+    {
+        return closeByInstanceId(request["processId"].toString());
+    }
+
+    QJsonObject getWebProcessSize(QJsonObject request) override { return getWebProcessProfiling(); }
+
+    QJsonObject getMetrics(QJsonObject request) override { return onGetMetrics(request["format"].toString() == QLatin1String("text")); }
+
+    QJsonObject clearBrowsingData(QJsonObject request) override
+    {
+        onClearBrowsingData(maskForBrowsingDataType("all"));
+        return success();
+    }
+
+    QJsonObject webProcessCreated(QJsonObject request, bool subscribed) override
+    {
+        if (subscribed)
+            m_subscriptions++;
+        return success();
+    }
+
+private:
+    // Only the stub factory is registered
+    static QJsonObject stubRequest(QJsonObject request)
+    {
+        if (request["appDesc"].isObject()) {
+            QJsonObject appDesc = request["appDesc"].toObject();
+            appDesc.remove(QStringLiteral("subType"));
+            request["appDesc"] = appDesc;
+        }
+        return request;
+    }
+
+    static QJsonObject success()
+    {
+        QJsonObject reply;
+        reply["returnValue"] = true;
+        return reply;
+    }
+
+    int m_subscriptions;
+    int m_stagedLaunches;
+    int m_stagedFinished;
+    int m_stagedFailed;
+};
+
+typedef QJsonObject (ReplayService::*ReplayHandler)(QJsonObject request);
+typedef QJsonObject (ReplayService::*ReplaySubscriptionHandler)(QJsonObject request, bool subscribed);
+
+struct ReplayMethod {
+    const char* name;
+    ReplayHandler handler;
+    ReplaySubscriptionHandler subscriptionHandler;
+};
+
+static const ReplayMethod s_methods[] = {
+    { "launchApp", &ReplayService::launchApp, 0 },
+    { "launchApps", &ReplayService::launchApps, 0 },
+    { "killApp", &ReplayService::killApp, 0 },
+    { "closeApps", &ReplayService::closeApps, 0 },
+    { "closeAllApps", &ReplayService::closeAllApps, 0 },
+    { "setInspectorEnable", &ReplayService::setInspectorEnable, 0 },
+    { "logControl", &ReplayService::logControl, 0 },
+    { "discardCodeCache", &ReplayService::discardCodeCache, 0 },
+    { "getWebProcessSize", &ReplayService::getWebProcessSize, 0 },
+    { "getMetrics", &ReplayService::getMetrics, 0 },
+    { "closeByProcessId", &ReplayService::closeByProcessId, 0 },
+    { "clearBrowsingData", &ReplayService::clearBrowsingData, 0 },
+    { "listRunningApps", 0, &ReplayService::listRunningApps },
+    { "webProcessCreated", 0, &ReplayService::webProcessCreated },
+};
+static const int kMethodCount = sizeof(s_methods) / sizeof(s_methods[0]);
+
+struct MethodStats {
+    MethodStats()
+        : errors(0)
+    {
+    }
+
+    int errors;
+    std::vector<double> durationMs;
+};
+
+static int lookupMethod(const std::string& name)
+{
+    for (int i = 0; i < kMethodCount; i++) {
+        if (name == s_methods[i].name)
+            return i;
+    }
+    return -1;
+}
+
+static double percentile(std::vector<double> samples, int percent)
+{
+    if (samples.empty())
+        return 0;
+    std::sort(samples.begin(), samples.end());
+    return samples.at((samples.size() - 1) * percent / 100);
+}
+
+static double maximum(const std::vector<double>& samples)
+{
+    return samples.empty() ? 0 : *std::max_element(samples.begin(), samples.end());
+}
+
+// Runs the main loop, where the stub engine completes its steps, for ms
+static void runMainLoopFor(int ms)
+{
+    StubWebEngine::runMainLoopUntil([]() { return false; }, ms);
+}
+
+static bool writeJson(const char* path, const std::vector<MethodStats>& stats, const std::vector<double>& lateMs,
+    double replayMs, int skipped, const ReplayService& service)
+{
+    QJsonArray methods;
+    for (int i = 0; i < kMethodCount; i++) {
+        if (stats[i].durationMs.empty())
+            continue;
+        QJsonObject method;
+        method["method"] = QString::fromLatin1(s_methods[i].name);
+        method["calls"] = static_cast<int>(stats[i].durationMs.size());
+        method["errors"] = stats[i].errors;
+        method["p50"] = percentile(stats[i].durationMs, 50);
+        method["p90"] = percentile(stats[i].durationMs, 90);
+        method["max"] = maximum(stats[i].durationMs);
+        methods.append(method);
+    }
+
+    QJsonObject result;
+    result["methods"] = methods;
+    result["skipped"] = skipped;
+    result["stagedLaunches"] = service.stagedLaunches();
+    result["stagedFailed"] = service.stagedFailed();
+    result["replayTime"] = replayMs;
+    result["lateP50"] = percentile(lateMs, 50);
+    result["lateMax"] = maximum(lateMs);
+
+    QFile file(QString::fromLocal8Bit(path));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    file.write(QJsonDocument(result).toJson());
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    double speed = 1;
+    int settleMs = kDefaultSettleMs;
+    const char* jsonPath = 0;
+    const char* tracePath = 0;
+    bool usage = false;
+    for (int arg = 1; arg < argc; arg++) {
+        if (!strncmp(argv[arg], "--speed=", 8))
+            speed = atof(argv[arg] + 8);
+        else if (!strncmp(argv[arg], "--settle=", 9))
+            settleMs = atoi(argv[arg] + 9);
+        else if (!strncmp(argv[arg], "--json=", 7))
+            jsonPath = argv[arg] + 7;
+        else if (strncmp(argv[arg], "--", 2) && !tracePath)
+            tracePath = argv[arg];
+        else
+            usage = true;
+    }
+    if (usage || !tracePath || speed < 0) {
+        fprintf(stderr, "Usage: wam-lunareplay [--speed=<factor>] [--settle=<ms>] [--json=<file>] <trace>\n");
+        return 2;
+    }
+
+    std::vector<LunaTrace::Record> records;
+    LunaTrace::Reader reader;
+    if (!reader.open(tracePath)) {
+        fprintf(stderr, "Not a WAM luna trace: %s\n", tracePath);
+        return 1;
+    }
+    LunaTrace::Record record;
+    while (reader.next(record))
+        records.push_back(record);
+
+    StubWebEngine::install();
+    ReplayService service;
+
+    std::vector<MethodStats> stats(kMethodCount);
+    std::vector<double> lateMs;
+    int skipped = 0;
+
+    // The trace starts with WAM, the replay with the first call
+    uint32_t firstMs = records.empty() ? 0 : records.front().timeMs;
+    gint64 startUs = g_get_monotonic_time();
+    for (size_t i = 0; i < records.size(); i++) {
+        const LunaTrace::Record& call = records[i];
+        int method = lookupMethod(call.method);
+        if (method < 0) {
+            skipped++;
+            continue;
+        }
+
+        if (speed > 0) {
+            gint64 dueUs = startUs + static_cast<gint64>((call.timeMs - firstMs) * 1000 / speed);
+            gint64 waitUs = dueUs - g_get_monotonic_time();
+            if (waitUs >= 1000)
+                runMainLoopFor(waitUs / 1000);
+            lateMs.push_back(std::max<gint64>(g_get_monotonic_time() - dueUs, 0) / 1000.0);
+        } else {
+            while (g_main_context_iteration(0, FALSE)) { }
+        }
+
+        QJsonObject request = QJsonDocument::fromJson(QByteArray::fromStdString(call.payload)).object();
+        gint64 callUs = g_get_monotonic_time();
+        QJsonObject reply = s_methods[method].handler
+            ? (service.*s_methods[method].handler)(request)
+            : (service.*s_methods[method].subscriptionHandler)(request, call.kind == LunaTrace::Subscription);
+        stats[method].durationMs.push_back((g_get_monotonic_time() - callUs) / 1000.0);
+        if (!reply["returnValue"].toBool(true))
+            stats[method].errors++;
+    }
+    double replayMs = (g_get_monotonic_time() - startUs) / 1000.0;
+
+    // Loads and closes started by the last calls
+    runMainLoopFor(settleMs);
+
+    printf("%-20s %8s %8s %9s %9s %9s\n", "method", "calls", "errors", "p50 ms", "p90 ms", "max ms");
+    for (int i = 0; i < kMethodCount; i++) {
+        if (stats[i].durationMs.empty())
+            continue;
+        printf("%-20s %8d %8d %9.2f %9.2f %9.2f\n", s_methods[i].name, static_cast<int>(stats[i].durationMs.size()),
+            stats[i].errors, percentile(stats[i].durationMs, 50), percentile(stats[i].durationMs, 90),
+            maximum(stats[i].durationMs));
+    }
+    printf("%d records in %.1f ms (recorded %u ms), %d skipped, %d subscriptions, late p50 %.2f max %.2f ms\n",
+        static_cast<int>(records.size()), replayMs, records.empty() ? 0 : records.back().timeMs - firstMs, skipped,
+        service.subscriptions(), percentile(lateMs, 50), maximum(lateMs));
+    printf("%d staged launches, %d finished, %d failed\n", service.stagedLaunches(), service.stagedFinished(),
+        service.stagedFailed());
+
+    if (jsonPath && !writeJson(jsonPath, stats, lateMs, replayMs, skipped, service)) {
+        fprintf(stderr, "Cannot write %s\n", jsonPath);
+        return 1;
+    }
+    return 0;
+}
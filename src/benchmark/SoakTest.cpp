@@ -0,0 +1,340 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Soak run of the app lifecycle on the stub engine, for leaks that only
+// show after days on a device:
+//   wam-soak [--iterations=<n>] [--interval=<n>] [--apps=<n>] [--unique-ids]
+//            [--output=<file>] [--max-slope=<metric>=<per 1000 iterations>]...
+// Every iteration launches, relaunches and closes one app, every fourth one
+// also crashes it before the close. Every --interval iterations, with all
+// apps closed, a snapshot of the process is taken. At the end the growth of
+// each metric is fitted over the snapshots and the run fails if one grows
+// faster than its limit. --output writes the snapshots as JSON lines, which
+// compare across builds. WAM_HIBERNATION_MAX_APPS and
+// WAM_HIBERNATION_TIMEOUT_MS also cover the hibernation path.
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <glib.h>
+
+#include <QSet>
+#include <QString>
+
+#include "AllocationCounter.h"
+#include "StubWebEngine.h"
+#include "Timer.h"
+#include "WebAppManager.h"
+#include "WebAppManagerConfig.h"
+
+static const int kWaitTimeoutMs = 10000;
+static const int kCrashEvery = 4;
+static const int kWarmupSnapshots = 2;
+
+enum Metric {
+    RssKb,
+    OpenFds,
+    HeapBlocks,
+    HeapBytes,
+    Apps,
+    Pages,
+    Timers,
+    RunningApps,
+    MetricCount
+};
+
+static const char* const kMetricNames[] = {
+    "rssKb",
+    "openFds",
+    "heapBlocks",
+    "heapBytes",
+    "apps",
+    "pages",
+    "timers",
+    "runningApps"
+};
+
+// Growth per 1000 iterations a metric may show before the run fails
+static const double kDefaultMaxSlopes[] = {
+    1024,
+    1,
+    200,
+    65536,
+    1,
+    1,
+    1,
+    1
+};
+
+struct Snapshot {
+    int iteration;
+    double elapsedMs;
+    double values[MetricCount];
+};
+
+class SoakListener : public StubEngineListener {
+public:
+    void loadFinished(const QString& appId) override { m_loaded.insert(appId); }
+    void firstFrame(const QString& appId) override { m_framed.insert(appId); }
+    void appDeleted(const QString& appId) override { m_deleted.insert(appId); }
+
+    bool isLoaded(const QString& appId) const { return m_loaded.contains(appId); }
+    bool isFramed(const QString& appId) const { return m_framed.contains(appId); }
+    bool isDeleted(const QString& appId) const { return m_deleted.contains(appId); }
+
+    // Keeps the sets small, they would show up as heap growth otherwise
+    void clear()
+    {
+        m_loaded.clear();
+        m_framed.clear();
+        m_deleted.clear();
+    }
+
+private:
+    QSet<QString> m_loaded;
+    QSet<QString> m_framed;
+    QSet<QString> m_deleted;
+};
+
+static double readRssKb()
+{
+    FILE* file = fopen("/proc/self/status", "r");
+    if (!file)
+        return 0;
+
+    char line[128];
+    double rss = 0;
+    while (fgets(line, sizeof(line), file)) {
+        if (!strncmp(line, "VmRSS:", 6)) {
+            rss = atof(line + 6);
+            break;
+        }
+    }
+    fclose(file);
+    return rss;
+}
+
+static double countOpenFds()
+{
+    DIR* dir = opendir("/proc/self/fd");
+    if (!dir)
+        return 0;
+
+    int count = 0;
+    while (struct dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] != '.')
+            count++;
+    }
+    closedir(dir);
+
+    // Without the descriptor of dir itself
+    return count - 1;
+}
+
+static Snapshot takeSnapshot(int iteration, gint64 startUs)
+{
+    Snapshot snapshot;
+    snapshot.iteration = iteration;
+    snapshot.elapsedMs = (g_get_monotonic_time() - startUs) / 1000.0;
+
+    AllocationCount heap = allocationCount();
+    snapshot.values[RssKb] = readRssKb();
+    snapshot.values[OpenFds] = countOpenFds();
+    snapshot.values[HeapBlocks] = heap.liveCount;
+    snapshot.values[HeapBytes] = heap.liveBytes;
+    snapshot.values[Apps] = StubWebApp::liveCount();
+    snapshot.values[Pages] = StubWebPage::liveCount();
+    snapshot.values[Timers] = Timer::liveCount();
+    snapshot.values[RunningApps] = WebAppManager::instance()->runningApps().size();
+    return snapshot;
+}
+
+static void writeSnapshot(FILE* out, const Snapshot& snapshot)
+{
+    fprintf(out, "{\"iteration\":%d,\"elapsed\":%.0f", snapshot.iteration, snapshot.elapsedMs);
+    for (int i = 0; i < MetricCount; i++)
+        fprintf(out, ",\"%s\":%.0f", kMetricNames[i], snapshot.values[i]);
+    fprintf(out, "}\n");
+    fflush(out);
+}
+
+// Least squares slope of a metric over the snapshots, per 1000 iterations
+static double slope(const std::vector<Snapshot>& snapshots, size_t first, int metric)
+{
+    double n = snapshots.size() - first;
+    double sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+    for (size_t i = first; i < snapshots.size(); i++) {
+        double x = snapshots[i].iteration / 1000.0;
+        double y = snapshots[i].values[metric];
+        sumX += x;
+        sumY += y;
+        sumXX += x * x;
+        sumXY += x * y;
+    }
+
+    double denominator = n * sumXX - sumX * sumX;
+    return denominator > 0 ? (n * sumXY - sumX * sumY) / denominator : 0;
+}
+
+static bool parseMaxSlope(const char* arg, double* maxSlopes)
+{
+    const char* equals = strchr(arg, '=');
+    if (!equals)
+        return false;
+
+    for (int i = 0; i < MetricCount; i++) {
+        if (!strncmp(arg, kMetricNames[i], equals - arg) && !kMetricNames[i][equals - arg]) {
+            maxSlopes[i] = atof(equals + 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = 2000;
+    int interval = 100;
+    int appCount = 8;
+    bool uniqueIds = false;
+    const char* outputPath = 0;
+    double maxSlopes[MetricCount];
+    std::copy(kDefaultMaxSlopes, kDefaultMaxSlopes + MetricCount, maxSlopes);
+
+    bool usage = false;
+    for (int arg = 1; arg < argc; arg++) {
+        if (!strncmp(argv[arg], "--iterations=", 13))
+            iterations = atoi(argv[arg] + 13);
+        else if (!strncmp(argv[arg], "--interval=", 11))
+            interval = atoi(argv[arg] + 11);
+        else if (!strncmp(argv[arg], "--apps=", 7))
+            appCount = atoi(argv[arg] + 7);
+        else if (!strcmp(argv[arg], "--unique-ids"))
+            uniqueIds = true;
+        else if (!strncmp(argv[arg], "--output=", 9))
+            outputPath = argv[arg] + 9;
+        else if (!strncmp(argv[arg], "--max-slope=", 12))
+            usage = usage || !parseMaxSlope(argv[arg] + 12, maxSlopes);
+        else
+            usage = true;
+    }
+    if (usage || iterations <= 0 || interval <= 0 || appCount <= 0) {
+        fprintf(stderr, "Usage: wam-soak [--iterations=<n>] [--interval=<n>] [--apps=<n>] [--unique-ids]\n"
+                        "                [--output=<file>] [--max-slope=<metric>=<per 1000 iterations>]...\n");
+        return 2;
+    }
+
+    FILE* output = 0;
+    if (outputPath && !(output = fopen(outputPath, "w"))) {
+        fprintf(stderr, "Cannot write %s\n", outputPath);
+        return 1;
+    }
+
+    // The run is about growth, not latency, so the stub engine runs fast
+    StubEngineDelays delays;
+    delays.loadMs = 1;
+    delays.frameMs = 1;
+    delays.unloadMs = 1;
+    StubWebEngine::setDelays(delays);
+    StubWebEngine::install();
+
+    SoakListener listener;
+    StubWebEngine::setListener(&listener);
+
+    WebAppManager* manager = WebAppManager::instance();
+    WebAppManagerConfig* config = manager->config();
+    bool hibernation = config->getHibernationMaxApps() > 0 && config->getHibernationTimeout() > 0;
+
+    std::vector<Snapshot> snapshots;
+    snapshots.reserve(iterations / interval + 2);
+    gint64 startUs = g_get_monotonic_time();
+    snapshots.push_back(takeSnapshot(0, startUs));
+
+    bool ok = true;
+    int errCode = 0;
+    std::string errMsg;
+    for (int iteration = 1; iteration <= iterations && ok; iteration++) {
+        QString appId = QStringLiteral("com.webos.app.soak%1").arg(uniqueIds ? iteration : iteration % appCount);
+        std::string desc = StubWebEngine::appDescription(appId);
+        listener.clear();
+
+        if (manager->launch(desc, "{}", "", errCode, errMsg).empty()) {
+            printf("%s: launch failed, %d %s\n", qPrintable(appId), errCode, errMsg.c_str());
+            ok = false;
+            break;
+        }
+
+        // A revived app was loaded before it hibernated
+        ok = StubWebEngine::runMainLoopUntil([&]() {
+            WebAppBase* app = manager->findAppById(appId);
+            return listener.isFramed(appId) || (app && app->page() && app->page()->hasBeenShown());
+        }, kWaitTimeoutMs);
+
+        manager->launch(desc, "{}", "", errCode, errMsg);
+
+        WebAppBase* app = manager->findAppById(appId);
+        if (ok && app && iteration % kCrashEvery == 0) {
+            listener.clear();
+            static_cast<StubWebPage*>(app->page())->simulateCrash();
+            ok = StubWebEngine::runMainLoopUntil([&]() { return listener.isLoaded(appId); }, kWaitTimeoutMs);
+        }
+
+        manager->onKillApp(appId.toStdString());
+        ok = ok && StubWebEngine::runMainLoopUntil([&]() {
+            return listener.isDeleted(appId) || (hibernation && !manager->findAppById(appId));
+        }, kWaitTimeoutMs);
+
+        if (!ok)
+            printf("%s: timed out after %d ms in iteration %d\n", qPrintable(appId), kWaitTimeoutMs, iteration);
+
+        if (iteration % interval == 0) {
+            snapshots.push_back(takeSnapshot(iteration, startUs));
+            const Snapshot& snapshot = snapshots.back();
+            printf("%6d %8.0f ms  rss %6.0f kB  fds %3.0f  heap %7.0f blocks %9.0f bytes  apps %2.0f  pages %2.0f  timers %3.0f\n",
+                snapshot.iteration, snapshot.elapsedMs, snapshot.values[RssKb], snapshot.values[OpenFds],
+                snapshot.values[HeapBlocks], snapshot.values[HeapBytes], snapshot.values[Apps],
+                snapshot.values[Pages], snapshot.values[Timers]);
+            if (output)
+                writeSnapshot(output, snapshot);
+        }
+    }
+
+    StubWebEngine::setListener(0);
+    if (output)
+        fclose(output);
+
+    // The first snapshots include caches and pools filling up
+    if (static_cast<int>(snapshots.size()) < kWarmupSnapshots + 3) {
+        printf("%d snapshots, too few to fit the growth\n", static_cast<int>(snapshots.size()));
+        return ok ? 0 : 1;
+    }
+
+    printf("%-12s %14s %14s\n", "metric", "per 1000 it", "limit");
+    bool grew = false;
+    for (int i = 0; i < MetricCount; i++) {
+        double growth = slope(snapshots, kWarmupSnapshots, i);
+        bool failed = growth > maxSlopes[i];
+        printf("%-12s %14.1f %14.1f%s\n", kMetricNames[i], growth, maxSlopes[i], failed ? "  FAIL" : "");
+        grew = grew || failed;
+    }
+    return ok && !grew ? 0 : 1;
+}
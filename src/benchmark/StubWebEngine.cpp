@@ -0,0 +1,373 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "StubWebEngine.h"
+
+#include <unistd.h>
+
+#include <glib.h>
+
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "ApplicationDescription.h"
+#include "FlightRecorder.h"
+#include "LaunchTimeline.h"
+#include "WebAppFactoryManager.h"
+#include "WebAppManagerService.h"
+#include "WebPageObserver.h"
+
+static const int kDisplayWidth = 1920;
+static const int kDisplayHeight = 1080;
+
+static int delayFromEnv(const char* name, int defaultMs)
+{
+    QByteArray value = qgetenv(name);
+    return value.isEmpty() ? defaultMs : value.toInt();
+}
+
+StubEngineDelays::StubEngineDelays()
+    : loadMs(delayFromEnv("WAM_STUB_LOAD_DELAY_MS", 20))
+    , frameMs(delayFromEnv("WAM_STUB_FRAME_DELAY_MS", 16))
+    , unloadMs(delayFromEnv("WAM_STUB_UNLOAD_DELAY_MS", 5))
+{
+}
+
+static StubEngineDelays s_delays;
+static DeviceInfo* s_deviceInfo = 0;
+StubEngineListener* StubWebEngine::s_listener = 0;
+int StubWebPage::s_liveCount = 0;
+int StubWebApp::s_liveCount = 0;
+
+const StubEngineDelays& StubWebEngine::delays()
+{
+    return s_delays;
+}
+
+void StubWebEngine::setDelays(const StubEngineDelays& delays)
+{
+    s_delays = delays;
+}
+
+void StubWebEngine::install()
+{
+    static bool s_installed = false;
+    if (s_installed)
+        return;
+    s_installed = true;
+
+    WebAppManager::instance()->setPlatformModules(new StubPlatformModuleFactory());
+    WebAppFactoryManager::instance()->registerPluggable(QStringLiteral("default"), new StubWebAppFactory());
+}
+
+DeviceInfo* StubWebEngine::deviceInfo()
+{
+    return s_deviceInfo;
+}
+
+static gboolean waitTimedOut(gpointer data)
+{
+    *static_cast<bool*>(data) = true;
+    return G_SOURCE_REMOVE;
+}
+
+bool StubWebEngine::runMainLoopUntil(const std::function<bool()>& done, int timeoutMs)
+{
+    bool timedOut = false;
+    guint guard = g_timeout_add(timeoutMs, waitTimedOut, &timedOut);
+    while (!done() && !timedOut)
+        g_main_context_iteration(0, TRUE);
+
+    if (!timedOut)
+        g_source_remove(guard);
+    return !timedOut;
+}
+
+std::string StubWebEngine::appDescription(const QString& appId)
+{
+    QJsonObject desc;
+    desc["id"] = appId;
+    desc["main"] = QStringLiteral("file:///usr/palm/applications/%1/index.html").arg(appId);
+    desc["folderPath"] = QStringLiteral("/usr/palm/applications/%1").arg(appId);
+    desc["defaultWindowType"] = QStringLiteral("card");
+    desc["trustLevel"] = QStringLiteral("default");
+    desc["version"] = QStringLiteral("1.0.0");
+    return QJsonDocument(desc).toJson(QJsonDocument::Compact).toStdString();
+}
+
+StubWebPage::StubWebPage(const QUrl& url, ApplicationDescription* desc, const QString& params)
+    : WebPageBase(url, desc, params)
+    , m_url(url)
+    , m_progress(0)
+    , m_hasBeenShown(false)
+    , m_suspended(false)
+    , m_visibilityState(WebPageVisibilityStateLaunching)
+{
+    s_liveCount++;
+}
+
+StubWebPage::~StubWebPage()
+{
+    s_liveCount--;
+}
+
+void StubWebPage::simulateCrash()
+{
+    // Same handling as WebPageBlink::renderProcessCrashed()
+    m_loadTimer.stop();
+    m_frameTimer.stop();
+    if (isClosing()) {
+        Q_EMIT closingAppProcessDidCrashed();
+        return;
+    }
+
+    if (!processCrashed())
+        handleForceDeleteWebPage();
+}
+
+void StubWebPage::loadUrl(const std::string& url)
+{
+    startLoad(QUrl(QString::fromStdString(url)), StubWebEngine::delays().loadMs);
+}
+
+void StubWebPage::loadDefaultUrl()
+{
+    startLoad(m_defaultUrl, StubWebEngine::delays().loadMs);
+}
+
+void StubWebPage::reloadDefaultPage()
+{
+    loadDefaultUrl();
+}
+
+void StubWebPage::reload()
+{
+    startLoad(m_url, StubWebEngine::delays().loadMs);
+}
+
+void StubWebPage::cleanResources()
+{
+    WebPageBase::cleanResources();
+    startLoad(QUrl(QStringLiteral("about:blank")), StubWebEngine::delays().unloadMs);
+}
+
+uint32_t StubWebPage::getWebProcessPID() const
+{
+    // Gives /proc based lookups, e.g. the memory size, a process to read
+    return getpid();
+}
+
+void StubWebPage::suspendWebPageAll()
+{
+    if (m_suspended || m_enableBackgroundRun)
+        return;
+
+    m_suspended = true;
+    FlightRecorder::record(FlightRecorder::Suspend, appId(), getWebProcessPID());
+}
+
+void StubWebPage::resumeWebPageAll()
+{
+    m_suspended = false;
+    FlightRecorder::record(FlightRecorder::Resume, appId(), getWebProcessPID());
+}
+
+void StubWebPage::startLoad(const QUrl& url, int delayMs)
+{
+    m_loadTimer.stop();
+    m_frameTimer.stop();
+    m_url = url;
+    m_progress = 0;
+    handleLoadStarted();
+    m_loadTimer.start(delayMs, this, &StubWebPage::loadFinished);
+}
+
+void StubWebPage::loadFinished()
+{
+    m_progress = 100;
+
+    if (cleaningResources()) {
+        Q_EMIT didDispatchUnload();
+        return;
+    }
+
+    m_hasBeenShown = true;
+    handleLoadFinished();
+    if (StubWebEngine::listener())
+        StubWebEngine::listener()->loadFinished(appId());
+
+    m_frameTimer.start(StubWebEngine::delays().frameMs, this, &StubWebPage::frameCommitted);
+}
+
+void StubWebPage::frameCommitted()
+{
+    FOR_EACH_OBSERVER(WebPageObserver, m_observers, firstFrameVisuallyCommitted());
+    if (StubWebEngine::listener())
+        StubWebEngine::listener()->firstFrame(appId());
+}
+
+StubWebApp::StubWebApp(const QString& winType, ApplicationDescription* desc)
+    : m_windowType(winType)
+    , m_activated(false)
+    , m_focused(false)
+{
+    if (desc && desc->widthOverride() && desc->heightOverride())
+        init(desc->widthOverride(), desc->heightOverride());
+    else
+        init(kDisplayWidth, kDisplayHeight);
+    s_liveCount++;
+}
+
+StubWebApp::~StubWebApp()
+{
+    s_liveCount--;
+    if (StubWebEngine::listener())
+        StubWebEngine::listener()->appDeleted(appId());
+}
+
+void StubWebApp::onStageActivated()
+{
+    // Same steps as WebAppWayland, the compositor is the caller there
+    if (getCrashState()) {
+        page()->reloadDefaultPage();
+        setCrashState(false);
+    }
+
+    page()->resumeWebPageAll();
+    page()->setVisibilityState(WebPageBase::WebPageVisibilityStateVisible);
+    setActiveAppId(page()->getIdentifier());
+    m_activated = true;
+    focus();
+}
+
+void StubWebApp::onStageDeactivated()
+{
+    page()->suspendWebPageMedia();
+    unfocus();
+    page()->setVisibilityState(WebPageBase::WebPageVisibilityStateHidden);
+    page()->suspendWebPageAll();
+    m_activated = false;
+}
+
+void StubWebApp::hide(bool forcedHide)
+{
+    // Like WebAppWayland::hide, only the window goes away, the page keeps
+    // running until its caller deactivates it
+    if (keepAlive() || forcedHide) {
+        m_addedToWindowMgr = false;
+        setHiddenWindow(true);
+    }
+}
+
+void StubWebApp::raise()
+{
+    if (!m_activated)
+        onStageActivated();
+}
+
+void StubWebApp::goBackground()
+{
+    if (m_activated)
+        onStageDeactivated();
+}
+
+void StubWebApp::firstFrameVisuallyCommitted()
+{
+    LaunchTimeline::mark(instanceId(), LaunchTimeline::PhaseFirstFrameSwapped);
+    LaunchTimeline::mark(instanceId(), LaunchTimeline::PhaseVisuallyCommitted);
+
+    if (!getHiddenWindow() && m_preloadState == NONE_PRELOAD)
+        showWindow();
+}
+
+void StubWebApp::showWindow()
+{
+    if (m_preloadState != NONE_PRELOAD)
+        return;
+
+    setHiddenWindow(false);
+    m_addedToWindowMgr = true;
+    WebAppBase::showWindow();
+    raise();
+}
+
+void StubWebApp::webPageLoadFinishedSlot()
+{
+    if (getHiddenWindow())
+        return;
+    if (needReload()) {
+        page()->reload();
+        setNeedReload(false);
+        return;
+    }
+    LaunchTimeline::mark(instanceId(), LaunchTimeline::PhaseLoadFinished);
+    doPendingRelaunch();
+}
+
+WebAppBase* StubWebAppFactory::createWebApp(QString winType, ApplicationDescription* desc)
+{
+    return new StubWebApp(winType, desc);
+}
+
+WebAppBase* StubWebAppFactory::createWebApp(QString winType, WebPageBase* page, ApplicationDescription* desc)
+{
+    return createWebApp(winType, desc);
+}
+
+WebPageBase* StubWebAppFactory::createWebPage(QUrl url, ApplicationDescription* desc, QString launchParams)
+{
+    return new StubWebPage(url, desc, launchParams);
+}
+
+uint32_t StubWebProcessManager::getWebProcessPID(const WebAppBase* app) const
+{
+    return app->page() ? app->page()->getWebProcessPID() : 0;
+}
+
+void StubServiceSender::closeApp(const std::string& id)
+{
+    // The application manager answers a close request with a kill
+    WebAppManager::instance()->onKillApp(id);
+}
+
+void StubServiceSender::postlistRunningApps(std::vector<ApplicationInfo>& apps)
+{
+    // Serialized like the Luna reply, so callers pay for building it
+    m_runningAppsReply = QJsonDocument(WebAppManagerService::runningAppsReply(apps)).toJson(QJsonDocument::Compact);
+}
+
+QString StubWebAppManagerConfig::s_webProcessConfigPath;
+
+int StubWebAppManagerConfig::getHibernationMaxApps() const
+{
+    // Off unless asked for, e.g. by a soak run that covers hibernation
+    if (qgetenv("WAM_HIBERNATION_MAX_APPS").isEmpty())
+        return 0;
+    return WebAppManagerConfig::getHibernationMaxApps();
+}
+
+QString StubWebAppManagerConfig::getWebProcessConfigPath() const
+{
+    if (s_webProcessConfigPath.isEmpty())
+        return WebAppManagerConfig::getWebProcessConfigPath();
+    return s_webProcessConfigPath;
+}
+
+DeviceInfo* StubPlatformModuleFactory::createDeviceInfo()
+{
+    s_deviceInfo = new DeviceInfo();
+    return s_deviceInfo;
+}
@@ -0,0 +1,270 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef STUBWEBENGINE_H
+#define STUBWEBENGINE_H
+
+#include <functional>
+#include <string>
+
+#include <QByteArray>
+#include <QString>
+#include <QUrl>
+
+#include "DeviceInfo.h"
+#include "PlatformModuleFactory.h"
+#include "ServiceSender.h"
+#include "Timer.h"
+#include "WebAppBase.h"
+#include "WebAppFactoryInterface.h"
+#include "WebAppManagerConfig.h"
+#include "WebPageBase.h"
+#include "WebProcessManager.h"
+
+// Headless stand-in for the web engine and the compositor, so WebAppManager,
+// WebAppBase and WebPageBase can be driven without a renderer or a Wayland
+// display. Page loads, first frames and unloads complete on the glib main
+// loop after synthetic delays, see StubEngineDelays.
+
+// Synthetic delays in milliseconds, read from the environment:
+// WAM_STUB_LOAD_DELAY_MS, WAM_STUB_FRAME_DELAY_MS and WAM_STUB_UNLOAD_DELAY_MS
+struct StubEngineDelays {
+    StubEngineDelays();
+
+    int loadMs;       // load start to load finished
+    int frameMs;      // load finished to the first visually committed frame
+    int unloadMs;     // about:blank load of a closing page
+};
+
+// Notified of the asynchronous steps, e.g. by a benchmark waiting for them
+class StubEngineListener {
+public:
+    virtual ~StubEngineListener() {}
+
+    virtual void loadFinished(const QString& appId) {}
+    virtual void firstFrame(const QString& appId) {}
+    virtual void appDeleted(const QString& appId) {}
+};
+
+class StubWebEngine {
+public:
+    static const StubEngineDelays& delays();
+    static void setDelays(const StubEngineDelays& delays);
+
+    static StubEngineListener* listener() { return s_listener; }
+    static void setListener(StubEngineListener* listener) { s_listener = listener; }
+
+    // Sets up WebAppManager with the stub platform modules and registers
+    // the stub app factory as the default one, once per process
+    static void install();
+
+    // Runs the main loop, where the stub engine completes its steps, until
+    // done() returns true. Returns false if timeoutMs passed before that.
+    static bool runMainLoopUntil(const std::function<bool()>& done, int timeoutMs);
+
+    // Minimal launchable app description for appId, as a JSON string
+    static std::string appDescription(const QString& appId);
+
+    // Device info handed to WebAppManager, for filling in properties
+    static DeviceInfo* deviceInfo();
+
+private:
+    static StubEngineListener* s_listener;
+};
+
+class StubWebPage : public WebPageBase {
+public:
+    StubWebPage(const QUrl& url, ApplicationDescription* desc, const QString& params);
+    ~StubWebPage() override;
+
+    static int liveCount() { return s_liveCount; }
+
+    // Acts like a render process crash reported by the engine
+    void simulateCrash();
+    bool isSuspended() const { return m_suspended; }
+
+    // WebPageBase
+    void init() override {}
+    void* getWebContents() override { return 0; }
+    QUrl url() const override { return m_url; }
+    void replaceBaseUrl(QUrl newUrl) override { m_url = newUrl; }
+    void loadUrl(const std::string& url) override;
+    int progress() const override { return m_progress; }
+    bool hasBeenShown() const override { return m_hasBeenShown; }
+    void setPageProperties() override {}
+    void setPreferredLanguages(const QString& language) override {}
+    void setDefaultFont(const QString& font) override {}
+    void cleanResources() override;
+    void reloadDefaultPage() override;
+    void reload() override;
+    void setVisibilityState(WebPageVisibilityState visibilityState) override { m_visibilityState = visibilityState; }
+    void setFocus(bool focus) override {}
+    QString title() override { return appId(); }
+    bool canGoBack() override { return false; }
+    void closeVkb() override {}
+    void updatePageSettings() override {}
+    void handleDeviceInfoChanged(const QString& deviceInfo) override {}
+    void evaluateJavaScript(const QString& jsCode) override {}
+    void evaluateJavaScriptInAllFrames(const QString& jsCode, const char* method = "") override {}
+    void setForceActivateVtg(bool enabled) override {}
+    uint32_t getWebProcessProxyID() override { return 0; }
+    uint32_t getWebProcessPID() const override;
+    void createPalmSystem(WebAppBase* app) override {}
+    void suspendWebPageAll() override;
+    void resumeWebPageAll() override;
+    void suspendWebPageMedia() override {}
+    void resumeWebPageMedia() override {}
+    void resumeWebPagePaintingAndJSExecution() override {}
+    void forwardEvent(void* event) override {}
+
+protected:
+    // WebPageBase
+    void suspendWebPagePaintingAndJSExecution() override {}
+    void loadDefaultUrl() override;
+    void addUserScript(const QString& script) override {}
+    void addUserScriptUrl(const QUrl& url) override {}
+    void loadErrorPage(int errorCode) override {}
+    void recreateWebView() override {}
+
+private:
+    static int s_liveCount;
+
+    void startLoad(const QUrl& url, int delayMs);
+    void loadFinished();
+    void frameCommitted();
+
+    QUrl m_url;
+    int m_progress;
+    bool m_hasBeenShown;
+    bool m_suspended;
+    WebPageVisibilityState m_visibilityState;
+    OneShotTimer<StubWebPage> m_loadTimer;
+    OneShotTimer<StubWebPage> m_frameTimer;
+};
+
+class StubWebApp : public WebAppBase {
+public:
+    StubWebApp(const QString& winType, ApplicationDescription* desc);
+    ~StubWebApp() override;
+
+    static int liveCount() { return s_liveCount; }
+
+    // WebAppBase
+    void init(int width, int height) override { setUiSize(width, height); }
+    void suspendAppRendering() override {}
+    void resumeAppRendering() override {}
+    bool isFocused() const override { return m_focused; }
+    void resize(int width, int height) override {}
+    bool isActivated() const override { return m_activated; }
+    bool isMinimized() override { return !m_activated; }
+    bool isNormal() override { return false; }
+    void onStageActivated() override;
+    void onStageDeactivated() override;
+    void configureWindow(QString& type) override { m_windowType = type; }
+    void setWindowProperty(const QString& name, const QVariant& value) override {}
+    void platformBack() override {}
+    void setCursor(const QString& cursorArg, int hotspot_x, int hotspot_y) override {}
+    void setInputRegion(const QJsonDocument& jsonDoc) override {}
+    void setKeyMask(const QJsonDocument& jsonDoc) override {}
+    bool isWindowed() const override { return true; }
+    void hide(bool forcedHide = false) override;
+    void focus() override { m_focused = true; }
+    void unfocus() override { m_focused = false; }
+    void setOpacity(float opacity) override {}
+    void raise() override;
+    void goBackground() override;
+    void deleteSurfaceGroup() override {}
+    void doClose() override { forceCloseAppInternal(); }
+
+    // WebPageObserver
+    void firstFrameVisuallyCommitted() override;
+
+protected:
+    // WebAppBase
+    void doAttach() override {}
+    void showWindow() override;
+    void webPageLoadFinishedSlot() override;
+    void webPageLoadFailedSlot(int errorCode) override {}
+
+private:
+    static int s_liveCount;
+
+    QString m_windowType;
+    bool m_activated;
+    bool m_focused;
+};
+
+class StubWebAppFactory : public WebAppFactoryInterface {
+public:
+    WebAppBase* createWebApp(QString winType, ApplicationDescription* desc = 0) override;
+    WebAppBase* createWebApp(QString winType, WebPageBase* page, ApplicationDescription* desc = 0) override;
+    WebPageBase* createWebPage(QUrl url, ApplicationDescription* desc, QString launchParams = "") override;
+};
+
+class StubWebProcessManager : public WebProcessManager {
+public:
+    // WebProcessManager
+    QJsonObject getWebProcessProfiling() override { return QJsonObject(); }
+    uint32_t getWebProcessPID(const WebAppBase* app) const override;
+    void deleteStorageData(const QString& identifier) override {}
+    uint32_t getInitialWebViewProxyID() const override { return 0; }
+    void clearBrowsingData(const int removeBrowsingDataMask) override {}
+    int maskForBrowsingDataType(const char* type) override { return 0; }
+};
+
+class StubServiceSender : public ServiceSender {
+public:
+    // ServiceSender
+    void requestActivity(WebAppBase* app) override {}
+#ifndef PRELOADMANAGER_ENABLED
+    void launchContainerApp(const QString& id) override {}
+#endif
+    void postlistRunningApps(std::vector<ApplicationInfo>& apps) override;
+    void postWebProcessCreated(const QString& appId, uint32_t pid) override {}
+    void serviceCall(const QString& url, const QString& payload, const QString& appId) override {}
+    void closeApp(const std::string& id) override;
+
+private:
+    QByteArray m_runningAppsReply;
+};
+
+class StubWebAppManagerConfig : public WebAppManagerConfig {
+public:
+    // Only the factory registered by StubWebEngine::install() is used, and
+    // closed apps are torn down unless WAM_HIBERNATION_MAX_APPS is set
+    bool isDynamicPluggableLoadEnabled() const override { return true; }
+    int getHibernationMaxApps() const override;
+
+    // Replaces the web process policy file, e.g. with a generated one.
+    // Takes effect for web process managers created afterwards.
+    static void setWebProcessConfigPath(const QString& path) { s_webProcessConfigPath = path; }
+    QString getWebProcessConfigPath() const override;
+
+private:
+    static QString s_webProcessConfigPath;
+};
+
+class StubPlatformModuleFactory : public PlatformModuleFactory {
+protected:
+    // PlatformModuleFactory
+    ServiceSender* createServiceSender() override { return new StubServiceSender(); }
+    WebProcessManager* createWebProcessManager() override { return new StubWebProcessManager(); }
+    ContainerAppManager* createContainerAppManager() override { return 0; }
+    DeviceInfo* createDeviceInfo() override;
+    WebAppManagerConfig* createWebAppManagerConfig() override { return new StubWebAppManagerConfig(); }
+};
+
+#endif // STUBWEBENGINE_H
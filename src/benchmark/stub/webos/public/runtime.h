@@ -0,0 +1,45 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef STUB_WEBOS_PUBLIC_RUNTIME_H
+#define STUB_WEBOS_PUBLIC_RUNTIME_H
+
+// Stand-in for the web engine runtime in headless builds (CONFIG_BUILD+=headless)
+namespace webos {
+
+class Runtime {
+public:
+    static Runtime* GetInstance()
+    {
+        static Runtime s_instance;
+        return &s_instance;
+    }
+
+    void SetNetworkConnected(bool connected) { m_networkConnected = connected; }
+    bool IsNetworkConnected() const { return m_networkConnected; }
+
+private:
+    Runtime()
+        : m_networkConnected(false)
+    {
+    }
+
+    bool m_networkConnected;
+};
+
+} // namespace webos
+
+#endif // STUB_WEBOS_PUBLIC_RUNTIME_H
@@ -0,0 +1,35 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef STUB_WEBOS_WEBVIEW_BASE_H
+#define STUB_WEBOS_WEBVIEW_BASE_H
+
+// Stand-in for the web engine header in headless builds (CONFIG_BUILD+=headless).
+// Core only needs the memory pressure levels from it.
+namespace webos {
+
+class WebViewBase {
+public:
+    enum MemoryPressureLevel {
+        MEMORY_PRESSURE_NONE = 0,
+        MEMORY_PRESSURE_LOW = 1,
+        MEMORY_PRESSURE_CRITICAL = 2
+    };
+};
+
+} // namespace webos
+
+#endif // STUB_WEBOS_WEBVIEW_BASE_H
@@ -0,0 +1,124 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "wam_running_apps.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* WAM rewrites the page in microseconds, this only bounds a stuck writer */
+#define WAM_RUNNING_APPS_READ_ATTEMPTS 1000
+
+struct wam_running_apps_reader {
+    const struct wam_running_apps_page* page;
+};
+
+wam_running_apps_reader* wam_running_apps_open(const char* path)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(struct wam_running_apps_page)) {
+        close(fd);
+        errno = EPROTO;
+        return NULL;
+    }
+
+    void* page = mmap(NULL, sizeof(struct wam_running_apps_page), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (page == MAP_FAILED)
+        return NULL;
+
+    const struct wam_running_apps_page* header = (const struct wam_running_apps_page*)page;
+    if (header->magic != WAM_RUNNING_APPS_MAGIC || header->version != WAM_RUNNING_APPS_VERSION) {
+        munmap(page, sizeof(struct wam_running_apps_page));
+        errno = EPROTO;
+        return NULL;
+    }
+
+    wam_running_apps_reader* reader = (wam_running_apps_reader*)malloc(sizeof(wam_running_apps_reader));
+    if (!reader) {
+        munmap(page, sizeof(struct wam_running_apps_page));
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    reader->page = header;
+    return reader;
+}
+
+void wam_running_apps_close(wam_running_apps_reader* reader)
+{
+    if (!reader)
+        return;
+
+    munmap((void*)reader->page, sizeof(struct wam_running_apps_page));
+    free(reader);
+}
+
+int wam_running_apps_read(wam_running_apps_reader* reader, struct wam_running_app* apps, int max, uint32_t* sequence,
+    uint64_t* updated_ms)
+{
+    const struct wam_running_apps_page* page = reader->page;
+
+    for (int attempt = 0; attempt < WAM_RUNNING_APPS_READ_ATTEMPTS; ++attempt) {
+        uint32_t begin = __atomic_load_n(&page->sequence, __ATOMIC_ACQUIRE);
+        if (begin & 1) {
+            sched_yield();
+            continue;
+        }
+
+        if (__atomic_load_n(&page->flags, __ATOMIC_ACQUIRE) & WAM_RUNNING_APPS_FLAG_CLOSED) {
+            errno = ESTALE;
+            return -1;
+        }
+
+        /* count may be torn along with the entries, check before using it */
+        uint32_t count = __atomic_load_n(&page->count, __ATOMIC_RELAXED);
+        if (count > WAM_RUNNING_APPS_MAX)
+            count = WAM_RUNNING_APPS_MAX;
+        uint32_t copied = max <= 0 ? 0 : ((uint32_t)max < count ? (uint32_t)max : count);
+        if (copied)
+            memcpy(apps, page->apps, copied * sizeof(struct wam_running_app));
+        uint64_t updated = __atomic_load_n(&page->updated_ms, __ATOMIC_RELAXED);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&page->sequence, __ATOMIC_RELAXED) != begin)
+            continue;
+
+        if (sequence)
+            *sequence = begin;
+        if (updated_ms)
+            *updated_ms = updated;
+        return (int)count;
+    }
+
+    errno = EAGAIN;
+    return -1;
+}
+
+uint32_t wam_running_apps_sequence(const wam_running_apps_reader* reader)
+{
+    return __atomic_load_n(&reader->page->sequence, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,63 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef WAM_RUNNING_APPS_H
+#define WAM_RUNNING_APPS_H
+
+#include "RunningAppsPageLayout.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Reader of the running apps page WAM publishes in shared memory.
+ *
+ * Ask com.palm.webappmanager/getRunningAppsPage once for the "path" of the
+ * page, open it here and read it as often as needed. A read copies the page
+ * without locks or IPC, so polling it is cheap. A reader is not thread safe,
+ * open one per thread that reads.
+ */
+typedef struct wam_running_apps_reader wam_running_apps_reader;
+
+/* NULL with errno set if the page can not be mapped or has another version */
+wam_running_apps_reader* wam_running_apps_open(const char* path);
+void wam_running_apps_close(wam_running_apps_reader* reader);
+
+/*
+ * Copies up to max running apps into apps and returns how many apps are
+ * running, which may be more than max. Returns -1 with errno EAGAIN if WAM
+ * kept rewriting the page, or ESTALE once WAM stopped updating it, in which
+ * case the page has to be opened again from a new path.
+ * sequence, if not NULL, is set to the sequence of the copied page, and
+ * updated_ms, if not NULL, to the CLOCK_MONOTONIC time WAM wrote it.
+ *
+ * ESTALE is only seen when WAM shut down cleanly. Once the page has been
+ * asked for, WAM rewrites it at least every WAM_RUNNING_APPS_PAGE_INTERVAL
+ * ms (5 s by default), so a page whose updated_ms lags well behind that is
+ * from a WAM that died; ask getRunningAppsPage again for the new path.
+ */
+int wam_running_apps_read(wam_running_apps_reader* reader, struct wam_running_app* apps, int max, uint32_t* sequence,
+    uint64_t* updated_ms);
+
+/* Changes on every update of the page, to skip reads when nothing changed */
+uint32_t wam_running_apps_sequence(const wam_running_apps_reader* reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WAM_RUNNING_APPS_H */
@@ -0,0 +1,149 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "AppCloseStatistics.h"
+
+#include <algorithm>
+
+#include <QJsonArray>
+
+#include "LogManager.h"
+
+static const int kDefaultCloseCallbackTimeoutMs = 10000;
+static const int kMinCloseCallbackTimeoutMs = 1000;
+static const int kCloseCallbackTimeoutMarginMs = 250;
+static const int kMinCloseCallbackSamples = 3;
+static const int kMaxCloseCallbackSamples = 16;
+static const int kMaxTrackedApps = 64;
+
+// Upper bounds (ms) of the time-to-close histogram buckets, the last bucket is unbounded
+static const int kTimeToCloseBuckets[] = { 50, 100, 250, 500, 1000, 2500, 5000, 10000 };
+static const int kTimeToCloseBucketCount = sizeof(kTimeToCloseBuckets) / sizeof(kTimeToCloseBuckets[0]);
+
+AppCloseStatistics::AppCloseStatistics()
+    : m_useCount(0)
+    , m_timeToCloseHistogram(kTimeToCloseBucketCount + 1, 0)
+    , m_maxCloseCallbackTimeoutMs(kDefaultCloseCallbackTimeoutMs)
+{
+}
+
+int AppCloseStatistics::closeCallbackTimeout(const QString& appId) const
+{
+    QMap<QString, AppSamples>::const_iterator it = m_apps.find(appId);
+    if (it == m_apps.end() || it->callbackDurations.size() < kMinCloseCallbackSamples)
+        return m_maxCloseCallbackTimeoutMs;
+
+    // Twice the 90th percentile of recent callbacks leaves room for a slow
+    // close, and a timed out callback is recorded with the timeout it hit,
+    // so an app that needs more time grows its timeout on the next close.
+    QList<int> durations = it->callbackDurations;
+    std::sort(durations.begin(), durations.end());
+    int p90 = durations.at((durations.size() - 1) * 9 / 10);
+
+    int timeout = p90 * 2 + kCloseCallbackTimeoutMarginMs;
+    return std::min(std::max(timeout, kMinCloseCallbackTimeoutMs), m_maxCloseCallbackTimeoutMs);
+}
+
+AppCloseStatistics::AppSamples& AppCloseStatistics::samplesFor(const QString& appId)
+{
+    if (!m_apps.contains(appId) && m_apps.size() >= kMaxTrackedApps) {
+        QMap<QString, AppSamples>::iterator oldest = m_apps.begin();
+        for (QMap<QString, AppSamples>::iterator it = m_apps.begin(); it != m_apps.end(); ++it) {
+            if (it->lastUse < oldest->lastUse)
+                oldest = it;
+        }
+        m_apps.erase(oldest);
+    }
+
+    AppSamples& samples = m_apps[appId];
+    samples.lastUse = ++m_useCount;
+    return samples;
+}
+
+void AppCloseStatistics::addCloseCallbackSample(const QString& appId, int elapsedMs, bool timedOut)
+{
+    AppSamples& samples = samplesFor(appId);
+
+    samples.callbackDurations.append(elapsedMs);
+    if (samples.callbackDurations.size() > kMaxCloseCallbackSamples)
+        samples.callbackDurations.removeFirst();
+
+    if (timedOut)
+        samples.callbackTimeoutCount++;
+}
+
+void AppCloseStatistics::addTimeToClose(const QString& appId, int elapsedMs)
+{
+    AppSamples& samples = samplesFor(appId);
+
+    samples.closeCount++;
+    samples.lastTimeToCloseMs = elapsedMs;
+    samples.maxTimeToCloseMs = std::max(samples.maxTimeToCloseMs, elapsedMs);
+
+    m_timeToCloseHistogram[bucketIndex(elapsedMs)]++;
+
+    LOG_INFO(MSGID_APP_CLOSE_TIME, 3, PMLOGKS("APP_ID", qPrintable(appId)),
+        PMLOGKFV("TIME_TO_CLOSE_MS", "%d", elapsedMs),
+        PMLOGKFV("NEXT_TIMEOUT_MS", "%d", closeCallbackTimeout(appId)), "");
+}
+
+int AppCloseStatistics::bucketIndex(int elapsedMs)
+{
+    for (int i = 0; i < kTimeToCloseBucketCount; i++) {
+        if (elapsedMs <= kTimeToCloseBuckets[i])
+            return i;
+    }
+    return kTimeToCloseBucketCount;
+}
+
+QJsonObject AppCloseStatistics::toJson() const
+{
+    QJsonObject result;
+
+    QJsonArray histogram;
+    int total = 0;
+    for (int i = 0; i <= kTimeToCloseBucketCount; i++) {
+        QJsonObject bucket;
+        if (i < kTimeToCloseBucketCount)
+            bucket["le"] = kTimeToCloseBuckets[i];
+        else
+            bucket["le"] = QStringLiteral("+Inf");
+        bucket["count"] = m_timeToCloseHistogram[i];
+        total += m_timeToCloseHistogram[i];
+        histogram.append(bucket);
+    }
+
+    QJsonObject timeToClose;
+    timeToClose["count"] = total;
+    timeToClose["buckets"] = histogram;
+
+    QJsonArray apps;
+    for (QMap<QString, AppSamples>::const_iterator it = m_apps.begin(); it != m_apps.end(); ++it) {
+        QJsonObject app;
+        app["id"] = it.key();
+        app["closeCount"] = it->closeCount;
+        app["closeCallbackTimeoutCount"] = it->callbackTimeoutCount;
+        app["closeCallbackTimeout"] = closeCallbackTimeout(it.key());
+        app["lastTimeToClose"] = it->lastTimeToCloseMs;
+        app["maxTimeToClose"] = it->maxTimeToCloseMs;
+        apps.append(app);
+    }
+
+    result["maxCloseCallbackTimeout"] = m_maxCloseCallbackTimeoutMs;
+    result["timeToClose"] = timeToClose;
+    result["apps"] = apps;
+    return result;
+}
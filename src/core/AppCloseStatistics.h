@@ -0,0 +1,73 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef APPCLOSESTATISTICS_H
+#define APPCLOSESTATISTICS_H
+
+#include <QJsonObject>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+// Keeps per-app close callback durations and time-to-close samples.
+// The close callback timeout of an app is derived from its own history,
+// so apps with fast onclose handlers do not hold their page and renderer
+// for the full default timeout when the callback never answers.
+// Only the most recently closed apps are kept, see samplesFor().
+class AppCloseStatistics {
+public:
+    AppCloseStatistics();
+
+    void setMaxCloseCallbackTimeout(int timeoutMs) { m_maxCloseCallbackTimeoutMs = timeoutMs; }
+    int maxCloseCallbackTimeout() const { return m_maxCloseCallbackTimeoutMs; }
+
+    int closeCallbackTimeout(const QString& appId) const;
+    void addCloseCallbackSample(const QString& appId, int elapsedMs, bool timedOut);
+    void addTimeToClose(const QString& appId, int elapsedMs);
+
+    QJsonObject toJson() const;
+
+private:
+    struct AppSamples {
+        AppSamples()
+            : closeCount(0)
+            , callbackTimeoutCount(0)
+            , lastTimeToCloseMs(0)
+            , maxTimeToCloseMs(0)
+            , lastUse(0)
+        {
+        }
+
+        QList<int> callbackDurations;
+        int closeCount;
+        int callbackTimeoutCount;
+        int lastTimeToCloseMs;
+        int maxTimeToCloseMs;
+        unsigned lastUse;
+    };
+
+    // Samples of appId, the least recently used app is dropped to make room
+    AppSamples& samplesFor(const QString& appId);
+    static int bucketIndex(int elapsedMs);
+
+    QMap<QString, AppSamples> m_apps;
+    unsigned m_useCount;
+    QVector<int> m_timeToCloseHistogram;
+    int m_maxCloseCallbackTimeoutMs;
+};
+
+#endif // APPCLOSESTATISTICS_H
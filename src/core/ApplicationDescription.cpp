@@ -135,8 +135,11 @@ ApplicationDescription* ApplicationDescription::fromJsonString(const char* jsonS
                     PMLOGKFV("JSON", "%s", jsonStr), "Failed to parse JSON string");
         return 0;
     }
-    QJsonObject jsonObj = jsonDoc.object();
+    return fromJsonObject(jsonDoc.object());
+}
 
+ApplicationDescription* ApplicationDescription::fromJsonObject(const QJsonObject& jsonObj)
+{
     ApplicationDescription* appDesc = new ApplicationDescription();
 
     appDesc->m_transparency = jsonObj["transparent"].toBool();
@@ -126,6 +126,7 @@ public:
     }
 
     static ApplicationDescription* fromJsonString(const char* jsonStr);
+    static ApplicationDescription* fromJsonObject(const QJsonObject& jsonObj);
 
     bool isInspectable() const { return m_inspectable; }
     bool useCustomPlugin() const { return m_customPlugin; }
@@ -0,0 +1,86 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "BroadcastService.h"
+
+#include "WebPageBase.h"
+
+BroadcastService::BroadcastService()
+{
+}
+
+void BroadcastService::begin(const QString& name)
+{
+    Broadcast broadcast;
+    broadcast.statistics = &m_events[name];
+    broadcast.statistics->count++;
+    broadcast.fanOutTimer.start();
+    m_broadcasts.append(broadcast);
+}
+
+bool BroadcastService::shouldDefer(WebPageBase* page)
+{
+    if (!page || !page->isJavaScriptHeld())
+        return false;
+
+    if (EventStatistics* statistics = current())
+        statistics->wakeupsAvoided++;
+    return true;
+}
+
+void BroadcastService::deliver(WebPageBase* page)
+{
+    if (!page || !page->hasPendingJavaScript())
+        return;
+
+    if (page->isJavaScriptHeld()) {
+        if (EventStatistics* statistics = current())
+            statistics->mailboxed++;
+        return;
+    }
+
+    page->flushJavaScript();
+    if (EventStatistics* statistics = current())
+        statistics->delivered++;
+}
+
+void BroadcastService::end()
+{
+    if (m_broadcasts.isEmpty())
+        return;
+
+    Broadcast broadcast = m_broadcasts.takeLast();
+    qint64 elapsed = broadcast.fanOutTimer.nsecsElapsed();
+    broadcast.statistics->totalNs += elapsed;
+    if (elapsed > broadcast.statistics->maxNs)
+        broadcast.statistics->maxNs = elapsed;
+}
+
+QJsonObject BroadcastService::statistics() const
+{
+    QJsonObject result;
+    for (QMap<QString, EventStatistics>::const_iterator it = m_events.begin(); it != m_events.end(); ++it) {
+        QJsonObject event;
+        event["count"] = static_cast<double>(it->count);
+        event["delivered"] = static_cast<double>(it->delivered);
+        event["mailboxed"] = static_cast<double>(it->mailboxed);
+        event["wakeupsAvoided"] = static_cast<double>(it->wakeupsAvoided);
+        event["avgFanOutUs"] = it->count ? static_cast<double>(it->totalNs / it->count) / 1000 : 0.0;
+        event["maxFanOutUs"] = static_cast<double>(it->maxNs) / 1000;
+        result[it.key()] = event;
+    }
+    return result;
+}
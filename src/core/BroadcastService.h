@@ -0,0 +1,79 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef BROADCASTSERVICE_H
+#define BROADCASTSERVICE_H
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+class WebPageBase;
+
+// Fans a system event out to every page. Whatever a page queued for the
+// event is delivered right away when the page is in the foreground, and
+// left in the page's mailbox (its held JsInjectionQueue) when the page is
+// suspended, to be drained on resume without waking the renderer now.
+// Engine calls of the event are deferred the same way, see shouldDefer().
+// A broadcast begun while another fans out, e.g. by a page handling the
+// outer one, is counted on its own and the outer one resumes after it.
+class BroadcastService {
+public:
+    BroadcastService();
+
+    void begin(const QString& name);
+    // Whether the page is held, so its engine calls wait for its release
+    bool shouldDefer(WebPageBase* page);
+    void deliver(WebPageBase* page);
+    void end();
+
+    QJsonObject statistics() const;
+
+private:
+    struct EventStatistics {
+        EventStatistics()
+            : count(0)
+            , delivered(0)
+            , mailboxed(0)
+            , wakeupsAvoided(0)
+            , totalNs(0)
+            , maxNs(0)
+        {
+        }
+
+        quint64 count;
+        quint64 delivered;
+        quint64 mailboxed;
+        quint64 wakeupsAvoided; // engine calls not made to a held page
+        qint64 totalNs;
+        qint64 maxNs;
+    };
+
+    struct Broadcast {
+        EventStatistics* statistics;
+        QElapsedTimer fanOutTimer;
+    };
+
+    EventStatistics* current() const { return m_broadcasts.isEmpty() ? 0 : m_broadcasts.last().statistics; }
+
+    QMap<QString, EventStatistics> m_events;
+    // Innermost last
+    QVector<Broadcast> m_broadcasts;
+};
+
+#endif // BROADCASTSERVICE_H
@@ -143,6 +143,7 @@ WebAppBase* ContainerAppManager::launchContainerAppInternal(const std::string& i
 
     std::string url = desc->entryPoint();
     WebPageBase* page = WebAppFactoryManager::instance()->createWebPage(WT_CARD, QUrl(url.c_str()), desc, desc->subType().c_str());
+    page->init();
 
     // Turning off inline caching on container app, too.
     if (m_useContainerAppOptimization)
@@ -0,0 +1,241 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "FlightRecorder.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <glib.h>
+
+#include <QJsonObject>
+
+static const int kMaxEvents = 1024;
+static const int kMaxAppIdLength = 48;
+static const int kMaxPathLength = 256;
+// The current dump and the previous ones, <path> and <path>.1 to <path>.3
+static const int kDumpFileCount = 4;
+
+static const char* const kEventNames[] = {
+    "launch",
+    "preload",
+    "relaunch",
+    "revive",
+    "suspend",
+    "resume",
+    "close",
+    "hibernate",
+    "crash",
+    "memoryPressure",
+    "containerLaunch",
+    "containerBasedLaunch",
+    "containerReady"
+};
+
+static const int kCrashSignals[] = { SIGSEGV, SIGABRT, SIGBUS, SIGFPE, SIGILL };
+static const int kCrashSignalCount = sizeof(kCrashSignals) / sizeof(kCrashSignals[0]);
+
+struct FlightEvent {
+    gint64 timeUs;
+    int event;
+    int value;
+    char appId[kMaxAppIdLength];
+};
+
+static FlightEvent s_events[kMaxEvents];
+static unsigned s_eventCount = 0;
+// Built by setDumpPath(), the crash handler can not format them
+static char s_dumpPaths[kDumpFileCount][kMaxPathLength + 2] = {
+    "/tmp/wam-flight-recorder.txt",
+    "/tmp/wam-flight-recorder.txt.1",
+    "/tmp/wam-flight-recorder.txt.2",
+    "/tmp/wam-flight-recorder.txt.3"
+};
+static struct sigaction s_previousActions[kCrashSignalCount];
+static bool s_crashHandlerInstalled = false;
+
+static void recordEvent(FlightRecorder::Event event, const char* appId, int length, int value)
+{
+    FlightEvent& entry = s_events[s_eventCount % kMaxEvents];
+    entry.timeUs = g_get_real_time();
+    entry.event = event;
+    entry.value = value;
+
+    length = length < kMaxAppIdLength - 1 ? length : kMaxAppIdLength - 1;
+    memcpy(entry.appId, appId, length);
+    entry.appId[length] = '\0';
+    s_eventCount++;
+}
+
+void FlightRecorder::record(Event event, const QString& appId, int value)
+{
+    QByteArray utf8 = appId.toUtf8();
+    recordEvent(event, utf8.constData(), utf8.size(), value);
+}
+
+void FlightRecorder::record(Event event, const std::string& appId, int value)
+{
+    recordEvent(event, appId.c_str(), appId.size(), value);
+}
+
+QJsonArray FlightRecorder::toJson()
+{
+    QJsonArray events;
+    unsigned first = s_eventCount > kMaxEvents ? s_eventCount - kMaxEvents : 0;
+    for (unsigned i = first; i < s_eventCount; i++) {
+        const FlightEvent& entry = s_events[i % kMaxEvents];
+        QJsonObject event;
+        event["time"] = static_cast<double>(entry.timeUs / 1000);
+        event["event"] = kEventNames[entry.event];
+        event["appId"] = QString::fromUtf8(entry.appId);
+        event["value"] = entry.value;
+        events.append(event);
+    }
+    return events;
+}
+
+// Formatting below avoids stdio, it runs in the crash signal handler
+static char* appendString(char* out, const char* end, const char* text)
+{
+    while (*text && out < end)
+        *out++ = *text++;
+    return out;
+}
+
+static char* appendNumber(char* out, const char* end, long long number, int minDigits = 1)
+{
+    char digits[24];
+    int count = 0;
+    bool negative = number < 0;
+    unsigned long long value = negative ? -static_cast<unsigned long long>(number) : number;
+    do {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while (value || count < minDigits);
+
+    if (negative && out < end)
+        *out++ = '-';
+    while (count && out < end)
+        *out++ = digits[--count];
+    return out;
+}
+
+static bool writeAll(int fd, const char* data, size_t size)
+{
+    while (size) {
+        ssize_t written = write(fd, data, size);
+        if (written < 0)
+            return false;
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+bool FlightRecorder::dump()
+{
+    // Rotation fails harmlessly for the files that do not exist yet
+    for (int i = kDumpFileCount - 1; i > 0; i--)
+        rename(s_dumpPaths[i - 1], s_dumpPaths[i]);
+
+    int fd = open(s_dumpPaths[0], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return false;
+
+    // One line per event: <seconds>.<us> <event> <appId> <value>
+    char line[128];
+    const char* end = line + sizeof(line) - 1;
+    char* out = appendString(line, end, "# WAM flight recorder, pid ");
+    out = appendNumber(out, end, getpid());
+    *out++ = '\n';
+    bool ok = writeAll(fd, line, out - line);
+
+    unsigned count = s_eventCount;
+    unsigned first = count > kMaxEvents ? count - kMaxEvents : 0;
+    for (unsigned i = first; ok && i < count; i++) {
+        const FlightEvent& entry = s_events[i % kMaxEvents];
+        out = appendNumber(line, end, entry.timeUs / G_USEC_PER_SEC);
+        out = appendString(out, end, ".");
+        out = appendNumber(out, end, entry.timeUs % G_USEC_PER_SEC, 6);
+        out = appendString(out, end, " ");
+        out = appendString(out, end, entry.event < EventCount ? kEventNames[entry.event] : "?");
+        out = appendString(out, end, " ");
+        out = appendString(out, end, entry.appId[0] ? entry.appId : "-");
+        out = appendString(out, end, " ");
+        out = appendNumber(out, end, entry.value);
+        *out++ = '\n';
+        ok = writeAll(fd, line, out - line);
+    }
+
+    close(fd);
+    return ok;
+}
+
+void FlightRecorder::setDumpPath(const std::string& path)
+{
+    if (path.empty() || path.size() >= kMaxPathLength)
+        return;
+    memcpy(s_dumpPaths[0], path.c_str(), path.size() + 1);
+    for (int i = 1; i < kDumpFileCount; i++) {
+        memcpy(s_dumpPaths[i], path.c_str(), path.size());
+        s_dumpPaths[i][path.size()] = '.';
+        s_dumpPaths[i][path.size() + 1] = '0' + i;
+        s_dumpPaths[i][path.size() + 2] = '\0';
+    }
+}
+
+const char* FlightRecorder::dumpPath()
+{
+    return s_dumpPaths[0];
+}
+
+static void crashHandler(int signal, siginfo_t* info, void* context)
+{
+    FlightRecorder::dump();
+
+    for (int i = 0; i < kCrashSignalCount; i++) {
+        if (kCrashSignals[i] != signal)
+            continue;
+
+        // A crash reporter installed before us gets the siginfo of the
+        // fault, not the one of a signal raised here
+        const struct sigaction& previous = s_previousActions[i];
+        sigaction(signal, &previous, 0);
+        if ((previous.sa_flags & SA_SIGINFO) && previous.sa_sigaction) {
+            previous.sa_sigaction(signal, info, context);
+            return;
+        }
+    }
+    raise(signal);
+}
+
+void FlightRecorder::installCrashHandler()
+{
+    if (s_crashHandlerInstalled)
+        return;
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = crashHandler;
+    action.sa_flags = SA_SIGINFO;
+    sigemptyset(&action.sa_mask);
+    for (int i = 0; i < kCrashSignalCount; i++)
+        sigaction(kCrashSignals[i], &action, &s_previousActions[i]);
+    s_crashHandlerInstalled = true;
+}
@@ -0,0 +1,67 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef FLIGHTRECORDER_H
+#define FLIGHTRECORDER_H
+
+#include <string>
+
+#include <QJsonArray>
+#include <QString>
+
+// Always on ring of the last app lifecycle events (launch, suspend, close,
+// crash, ...) with wall clock time, app id and a value (mostly the web
+// process pid). It is written to the dump path when WAM crashes, when a
+// web process crashes, and on request over Luna. The previous dumps are
+// kept as <path>.1 to <path>.3, so a later crash does not overwrite the
+// dump of an earlier one.
+// Events are recorded on the main thread. Recording copies a fixed size
+// entry, so leaving it on costs next to nothing.
+class FlightRecorder {
+public:
+    enum Event {
+        Launch,
+        Preload,
+        Relaunch,
+        Revive,
+        Suspend,
+        Resume,
+        Close,
+        Hibernate,
+        Crash,
+        MemoryPressure,
+        ContainerLaunch,
+        ContainerBasedLaunch,
+        ContainerReady,
+        EventCount
+    };
+
+    static void record(Event event, const QString& appId, int value = 0);
+    static void record(Event event, const std::string& appId, int value = 0);
+
+    static QJsonArray toJson();
+    // Writes the configured dump path. Async signal safe, also used by the
+    // crash handler
+    static bool dump();
+
+    static void setDumpPath(const std::string& path);
+    static const char* dumpPath();
+    // Dumps on SIGSEGV, SIGABRT, SIGBUS, SIGFPE and SIGILL, then hands the
+    // signal with its original siginfo to the previous handler
+    static void installCrashHandler();
+};
+
+#endif // FLIGHTRECORDER_H
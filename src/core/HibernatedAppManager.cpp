@@ -0,0 +1,275 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "HibernatedAppManager.h"
+
+#include <algorithm>
+
+#include <QJsonArray>
+
+#include "LogManager.h"
+#include "Metrics.h"
+#include "WebAppBase.h"
+#include "WebAppManager.h"
+#include "WebPageBase.h"
+#include "WebProcessManager.h"
+
+static const char* const kEvictReasonNames[] = {
+    "expired",
+    "overLimit",
+    "memoryPressure",
+    "closeAll",
+    "crashed",
+    "stale"
+};
+
+// Lets the close settle before VmRSS of the web process is read
+static const int kMemoryCheckDelayMs = 1000;
+// Hibernated apps grow as their web processes do
+static const int kMemoryCheckIntervalMs = 10000;
+
+HibernatedAppManager::HibernatedAppManager()
+    : m_maxApps(0)
+    , m_timeoutMs(0)
+    , m_memoryBudgetKb(0)
+    , m_hibernatedCount(0)
+    , m_reviveCount(0)
+    , m_missCount(0)
+{
+    std::fill(m_evictedCount, m_evictedCount + EvictStale + 1, 0);
+    m_clock.start();
+}
+
+HibernatedAppManager::~HibernatedAppManager()
+{
+    for (EntryList::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+        delete it->app;
+    m_entries.clear();
+}
+
+void HibernatedAppManager::setLimits(int maxApps, int timeoutMs, int memoryBudgetKb)
+{
+    m_maxApps = maxApps;
+    m_timeoutMs = timeoutMs;
+    m_memoryBudgetKb = memoryBudgetKb;
+
+    if (!isEnabled())
+        evictAll(EvictOverLimit);
+    else
+        enforceLimits();
+}
+
+bool HibernatedAppManager::hibernate(WebAppBase* app)
+{
+    if (!isEnabled() || !app)
+        return false;
+
+    Entry entry;
+    entry.app = app;
+    entry.since.start();
+    m_entries.push_back(entry);
+    m_hibernatedCount++;
+
+    LOG_INFO(MSGID_APP_HIBERNATED, 2, PMLOGKS("APP_ID", qPrintable(app->appId())), PMLOGKFV("PID", "%d", app->page()->getWebProcessPID()), "");
+
+    enforceLimits();
+    restartExpireTimer();
+    if (m_memoryBudgetKb > 0 && !m_memoryCheckTimer.isRunning())
+        m_memoryCheckTimer.start(kMemoryCheckDelayMs, this, &HibernatedAppManager::checkMemoryBudget);
+    return true;
+}
+
+WebAppBase* HibernatedAppManager::revive(const QString& appId)
+{
+    for (EntryList::iterator it = m_entries.begin(); it != m_entries.end(); ++it) {
+        if (it->app->appId() != appId)
+            continue;
+
+        WebAppBase* app = it->app;
+        LOG_INFO(MSGID_APP_REVIVED, 2, PMLOGKS("APP_ID", qPrintable(appId)), PMLOGKFV("HIBERNATED_MS", "%lld", it->since.elapsed()), "");
+        m_entries.erase(it);
+        m_reviveCount++;
+
+        static Counter* s_hits = Metrics::counter("wam_hibernation_reopens_total", "Reopens of recently closed apps", "result", "hit");
+        s_hits->increment();
+        restartExpireTimer();
+        return app;
+    }
+    return 0;
+}
+
+WebAppBase* HibernatedAppManager::find(const QString& appId) const
+{
+    for (EntryList::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it) {
+        if (it->app->appId() == appId)
+            return it->app;
+    }
+    return 0;
+}
+
+void HibernatedAppManager::evict(const QString& appId, EvictReason reason)
+{
+    for (EntryList::iterator it = m_entries.begin(); it != m_entries.end(); ++it) {
+        if (it->app->appId() == appId) {
+            evictEntry(it, reason);
+            restartExpireTimer();
+            return;
+        }
+    }
+}
+
+void HibernatedAppManager::evictAll(EvictReason reason, uint32_t pid)
+{
+    EntryList::iterator it = m_entries.begin();
+    while (it != m_entries.end()) {
+        EntryList::iterator current = it++;
+        if (!pid || current->app->page()->getWebProcessPID() == pid)
+            evictEntry(current, reason);
+    }
+    restartExpireTimer();
+}
+
+void HibernatedAppManager::noteColdLaunch(const QString& appId)
+{
+    // A cold launch of an app that was evicted from this list is a reopen miss
+    pruneEvictedAppIds();
+    if (m_evictedAppIds.remove(appId)) {
+        static Counter* s_misses = Metrics::counter("wam_hibernation_reopens_total", "Reopens of recently closed apps", "result", "miss");
+        s_misses->increment();
+        m_missCount++;
+    }
+}
+
+void HibernatedAppManager::evictEntry(EntryList::iterator it, EvictReason reason)
+{
+    WebAppBase* app = it->app;
+    m_entries.erase(it);
+    m_evictedCount[reason]++;
+    pruneEvictedAppIds();
+    if (reason != EvictCrashed && reason != EvictStale)
+        m_evictedAppIds.insert(app->appId(), m_clock.elapsed());
+
+    LOG_INFO(MSGID_HIBERNATED_APP_EVICTED, 2, PMLOGKS("APP_ID", qPrintable(app->appId())), PMLOGKS("REASON", kEvictReasonNames[reason]), "");
+    WebAppManager::instance()->closeHibernatedApp(app);
+}
+
+void HibernatedAppManager::enforceLimits()
+{
+    // Oldest entries are at the front
+    while ((int)m_entries.size() > m_maxApps)
+        evictEntry(m_entries.begin(), EvictOverLimit);
+}
+
+void HibernatedAppManager::expireTimeout()
+{
+    while (!m_entries.empty() && m_entries.front().since.elapsed() >= m_timeoutMs)
+        evictEntry(m_entries.begin(), EvictExpired);
+    restartExpireTimer();
+}
+
+void HibernatedAppManager::restartExpireTimer()
+{
+    if (m_expireTimer.isRunning())
+        m_expireTimer.stop();
+
+    if (m_entries.empty())
+        return;
+
+    int remaining = m_timeoutMs - static_cast<int>(m_entries.front().since.elapsed());
+    m_expireTimer.start(std::max(remaining, 0), this, &HibernatedAppManager::expireTimeout);
+}
+
+void HibernatedAppManager::checkMemoryBudget()
+{
+    if (m_memoryBudgetKb <= 0 || m_entries.empty())
+        return;
+
+    QHash<uint32_t, int> hibernatedApps;
+    for (EntryList::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+        hibernatedApps[it->app->page()->getWebProcessPID()]++;
+
+    // Each web process is read once and split evenly over its apps
+    WebAppManager* manager = WebAppManager::instance();
+    WebProcessManager* processManager = manager->getWebProcessManager();
+    QHash<uint32_t, int> appShareKb;
+    int hibernatedKb = 0;
+    for (QHash<uint32_t, int>::const_iterator it = hibernatedApps.begin(); it != hibernatedApps.end(); ++it) {
+        uint32_t pid = it.key();
+        if (!pid)
+            continue;
+
+        // VmRSS is reported as "<size> kB"
+        int memoryKb = processManager->getWebProcessMemSize(pid).section(' ', 0, 0).toInt();
+        int apps = it.value() + static_cast<int>(manager->runningApps(pid).size());
+        appShareKb[pid] = memoryKb / apps;
+        hibernatedKb += appShareKb[pid] * it.value();
+    }
+
+    // Oldest entries are at the front
+    while (hibernatedKb > m_memoryBudgetKb && !m_entries.empty()) {
+        hibernatedKb -= appShareKb.value(m_entries.front().app->page()->getWebProcessPID());
+        evictEntry(m_entries.begin(), EvictOverLimit);
+    }
+    restartExpireTimer();
+
+    if (!m_entries.empty())
+        m_memoryCheckTimer.start(kMemoryCheckIntervalMs, this, &HibernatedAppManager::checkMemoryBudget);
+}
+
+void HibernatedAppManager::pruneEvictedAppIds()
+{
+    // Apps not launched again within the timeout would have expired anyway
+    qint64 now = m_clock.elapsed();
+    QHash<QString, qint64>::iterator it = m_evictedAppIds.begin();
+    while (it != m_evictedAppIds.end()) {
+        if (now - it.value() >= m_timeoutMs)
+            it = m_evictedAppIds.erase(it);
+        else
+            ++it;
+    }
+}
+
+QJsonObject HibernatedAppManager::statistics() const
+{
+    QJsonObject result;
+
+    QJsonArray apps;
+    for (EntryList::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it) {
+        QJsonObject app;
+        app["id"] = it->app->appId();
+        app["pid"] = static_cast<int>(it->app->page()->getWebProcessPID());
+        app["hibernatedTime"] = static_cast<double>(it->since.elapsed());
+        apps.append(app);
+    }
+
+    QJsonObject evicted;
+    for (int i = 0; i <= EvictStale; i++)
+        evicted[kEvictReasonNames[i]] = m_evictedCount[i];
+
+    int reopens = m_reviveCount + m_missCount;
+
+    result["enabled"] = isEnabled();
+    result["maxApps"] = m_maxApps;
+    result["timeout"] = m_timeoutMs;
+    result["memoryBudget"] = m_memoryBudgetKb;
+    result["apps"] = apps;
+    result["hibernated"] = m_hibernatedCount;
+    result["revived"] = m_reviveCount;
+    result["missed"] = m_missCount;
+    result["hitRate"] = reopens ? static_cast<double>(m_reviveCount) / reopens : 0.0;
+    result["evicted"] = evicted;
+    return result;
+}
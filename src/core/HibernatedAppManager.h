@@ -0,0 +1,102 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef HIBERNATEDAPPMANAGER_H
+#define HIBERNATEDAPPMANAGER_H
+
+#include "Timer.h"
+
+#include <list>
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QHash>
+#include <QString>
+
+class WebAppBase;
+
+// Holds recently closed apps with their window hidden and page suspended,
+// so a relaunch of the same app within the hibernation timeout can reuse
+// the web view and renderer instead of a cold launch.
+// Apps leave the list by revive() or by eviction, which hands them back to
+// WebAppManager for the normal close teardown.
+// The memory budget applies to all hibernated apps together. VmRSS is known
+// per web process only, so each app in a process, running or hibernated, is
+// taken to hold an even share of it. The budget is checked shortly after an
+// app is hibernated, rather than on the close path, and then periodically
+// while any app is hibernated.
+class HibernatedAppManager {
+public:
+    enum EvictReason {
+        EvictExpired,
+        EvictOverLimit,
+        EvictMemoryPressure,
+        EvictCloseAll,
+        EvictCrashed,
+        EvictStale
+    };
+
+    HibernatedAppManager();
+    ~HibernatedAppManager();
+
+    void setLimits(int maxApps, int timeoutMs, int memoryBudgetKb);
+    bool isEnabled() const { return m_maxApps > 0 && m_timeoutMs > 0; }
+
+    bool hibernate(WebAppBase* app);
+    WebAppBase* revive(const QString& appId);
+    WebAppBase* find(const QString& appId) const;
+    void evict(const QString& appId, EvictReason reason);
+    void evictAll(EvictReason reason, uint32_t pid = 0);
+    void noteColdLaunch(const QString& appId);
+    // The app ran again without a cold launch or closed for good, so a
+    // later cold launch is no reopen miss
+    void forgetEvicted(const QString& appId) { m_evictedAppIds.remove(appId); }
+
+    QJsonObject statistics() const;
+
+private:
+    struct Entry {
+        WebAppBase* app;
+        QElapsedTimer since;
+    };
+    typedef std::list<Entry> EntryList;
+
+    void evictEntry(EntryList::iterator it, EvictReason reason);
+    void enforceLimits();
+    void expireTimeout();
+    void restartExpireTimer();
+    void checkMemoryBudget();
+    void pruneEvictedAppIds();
+
+    EntryList m_entries;
+    OneShotTimer<HibernatedAppManager> m_expireTimer;
+    OneShotTimer<HibernatedAppManager> m_memoryCheckTimer;
+    // Evicted apps by eviction time on m_clock, a cold launch of one within
+    // the hibernation timeout is a reopen miss
+    QHash<QString, qint64> m_evictedAppIds;
+    QElapsedTimer m_clock;
+
+    int m_maxApps;
+    int m_timeoutMs;
+    int m_memoryBudgetKb;
+
+    int m_hibernatedCount;
+    int m_reviveCount;
+    int m_missCount;
+    int m_evictedCount[EvictStale + 1];
+};
+
+#endif /* HIBERNATEDAPPMANAGER_H */
@@ -0,0 +1,158 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "JsInjectionQueue.h"
+
+#include <QStringList>
+
+#include "LogManager.h"
+#include "Metrics.h"
+#include "WebAppManagerTracer.h"
+#include "WebPageBase.h"
+
+static Counter* injectionCounter(const char* result)
+{
+    return Metrics::counter("wam_js_injections_total", "Scripts posted to pages", "result", result);
+}
+
+static Counter* mailboxDeliveryCounter()
+{
+    static Counter* s_deliveries = Metrics::counter("wam_js_injection_mailbox_deliveries_total", "Batches delivered to held pages on release");
+    return s_deliveries;
+}
+
+JsInjectionQueue::JsInjectionQueue(WebPageBase* page)
+    : m_page(page)
+    , m_held(false)
+{
+}
+
+void JsInjectionQueue::post(const QString& key, const QString& script, Target target)
+{
+    static Counter* s_posted = injectionCounter("posted");
+    static Counter* s_held = injectionCounter("held");
+    s_posted->increment();
+    if (m_held)
+        s_held->increment();
+
+    // Last writer wins, and it is ordered after everything posted before it
+    for (QList<Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it) {
+        if (it->key == key && it->target == target) {
+            static Counter* s_superseded = injectionCounter("superseded");
+            static Counter* s_supersededBytes = Metrics::counter("wam_js_injection_superseded_bytes_total", "Bytes of scripts replaced before evaluation");
+            s_superseded->increment();
+            s_supersededBytes->increment(it->script.size());
+            m_entries.erase(it);
+            break;
+        }
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.script = script;
+    entry.target = target;
+    m_entries.append(entry);
+
+    scheduleFlush();
+}
+
+void JsInjectionQueue::flush()
+{
+    if (m_flushTimer.isRunning())
+        m_flushTimer.stop();
+
+    if (m_entries.isEmpty())
+        return;
+    TRACE_EVENT_SCOPE("JsInjectionQueue::flush");
+
+    if (m_held)
+        mailboxDeliveryCounter()->increment();
+
+    // Take the entries first, evaluating may post or flush again
+    QList<Entry> entries;
+    entries.swap(m_entries);
+
+    // One evaluation per run of scripts with the same target keeps the order
+    QStringList scripts;
+    Target target = entries.first().target;
+    for (QList<Entry>::const_iterator it = entries.begin(); it != entries.end(); ++it) {
+        if (it->target != target) {
+            evaluate(scripts, target);
+            scripts.clear();
+            target = it->target;
+        }
+        scripts.append(it->script);
+    }
+    evaluate(scripts, target);
+}
+
+void JsInjectionQueue::clear()
+{
+    if (m_flushTimer.isRunning())
+        m_flushTimer.stop();
+    m_entries.clear();
+}
+
+void JsInjectionQueue::setHeld(bool held)
+{
+    if (m_held == held)
+        return;
+
+    m_held = held;
+    if (m_held) {
+        if (m_flushTimer.isRunning())
+            m_flushTimer.stop();
+        return;
+    }
+
+    // Deferred engine calls first, they may post scripts of their own
+    m_page->applyDeferredCalls();
+    if (!m_entries.isEmpty()) {
+        mailboxDeliveryCounter()->increment();
+        scheduleFlush();
+    }
+}
+
+void JsInjectionQueue::scheduleFlush()
+{
+    if (m_held || m_flushTimer.isRunning())
+        return;
+    m_flushTimer.start(0, this, &JsInjectionQueue::flush);
+}
+
+void JsInjectionQueue::evaluate(const QStringList& scripts, Target target)
+{
+    // Merged scripts are isolated from each other, one throwing does not skip the rest
+    QString script;
+    if (scripts.size() == 1) {
+        script = scripts.first();
+    } else {
+        for (QStringList::const_iterator it = scripts.begin(); it != scripts.end(); ++it)
+            script += QStringLiteral("try {") + *it + QStringLiteral("} catch (e) { console.error(e); }");
+    }
+
+    static Counter* s_evaluations = Metrics::counter("wam_js_injection_evaluations_total", "Evaluations of queued scripts");
+    static Counter* s_evaluatedBytes = Metrics::counter("wam_js_injection_evaluated_bytes_total", "Bytes of queued scripts evaluated");
+    s_evaluations->increment();
+    s_evaluatedBytes->increment(script.size());
+    LOG_DEBUG("[%s] Evaluate %d queued script(s) in %s", qPrintable(m_page->appId()), scripts.size(),
+        target == MainFrame ? "main frame" : "all frames");
+
+    if (target == MainFrame)
+        m_page->evaluateJavaScript(script);
+    else
+        m_page->evaluateJavaScriptInAllFrames(script);
+}
@@ -0,0 +1,68 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef JSINJECTIONQUEUE_H
+#define JSINJECTIONQUEUE_H
+
+#include "Timer.h"
+
+#include <QList>
+#include <QString>
+
+class QStringList;
+class WebPageBase;
+
+// Collects keyed scripts for a page and evaluates them on the next main loop
+// iteration, in posting order. Consecutive scripts for the same target are
+// merged into one evaluation. A script posted again with the same key
+// replaces the pending one, so only the latest state is sent.
+// While the page is held (suspended) the queue is the page's mailbox:
+// nothing is evaluated and everything pending, deferred engine calls of
+// the page included, is delivered in one batch on release.
+class JsInjectionQueue {
+public:
+    enum Target {
+        MainFrame,
+        AllFrames
+    };
+
+    JsInjectionQueue(WebPageBase* page);
+
+    void post(const QString& key, const QString& script, Target target = MainFrame);
+    void flush();
+    void clear();
+    bool isEmpty() const { return m_entries.isEmpty(); }
+
+    void setHeld(bool held);
+    bool isHeld() const { return m_held; }
+
+private:
+    struct Entry {
+        QString key;
+        QString script;
+        Target target;
+    };
+
+    void scheduleFlush();
+    void evaluate(const QStringList& scripts, Target target);
+
+    WebPageBase* m_page;
+    QList<Entry> m_entries;
+    OneShotTimer<JsInjectionQueue> m_flushTimer;
+    bool m_held;
+};
+
+#endif // JSINJECTIONQUEUE_H
@@ -0,0 +1,328 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "LaunchTimeline.h"
+
+#include <algorithm>
+#include <deque>
+#include <list>
+#include <map>
+#include <vector>
+
+#include <glib.h>
+
+#include <QJsonArray>
+
+#include "LogManager.h"
+#include "Metrics.h"
+
+static const int kMaxRecentLaunches = 64;
+static const int kMaxAppSamples = 32;
+static const size_t kMaxSampledApps = 64;
+static const gint64 kLaunchTimeoutUs = 60 * G_USEC_PER_SEC;
+
+static const char* const kPhaseNames[] = {
+    "received",
+    "descriptorParsed",
+    "admitted",
+    "appCreated",
+    "replied",
+    "pageCreated",
+    "pageInitialized",
+    "windowAttached",
+    "loadUrl",
+    "firstFrameSwapped",
+    "loadFinished",
+    "visuallyCommitted"
+};
+
+struct Launch {
+    int id;
+    int batch;
+    std::string appId;
+    QString instanceId;
+    const char* type;
+    const char* result;
+    gint64 phaseUs[LaunchTimeline::PhaseCount];
+};
+
+// Offsets from the LS2 receive in ms of the completed launches of an app
+struct AppSamples {
+    AppSamples()
+        : lastUse(0)
+    {
+    }
+
+    unsigned lastUse;
+    std::deque<double> total;
+    std::deque<double> phases[LaunchTimeline::PhaseCount];
+};
+
+static int s_nextLaunchId = 1;
+static int s_nextBatchId = 1;
+static int s_batch = 0;
+static gint64 s_batchReceivedUs = 0;
+static Launch* s_pending = 0;
+static std::list<Launch> s_inFlight;
+static std::deque<Launch> s_recent;
+static std::map<std::string, AppSamples> s_appSamples;
+static unsigned s_sampleUseCount = 0;
+
+static double offsetMs(const Launch& launch, int phase)
+{
+    return (launch.phaseUs[phase] - launch.phaseUs[LaunchTimeline::PhaseReceived]) / 1000.0;
+}
+
+static void addSample(std::deque<double>& samples, double value)
+{
+    samples.push_back(value);
+    if (samples.size() > kMaxAppSamples)
+        samples.pop_front();
+}
+
+// The least recently launched app makes room for a new one
+static AppSamples& samplesFor(const std::string& appId)
+{
+    std::map<std::string, AppSamples>::iterator it = s_appSamples.find(appId);
+    if (it == s_appSamples.end() && s_appSamples.size() >= kMaxSampledApps) {
+        std::map<std::string, AppSamples>::iterator oldest = s_appSamples.begin();
+        for (std::map<std::string, AppSamples>::iterator candidate = s_appSamples.begin(); candidate != s_appSamples.end(); ++candidate) {
+            if (candidate->second.lastUse < oldest->second.lastUse)
+                oldest = candidate;
+        }
+        s_appSamples.erase(oldest);
+    }
+
+    AppSamples& samples = s_appSamples[appId];
+    samples.lastUse = ++s_sampleUseCount;
+    return samples;
+}
+
+static void record(const Launch& launch, const char* result)
+{
+    s_recent.push_back(launch);
+    s_recent.back().result = result;
+    if (s_recent.size() > kMaxRecentLaunches)
+        s_recent.pop_front();
+
+    if (launch.phaseUs[LaunchTimeline::PhaseLoadFinished] && launch.phaseUs[LaunchTimeline::PhaseVisuallyCommitted]) {
+        double total = std::max(offsetMs(launch, LaunchTimeline::PhaseLoadFinished),
+            offsetMs(launch, LaunchTimeline::PhaseVisuallyCommitted));
+
+        AppSamples& samples = samplesFor(launch.appId);
+        addSample(samples.total, total);
+        for (int i = 0; i < LaunchTimeline::PhaseCount; i++) {
+            if (launch.phaseUs[i])
+                addSample(samples.phases[i], offsetMs(launch, i));
+        }
+
+        Metrics::histogram("wam_app_launch_duration_ms", "Launch request to loaded and visually committed",
+            Metrics::kDurationBucketsMs, Metrics::kDurationBucketsMsCount, "type", launch.type)
+            ->observe(static_cast<int64_t>(total));
+
+        LOG_INFO(MSGID_APP_LAUNCH_TIMELINE, 4, PMLOGKS("APP_ID", launch.appId.c_str()),
+            PMLOGKFV("LAUNCH_ID", "%d", launch.id), PMLOGKS("TYPE", launch.type),
+            PMLOGKFV("TOTAL_MS", "%.1f", total), "");
+    }
+}
+
+static void expireInFlight()
+{
+    gint64 now = g_get_monotonic_time();
+    std::list<Launch>::iterator it = s_inFlight.begin();
+    while (it != s_inFlight.end()) {
+        if (now - it->phaseUs[LaunchTimeline::PhaseReceived] < kLaunchTimeoutUs) {
+            ++it;
+            continue;
+        }
+        record(*it, "timeout");
+        it = s_inFlight.erase(it);
+    }
+}
+
+void LaunchTimeline::begin(const std::string& appId)
+{
+    expireInFlight();
+
+    if (!s_pending)
+        s_pending = new Launch;
+
+    s_pending->id = s_nextLaunchId++;
+    s_pending->batch = s_batch;
+    s_pending->appId = appId;
+    s_pending->instanceId = QString();
+    s_pending->type = "unknown";
+    s_pending->result = 0;
+    std::fill(s_pending->phaseUs, s_pending->phaseUs + PhaseCount, 0);
+    s_pending->phaseUs[PhaseReceived] = s_batch ? s_batchReceivedUs : g_get_monotonic_time();
+}
+
+void LaunchTimeline::beginBatch()
+{
+    s_batch = s_nextBatchId++;
+    s_batchReceivedUs = g_get_monotonic_time();
+}
+
+void LaunchTimeline::endBatch()
+{
+    s_batch = 0;
+}
+
+void LaunchTimeline::mark(Phase phase)
+{
+    if (s_pending && !s_pending->phaseUs[phase])
+        s_pending->phaseUs[phase] = g_get_monotonic_time();
+}
+
+void LaunchTimeline::setType(const char* type)
+{
+    if (s_pending)
+        s_pending->type = type;
+}
+
+void LaunchTimeline::bind(const QString& instanceId)
+{
+    if (!s_pending)
+        return;
+
+    s_pending->instanceId = instanceId;
+    s_inFlight.push_back(*s_pending);
+    delete s_pending;
+    s_pending = 0;
+}
+
+void LaunchTimeline::endRequest(bool succeeded)
+{
+    // Launches without asynchronous phases (relaunch, container based)
+    // end with the request
+    if (!s_pending)
+        return;
+
+    record(*s_pending, succeeded ? "complete" : "failed");
+    delete s_pending;
+    s_pending = 0;
+}
+
+void LaunchTimeline::mark(const QString& instanceId, Phase phase)
+{
+    for (std::list<Launch>::iterator it = s_inFlight.begin(); it != s_inFlight.end(); ++it) {
+        if (it->instanceId != instanceId)
+            continue;
+
+        if (!it->phaseUs[phase])
+            it->phaseUs[phase] = g_get_monotonic_time();
+
+        if (it->phaseUs[PhaseLoadFinished] && it->phaseUs[PhaseVisuallyCommitted]) {
+            record(*it, "complete");
+            s_inFlight.erase(it);
+        }
+        return;
+    }
+}
+
+static void endInFlight(const QString& instanceId, const char* result)
+{
+    for (std::list<Launch>::iterator it = s_inFlight.begin(); it != s_inFlight.end(); ++it) {
+        if (it->instanceId == instanceId) {
+            record(*it, result);
+            s_inFlight.erase(it);
+            return;
+        }
+    }
+}
+
+void LaunchTimeline::cancel(const QString& instanceId)
+{
+    endInFlight(instanceId, "closed");
+}
+
+void LaunchTimeline::fail(const QString& instanceId)
+{
+    endInFlight(instanceId, "failed");
+}
+
+static QJsonObject launchToJson(const Launch& launch)
+{
+    QJsonObject phases;
+    for (int i = 0; i < LaunchTimeline::PhaseCount; i++) {
+        if (launch.phaseUs[i])
+            phases[kPhaseNames[i]] = offsetMs(launch, i);
+    }
+
+    QJsonObject result;
+    result["id"] = launch.id;
+    if (launch.batch)
+        result["batch"] = launch.batch;
+    result["appId"] = QString::fromStdString(launch.appId);
+    result["instanceId"] = launch.instanceId;
+    result["type"] = launch.type;
+    result["result"] = launch.result ? launch.result : "inProgress";
+    result["phases"] = phases;
+    return result;
+}
+
+static QJsonObject percentiles(std::deque<double> samples)
+{
+    std::sort(samples.begin(), samples.end());
+    size_t last = samples.size() - 1;
+
+    QJsonObject result;
+    result["p50"] = samples[last * 50 / 100];
+    result["p90"] = samples[last * 90 / 100];
+    result["p99"] = samples[last * 99 / 100];
+    result["max"] = samples[last];
+    return result;
+}
+
+QJsonObject LaunchTimeline::toJson(int count, const QString& appId)
+{
+    expireInFlight();
+
+    std::string filter = appId.toStdString();
+
+    QJsonArray launches;
+    for (std::list<Launch>::const_iterator it = s_inFlight.begin(); it != s_inFlight.end() && launches.size() < count; ++it) {
+        if (filter.empty() || it->appId == filter)
+            launches.append(launchToJson(*it));
+    }
+    for (std::deque<Launch>::const_reverse_iterator it = s_recent.rbegin(); it != s_recent.rend() && launches.size() < count; ++it) {
+        if (filter.empty() || it->appId == filter)
+            launches.append(launchToJson(*it));
+    }
+
+    QJsonObject apps;
+    for (std::map<std::string, AppSamples>::const_iterator it = s_appSamples.begin(); it != s_appSamples.end(); ++it) {
+        if (!filter.empty() && it->first != filter)
+            continue;
+
+        QJsonObject phases;
+        for (int i = 0; i < PhaseCount; i++) {
+            if (!it->second.phases[i].empty())
+                phases[kPhaseNames[i]] = percentiles(it->second.phases[i]);
+        }
+
+        QJsonObject app;
+        app["count"] = static_cast<int>(it->second.total.size());
+        app["total"] = percentiles(it->second.total);
+        app["phases"] = phases;
+        apps[QString::fromStdString(it->first)] = app;
+    }
+
+    QJsonObject result;
+    result["launches"] = launches;
+    result["summary"] = apps;
+    return result;
+}
@@ -0,0 +1,71 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef LAUNCHTIMELINE_H
+#define LAUNCHTIMELINE_H
+
+#include <string>
+
+#include <QJsonObject>
+#include <QString>
+
+// Breaks every launch request received over Luna into phases, from the LS2
+// receive to the first visually committed frame. The synchronous part of
+// a launch marks the pending launch, which is then bound to the instance
+// id of the app so the asynchronous phases (launch stages, frames, load)
+// can find it.
+// The last launches are kept with their phase offsets, and per app
+// percentiles are kept for the completed ones of the most recently
+// launched apps. Main thread only.
+class LaunchTimeline {
+public:
+    enum Phase {
+        PhaseReceived,
+        PhaseDescriptorParsed,
+        PhaseAdmitted,
+        PhaseAppCreated,
+        PhaseReplied,
+        PhasePageCreated,
+        PhasePageInitialized,
+        PhaseWindowAttached,
+        PhaseLoadUrl,
+        PhaseFirstFrameSwapped,
+        PhaseLoadFinished,
+        PhaseVisuallyCommitted,
+        PhaseCount
+    };
+
+    // Synchronous part of a launch request
+    static void begin(const std::string& appId);
+    static void mark(Phase phase);
+    static void setType(const char* type);
+    static void bind(const QString& instanceId);
+    static void endRequest(bool succeeded);
+
+    // The launches begun in between came in one launchApps request. They
+    // share its receive time and are listed with the id of the batch.
+    static void beginBatch();
+    static void endBatch();
+
+    // Asynchronous part, only the first mark of a phase counts
+    static void mark(const QString& instanceId, Phase phase);
+    static void cancel(const QString& instanceId);
+    static void fail(const QString& instanceId);
+
+    static QJsonObject toJson(int count, const QString& appId);
+};
+
+#endif // LAUNCHTIMELINE_H
@@ -0,0 +1,88 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "StagedLaunch.h"
+
+#include "ApplicationDescription.h"
+#include "WebAppBase.h"
+#include "WebPageBase.h"
+
+StagedLaunch::StagedLaunch(const std::string& inUrl, const QString& inWinType, const ApplicationDescription* inAppDesc,
+    const std::string& inInstanceId, const std::string& inArgs, const std::string& inLaunchingAppId)
+    : stage(StageCreateApp)
+    , url(inUrl)
+    , winType(inWinType)
+    , appDesc(inAppDesc)
+    , instanceId(inInstanceId)
+    , args(inArgs)
+    , launchingAppId(inLaunchingAppId)
+    , app(0)
+    , page(0)
+    , m_client(0)
+    , m_finished(false)
+    , m_errCode(0)
+{
+}
+
+StagedLaunch::~StagedLaunch()
+{
+    // A done launch has handed its app over to WebAppManager
+    if (stage == StageDone) {
+        if (!app)
+            delete appDesc;
+        return;
+    }
+
+    // Dropped half way, the app is not listed anywhere yet. It takes appDesc
+    // and the page over when the page is attached.
+    if (stage < StageLoadUrl) {
+        delete page;
+        delete appDesc;
+    }
+    delete app;
+}
+
+void StagedLaunch::setClient(Client* client)
+{
+    m_client = client;
+    if (m_finished)
+        notifyClient();
+}
+
+void StagedLaunch::succeeded()
+{
+    m_finished = true;
+    notifyClient();
+}
+
+void StagedLaunch::failed(int errCode, const std::string& errMsg)
+{
+    m_finished = true;
+    m_errCode = errCode;
+    m_errMsg = errMsg;
+    stage = StageDone;
+    notifyClient();
+}
+
+void StagedLaunch::notifyClient()
+{
+    if (!m_client)
+        return;
+
+    Client* client = m_client;
+    m_client = 0;
+    client->launchFinished(m_errCode ? std::string() : instanceId, m_errCode, m_errMsg);
+}
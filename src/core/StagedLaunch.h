@@ -0,0 +1,82 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef STAGEDLAUNCH_H
+#define STAGEDLAUNCH_H
+
+#include <string>
+
+#include <QString>
+
+class ApplicationDescription;
+class WebAppBase;
+class WebPageBase;
+
+// A cold launch of a normal app, split into stages that WebAppManager runs
+// one per main loop iteration so bus calls and input get in between. The
+// client is told the outcome as soon as the app has been created; the page
+// is created, attached and loaded in the following stages.
+class StagedLaunch {
+public:
+    enum Stage {
+        StageCreateApp,
+        StageCreatePage,
+        StageAttachWindow,
+        StageLoadUrl,
+        StageDone
+    };
+
+    class Client {
+    public:
+        virtual ~Client() {}
+
+        // Called once, instanceId is empty if the launch failed
+        virtual void launchFinished(const std::string& instanceId, int errCode, const std::string& errMsg) = 0;
+    };
+
+    StagedLaunch(const std::string& inUrl, const QString& inWinType, const ApplicationDescription* inAppDesc,
+        const std::string& inInstanceId, const std::string& inArgs, const std::string& inLaunchingAppId);
+    ~StagedLaunch();
+
+    // The client may be set after the first stages ran, it is then told right away
+    void setClient(Client* client);
+    void succeeded();
+    void failed(int errCode, const std::string& errMsg);
+
+    bool isFinished() const { return m_finished; }
+    int errCode() const { return m_errCode; }
+    const std::string& errMsg() const { return m_errMsg; }
+
+    Stage stage;
+    std::string url;
+    QString winType;
+    const ApplicationDescription* appDesc; // owned until the app is attached
+    std::string instanceId;
+    std::string args;
+    std::string launchingAppId;
+    WebAppBase* app;
+    WebPageBase* page;
+
+private:
+    void notifyClient();
+
+    Client* m_client;
+    bool m_finished;
+    int m_errCode;
+    std::string m_errMsg;
+};
+
+#endif // STAGEDLAUNCH_H
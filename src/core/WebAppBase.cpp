@@ -19,8 +19,11 @@
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonObject>
 
+#include "AppCloseStatistics.h"
 #include "ApplicationDescription.h"
 #include "LogManager.h"
+#include "MainLoopWatchdog.h"
+#include "Timer.h"
 #include "WebAppManagerConfig.h"
 #include "WebAppManager.h"
 #include "WebPageBase.h"
@@ -63,6 +66,8 @@ public:
     QString m_instanceId;
     QString m_url;
     ApplicationDescription* m_appDesc;
+    OneShotTimer<WebAppBase> m_closeTeardownTimer;
+    ElapsedTimer m_timeToCloseTimer;
 };
 
 WebAppBase::WebAppBase()
@@ -79,7 +84,7 @@ WebAppBase::WebAppBase()
 
 WebAppBase::~WebAppBase()
 {
-    LOG_INFO(MSGID_WEBAPP_CLOSED, 2, PMLOGKS("APP_ID", appId().isEmpty() ? "unknown" : qPrintable(appId())), PMLOGKFV("PID", "%d", page()->getWebProcessPID()), "");
+    LOG_INFO(MSGID_WEBAPP_CLOSED, 2, PMLOGKS("APP_ID", appId().isEmpty() ? "unknown" : qPrintable(appId())), PMLOGKFV("PID", "%d", page() ? page()->getWebProcessPID() : 0), "");
     cleanResources();
     delete d;
 }
@@ -259,8 +264,7 @@ void WebAppBase::relaunch(const QString& args, const QString& launchingAppId)
 
         clearPreloadState();
 
-        if (WebAppManager::instance()->config()->isCheckLaunchTimeEnabled())
-            startLaunchTimer();
+        startLaunchTimer();
 
         if (keepAlive() && (page()->progress() != 100))
             m_addedToWindowMgr = false;
@@ -308,6 +312,7 @@ void WebAppBase::relaunch(const QString& args, const QString& launchingAppId)
 
 void WebAppBase::webPageLoadFinishedSlot()
 {
+    WatchdogScope watchdogScope("WebAppBase::webPageLoadFinishedSlot");
     doPendingRelaunch();
 }
 
@@ -327,6 +332,7 @@ void WebAppBase::doPendingRelaunch()
 
 void WebAppBase::webPageClosePageRequestedSlot()
 {
+    WatchdogScope watchdogScope("WebAppBase::webPageClosePageRequestedSlot");
     LOG_INFO(MSGID_WINDOW_CLOSED_JS, 2, PMLOGKS("APP_ID", qPrintable(appId())), PMLOGKFV("PID", "%d", page()->getWebProcessPID()), "");
     WebAppManager::instance()->closeApp(appId().toStdString());
 }
@@ -355,6 +361,7 @@ void WebAppBase::showWindow()
 
 void WebAppBase::showWindowSlot()
 {
+    WatchdogScope watchdogScope("WebAppBase::showWindowSlot");
     showWindow();
 }
 
@@ -466,6 +473,7 @@ void WebAppBase::setUiSize(int width, int height) {
 
 void WebAppBase::webPageUrlChangedSlot()
 {
+    WatchdogScope watchdogScope("WebAppBase::webPageUrlChangedSlot");
     d->m_url = d->m_page->url().toString();
 }
 
@@ -503,6 +511,26 @@ void WebAppBase::setUseAccessibility(bool enabled)
     page()->setUseAccessibility(useAccessibility);
 }
 
+void WebAppBase::scheduleCloseTeardown()
+{
+    // The window is already hidden at this point, so running the close
+    // callback or unload from the main loop keeps the caller (e.g. a luna
+    // closeApp handler) from waiting on the web process
+    d->m_timeToCloseTimer.start();
+    d->m_closeTeardownTimer.start(0, this, &WebAppBase::runCloseTeardown);
+}
+
+void WebAppBase::runCloseTeardown()
+{
+    if (page()->isRegisteredCloseCallback()) {
+        LOG_INFO(MSGID_CLOSE_APP_INTERNAL, 2, PMLOGKS("APP_ID", qPrintable(appId())), PMLOGKFV("PID", "%d", page()->getWebProcessPID()), "CloseCallback; execute");
+        executeCloseCallback();
+    } else {
+        LOG_INFO(MSGID_CLOSE_APP_INTERNAL, 2, PMLOGKS("APP_ID", qPrintable(appId())), PMLOGKFV("PID", "%d", page()->getWebProcessPID()), "NO CloseCallback; load about:blank");
+        dispatchUnload();
+    }
+}
+
 void WebAppBase::executeCloseCallback()
 {
     connect(d->m_page, SIGNAL(closeCallbackExecuted()),this, SLOT(closeWebAppSlot()));
@@ -514,8 +542,13 @@ void WebAppBase::executeCloseCallback()
 
 void WebAppBase::closeWebAppSlot()
 {
+    WatchdogScope watchdogScope("WebAppBase::closeWebAppSlot");
     LOG_INFO(MSGID_CLEANRESOURCE_COMPLETED, 2, PMLOGKS("APP_ID", qPrintable(appId())), PMLOGKFV("PID", "%d", page()->getWebProcessPID()), "closeCallback/about:blank is DONE");
     WebAppManager::instance()->removeClosingAppList(appId());
+    if (d->m_timeToCloseTimer.isRunning()) {
+        WebAppManager::instance()->closeStatistics()->addTimeToClose(appId(), d->m_timeToCloseTimer.elapsed_ms());
+        d->m_timeToCloseTimer.stop();
+    }
 #ifdef PRELOADMANAGER_ENABLED
     if (appId() == WebAppManager::instance()->getContainerAppId())
         WebAppManager::instance()->closeContainerApp();
@@ -533,7 +566,7 @@ void WebAppBase::dispatchUnload()
 
 void WebAppBase::onCursorVisibilityChanged(const QString& jsscript)
 {
-    WebAppManager::instance()->sendEventToAllAppsAndAllFrames(jsscript);
+    WebAppManager::instance()->sendEventToAllAppsAndAllFrames(QStringLiteral("cursorStateChange"), jsscript);
 }
 
 void WebAppBase::serviceCall(const QString& url, const QString& payload, const QString& appId)
@@ -55,6 +55,7 @@ public:
     virtual bool isNormal() = 0;
     virtual void onStageActivated() = 0;
     virtual void onStageDeactivated() = 0;
+    // On every launch, the launch time check itself is up to the config
     virtual void startLaunchTimer() {}
     virtual void setHiddenWindow(bool hidden);
     virtual void configureWindow(QString& type) = 0;
@@ -80,6 +81,7 @@ public:
     virtual void deleteSurfaceGroup() = 0;
     virtual void keyboardVisibilityChanged(bool visible, int height);
     virtual void doClose() = 0;
+    virtual QJsonObject frameTiming() const { return QJsonObject(); }
 
     static void onCursorVisibilityChanged(const QString& jsscript);
 
@@ -112,6 +114,7 @@ public:
     static int currentUiHeight();
 
     void cleanResources();
+    void scheduleCloseTeardown();
     void executeCloseCallback();
     void dispatchUnload();
 
@@ -150,6 +153,8 @@ protected:
     float m_scaleFactor;
 
 private:
+    void runCloseTeardown();
+
     WebAppBasePrivate* d;
     bool m_needReload;
     bool m_crashed;
@@ -96,6 +96,11 @@ WebAppFactoryInterface* WebAppFactoryManager::loadPluggable(QString appType)
     return 0;
 }
 
+void WebAppFactoryManager::registerPluggable(const QString& appType, WebAppFactoryInterface* interface)
+{
+    m_interfaces.insert(appType, interface);
+}
+
 WebAppBase* WebAppFactoryManager::createWebApp(QString winType, ApplicationDescription* desc, QString appType)
 {
     WebAppFactoryInterface* interface = getPluggable(appType);
@@ -127,7 +132,7 @@ WebPageBase* WebAppFactoryManager::createWebPage(QString winType, QUrl url, Appl
             page = m_interfaces.value("default")->createWebPage(url, desc, launchParams);
     }
 
-    if (page) page->init();
+    // The caller initializes the page, so its launch can time the two apart
     return page;
 }
 
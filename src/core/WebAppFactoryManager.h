@@ -27,9 +27,12 @@ public:
     static WebAppFactoryManager* instance();
     WebAppBase* createWebApp(QString winType, ApplicationDescription* desc = 0, QString appType = "");
     WebAppBase* createWebApp(QString winType, WebPageBase* page, ApplicationDescription* desc = 0, QString appType = "");
+    // The returned page is not initialized yet, see WebPageBase::init()
     WebPageBase* createWebPage(QString winType, QUrl url, ApplicationDescription* desc, QString appType = "", QString launchParams = "");
     WebAppFactoryInterface* getPluggable(QString appType);
     WebAppFactoryInterface* loadPluggable(QString appType = "");
+    // For factories linked into the binary instead of loaded as a plugin
+    void registerPluggable(const QString& appType, WebAppFactoryInterface* interface);
 
 private:
     static WebAppFactoryManager* m_instance;
@@ -16,19 +16,37 @@
 
 #include "WebAppManager.h"
 
+#include <algorithm>
 #include <string>
 #include <sstream>
+#include <string.h>
 #include <unistd.h>
 
+#include <glib.h>
+
+#include <QtCore/QJsonArray>
 #include <QtCore/QJsonDocument>
+#include <QtCore/QJsonParseError>
 
+#include "AppCloseStatistics.h"
 #include "ApplicationDescription.h"
+#include "BinaryLogger.h"
+#include "BroadcastService.h"
 #include "ContainerAppManager.h"
 #include "DeviceInfo.h"
+#include "FlightRecorder.h"
+#include "HibernatedAppManager.h"
+#include "JsonWorkerPool.h"
+#include "LaunchTimeline.h"
 #include "LogManager.h"
+#include "LunaTrace.h"
+#include "MainLoopWatchdog.h"
+#include "Metrics.h"
 #include "NetworkStatusManager.h"
 #include "PlatformModuleFactory.h"
+#include "RunningAppsPage.h"
 #include "ServiceSender.h"
+#include "StagedLaunch.h"
 #include "WebAppBase.h"
 #include "WebAppFactoryManager.h"
 #include "WebAppManagerConfig.h"
@@ -42,6 +60,13 @@
 
 static const int kContinuousReloadingLimit = 3;
 
+// Failures are counted wherever a launch gives up, all on one counter
+static Counter* launchFailureCounter()
+{
+    static Counter* s_failures = Metrics::counter("wam_app_launch_failures_total", "App launch requests that failed");
+    return s_failures;
+}
+
 WebAppManager* WebAppManager::instance()
 {
     // not a leak -- static variable initializations are only ever done once
@@ -57,13 +82,23 @@ WebAppManager::WebAppManager()
     , m_deviceInfo(0)
     , m_webAppManagerConfig(0)
     , m_networkStatusManager(new NetworkStatusManager())
+    , m_closeStatistics(new AppCloseStatistics())
+    , m_hibernatedAppManager(new HibernatedAppManager())
+    , m_broadcastService(new BroadcastService())
     , m_suspendDelay(0)
+    , m_launchStageSource(0)
+    , m_runningLaunchStage(false)
+    , m_batchDepth(0)
+    , m_runningAppListPending(false)
+    , m_runningAppsPageSource(0)
     , m_isAccessibilityEnabled(false)
 {
 }
 
 WebAppManager::~WebAppManager()
 {
+    dropStagedLaunches();
+
     if (m_containerAppManager)
         delete m_containerAppManager;
     if (m_serviceSender)
@@ -74,10 +109,29 @@ WebAppManager::~WebAppManager()
         delete m_deviceInfo;
     if (m_networkStatusManager)
         delete m_networkStatusManager;
+    if (m_closeStatistics)
+        delete m_closeStatistics;
+    if (m_hibernatedAppManager)
+        delete m_hibernatedAppManager;
+    if (m_broadcastService)
+        delete m_broadcastService;
+
+    if (m_runningAppsPageSource)
+        g_source_remove(m_runningAppsPageSource);
+    RunningAppsPage::stop();
+    JsonWorkerPool::stop();
+    MainLoopWatchdog::stop();
+    BinaryLogger::stop();
 }
 
 void WebAppManager::notifyMemoryPressure(webos::WebViewBase::MemoryPressureLevel level)
 {
+    FlightRecorder::record(FlightRecorder::MemoryPressure, std::string(), level);
+
+    // Hibernated apps are given up before any running app is asked to free memory
+    if (level != webos::WebViewBase::MEMORY_PRESSURE_NONE)
+        m_hibernatedAppManager->evictAll(HibernatedAppManager::EvictMemoryPressure);
+
     std::list<const WebAppBase*> appList = runningApps();
     for (auto it = appList.begin(); it != appList.end(); ++it) {
         const WebAppBase* app = *it;
@@ -112,6 +166,27 @@ void WebAppManager::loadEnvironmentVariable()
 {
     m_suspendDelay = m_webAppManagerConfig->getSuspendDelayTime();
     m_webAppManagerConfig->postInitConfiguration();
+    m_closeStatistics->setMaxCloseCallbackTimeout(m_webAppManagerConfig->getCloseCallbackTimeout());
+    m_hibernatedAppManager->setLimits(m_webAppManagerConfig->getHibernationMaxApps(),
+                                      m_webAppManagerConfig->getHibernationTimeout(),
+                                      m_webAppManagerConfig->getHibernationMemoryBudget());
+    BinaryLogger::setDumpPath(m_webAppManagerConfig->getBinaryLogDumpFile());
+    BinaryLogger::start(m_webAppManagerConfig->getBinaryLogOutput());
+    TraceEventRecorder::setDumpPath(m_webAppManagerConfig->getTraceEventsFile());
+    if (m_webAppManagerConfig->isTraceEventsEnabled())
+        TraceEventRecorder::setEnabled(true);
+    Metrics::setTextFile(m_webAppManagerConfig->getMetricsFile(), m_webAppManagerConfig->getMetricsInterval());
+    MainLoopWatchdog::start(m_webAppManagerConfig->getWatchdogThreshold(),
+                            m_webAppManagerConfig->isWatchdogBacktraceEnabled());
+    FlightRecorder::setDumpPath(m_webAppManagerConfig->getFlightRecorderFile());
+    FlightRecorder::installCrashHandler();
+    LunaTrace::start(m_webAppManagerConfig->getLunaTraceFile());
+    JsonWorkerPool::start(m_webAppManagerConfig->getJsonWorkerThreads(), m_webAppManagerConfig->getJsonOffloadThreshold());
+
+    // The page follows the running apps from the start, its memory figures
+    // are polled only once a reader asked for the page
+    if (m_webAppManagerConfig->getRunningAppsPageInterval() > 0)
+        RunningAppsPage::start();
 
     if (m_containerAppManager)
         m_containerAppManager->setUseContainerAppOptimization(m_webAppManagerConfig->isUseSystemAppOptimization());
@@ -165,6 +240,7 @@ void WebAppManager::onLaunchContainerBasedApp(const std::string& url, QString& w
     WebPageBase *page = app->page();
 
     LOG_DEBUG("[%s] WebAppManager::onLaunchContainerBasedApp(); ", qPrintable(QString::fromStdString(appDesc->id())));
+    FlightRecorder::record(FlightRecorder::ContainerBasedLaunch, appDesc->id(), page->getWebProcessPID());
 
     app->setHiddenWindow(false);
     page->resetStateToMarkNextPaintForContainer();
@@ -189,8 +265,7 @@ void WebAppManager::onLaunchContainerBasedApp(const std::string& url, QString& w
     app->setPreloadState(QString::fromStdString(args));
 
     app->setLaunchingAppId(QString::fromStdString(launchingAppId));
-    if (m_webAppManagerConfig->isCheckLaunchTimeEnabled())
-        app->startLaunchTimer();
+    app->startLaunchTimer();
 
     webPageRemoved(page);
 
@@ -263,6 +338,7 @@ void WebAppManager::onRelaunchApp(const std::string& instanceId, const std::stri
         LOG_WARNING(MSGID_APP_RELAUNCH, 0, "Failed to relaunch due to no running app");
         return;
     }
+    FlightRecorder::record(FlightRecorder::Relaunch, appId, app->page()->getWebProcessPID());
 
     // Do not relaunch when preload args is setted
     // luna-send -n 1 luna://com.webos.applicationManager/launch '{"id":<AppId> "preload":<PreloadState> }'
@@ -278,6 +354,55 @@ void WebAppManager::onRelaunchApp(const std::string& instanceId, const std::stri
     }
 }
 
+WebAppBase* WebAppManager::onReviveHibernatedApp(QString winType, const ApplicationDescription* appDesc,
+                                                 const std::string& instanceId, const std::string& args,
+                                                 const std::string& launchingAppId)
+{
+    QString appId = QString::fromStdString(appDesc->id());
+    WebAppBase* app = m_hibernatedAppManager->find(appId);
+
+    // An updated app or a page lost in the meantime needs a cold launch
+    if (app && (app->getAppDescription()->version() != appDesc->version()
+                || app->getCrashState() || app->page()->isClosing())) {
+        m_hibernatedAppManager->evict(appId, HibernatedAppManager::EvictStale);
+        app = 0;
+    }
+
+    if (!app) {
+        m_hibernatedAppManager->noteColdLaunch(appId);
+        return 0;
+    }
+
+    m_hibernatedAppManager->revive(appId);
+    WebPageBase* page = app->page();
+    LaunchTimeline::setType("revived");
+
+    // From the app's point of view this is a new launch: new instance,
+    // new launch parameters and a fresh load of the entry point
+    app->setAppDescription((ApplicationDescription *)appDesc);
+    page->setApplicationDescription((ApplicationDescription *)appDesc);
+    app->setAppProperties(QString::fromStdString(args));
+    app->setInstanceId(QString::fromStdString(instanceId));
+    app->setLaunchingAppId(QString::fromStdString(launchingAppId));
+    app->setPreloadState(QString::fromStdString(args));
+    app->setHiddenWindow(false);
+    app->configureWindow(winType);
+    app->startLaunchTimer();
+
+    page->setLaunchParams(QString::fromStdString(args));
+    page->resumeWebPageAll();
+    page->setVisibilityState(WebPageBase::WebPageVisibilityState::WebPageVisibilityStateLaunching);
+    page->reloadForLaunch();
+    LaunchTimeline::mark(LaunchTimeline::PhaseLoadUrl);
+
+    webPageAdded(page);
+    m_appList.push_back(app);
+
+    LOG_INFO(MSGID_START_LAUNCHURL, 2, PMLOGKS("APP_ID", qPrintable(app->appId())), PMLOGKFV("PID", "%d", page->getWebProcessPID()), "Revived from hibernation");
+    FlightRecorder::record(FlightRecorder::Revive, appId, page->getWebProcessPID());
+    return app;
+}
+
 std::string WebAppManager::onLaunchContainerApp(const std::string& appDesc)
 {
     int errorCode = 0;
@@ -285,6 +410,7 @@ std::string WebAppManager::onLaunchContainerApp(const std::string& appDesc)
 
     WebAppBase* containerApp = m_containerAppManager->launchContainerApp(appDesc, instanceId, errorCode);
     if (containerApp) {
+        FlightRecorder::record(FlightRecorder::ContainerLaunch, containerApp->appId(), containerApp->page()->getWebProcessPID());
         webPageAdded(containerApp->page());
         return instanceId;
     }
@@ -323,6 +449,8 @@ void WebAppManager::discardCodeCache(uint32_t pid)
 
 bool WebAppManager::onKillApp(const std::string& appId)
 {
+    finishStagedLaunches(appId);
+
     QString __appId = QString::fromStdString(appId);
     WebAppBase* app = findAppById(__appId);
     if (!app) {
@@ -336,6 +464,8 @@ bool WebAppManager::onKillApp(const std::string& appId)
 
 std::list<const WebAppBase*> WebAppManager::runningApps()
 {
+    finishStagedLaunches();
+
     std::list<const WebAppBase*> apps;
 
     for (AppList::const_iterator it = m_appList.begin(); it != m_appList.end(); ++it) {
@@ -347,6 +477,8 @@ std::list<const WebAppBase*> WebAppManager::runningApps()
 
 std::list<const WebAppBase*> WebAppManager::runningApps(uint32_t pid)
 {
+    finishStagedLaunches();
+
     std::list<const WebAppBase*> apps;
 
     for (AppList::const_iterator it = m_appList.begin(); it != m_appList.end(); ++it) {
@@ -364,69 +496,228 @@ WebAppBase* WebAppManager::onLaunchUrl(const std::string& url, QString winType,
                                        const std::string& args, const std::string& launchingAppId,
                                        int& errCode, std::string& errMsg)
 {
-    WebAppBase* app = WebAppFactoryManager::instance()->createWebApp(winType, (ApplicationDescription *)appDesc, appDesc->subType().c_str());
+    TRACE_EVENT_SCOPE("WebAppManager::onLaunchUrl", "appId", appDesc->id().c_str());
 
-    if (!app) {
-        errCode = ERR_CODE_LAUNCHAPP_UNSUPPORTED_TYPE;
-        errMsg = err_unsupportedType;
-        return 0;
+    StagedLaunch launch(url, winType, appDesc, instanceId, args, launchingAppId);
+    while (runLaunchStage(&launch)) {
     }
 
-    WebPageBase* page = WebAppFactoryManager::instance()->createWebPage(winType, QUrl(url.c_str()), (ApplicationDescription *)appDesc, appDesc->subType().c_str(), args.c_str());
+    if (!launch.app) {
+        errCode = launch.errCode();
+        errMsg = launch.errMsg();
+    }
+    return launch.app;
+}
 
-    //set use launching time optimization true while app loading.
-    page->setUseLaunchOptimization(true);
+// Runs the next stage of the launch, returns false once there is none left
+bool WebAppManager::runLaunchStage(StagedLaunch* launch)
+{
+    const ApplicationDescription* appDesc = launch->appDesc;
+    QString instanceId = QString::fromStdString(launch->instanceId);
+    TRACE_EVENT_SCOPE("WebAppManager::runLaunchStage", "appId", appDesc->id().c_str());
+
+    switch (launch->stage) {
+    case StagedLaunch::StageCreateApp:
+        launch->app = WebAppFactoryManager::instance()->createWebApp(launch->winType, (ApplicationDescription *)appDesc, appDesc->subType().c_str());
+        if (!launch->app) {
+            launchFailureCounter()->increment();
+            LaunchTimeline::fail(instanceId);
+            launch->failed(ERR_CODE_LAUNCHAPP_UNSUPPORTED_TYPE, err_unsupportedType);
+            return false;
+        }
+        LaunchTimeline::mark(instanceId, LaunchTimeline::PhaseAppCreated);
+        launch->stage = StagedLaunch::StageCreatePage;
+
+        // Nothing after this can fail, so the launch can be answered now
+        launch->succeeded();
+        return true;
+
+    case StagedLaunch::StageCreatePage:
+        launch->page = WebAppFactoryManager::instance()->createWebPage(launch->winType, QUrl(launch->url.c_str()), (ApplicationDescription *)appDesc, appDesc->subType().c_str(), launch->args.c_str());
+        LaunchTimeline::mark(instanceId, LaunchTimeline::PhasePageCreated);
+        launch->page->init();
+        LaunchTimeline::mark(instanceId, LaunchTimeline::PhasePageInitialized);
+
+        //set use launching time optimization true while app loading.
+        launch->page->setUseLaunchOptimization(true);
+
+        // Set system app optimization - currently turning off inline caching
+        // this include the case that container based app is launched
+        // not by using container app.
+        if (m_webAppManagerConfig->isUseSystemAppOptimization() && isContainerUsedApp(appDesc)) {
+          launch->page->setUseSystemAppOptimization(true);
+        }
+
+        if (launch->winType == WT_FLOATING)
+          launch->page->setEnableBackgroundRun(appDesc->isEnableBackgroundRun());
 
-    // Set system app optimization - currently turning off inline caching
-    // this include the case that container based app is launched
-    // not by using container app.
-    if (m_webAppManagerConfig->isUseSystemAppOptimization() && isContainerUsedApp(appDesc)) {
-      page->setUseSystemAppOptimization(true);
+        launch->stage = StagedLaunch::StageAttachWindow;
+        return true;
+
+    case StagedLaunch::StageAttachWindow:
+        launch->app->setAppDescription((ApplicationDescription *)appDesc);
+        launch->app->setAppProperties(QString::fromStdString(launch->args));
+        launch->app->setInstanceId(instanceId);
+        launch->app->setLaunchingAppId(QString::fromStdString(launch->launchingAppId));
+        launch->app->startLaunchTimer();
+        launch->app->attach(launch->page);
+        launch->app->setPreloadState(QString::fromStdString(launch->args));
+        LaunchTimeline::mark(instanceId, LaunchTimeline::PhaseWindowAttached);
+
+        launch->stage = StagedLaunch::StageLoadUrl;
+        return true;
+
+    case StagedLaunch::StageLoadUrl: {
+        WebAppBase* app = launch->app;
+        WebPageBase* page = launch->page;
+
+        page->load();
+        LaunchTimeline::mark(instanceId, LaunchTimeline::PhaseLoadUrl);
+        webPageAdded(page);
+
+        m_appList.push_back(app);
+
+        if (m_appVersion.find(appDesc->id()) != m_appVersion.end()) {
+          if (m_appVersion[appDesc->id()] != appDesc->version()) {
+            app->setNeedReload(true);
+            m_appVersion[appDesc->id()] = appDesc->version();
+          }
+        }
+        else {
+          m_appVersion[appDesc->id()] = appDesc->version();
+        }
+
+        LOG_INFO(MSGID_START_LAUNCHURL, 2, PMLOGKS("APP_ID", qPrintable(app->appId())), PMLOGKFV("PID", "%d", app->page()->getWebProcessPID()), "");
+        FlightRecorder::record(app->preloadState() != WebAppBase::NONE_PRELOAD ? FlightRecorder::Preload : FlightRecorder::Launch,
+                               app->appId(), app->page()->getWebProcessPID());
+
+#ifndef PRELOADMANAGER_ENABLED
+        if (m_containerAppManager && m_containerAppManager->getLaunchContainerAppOnDemand() && getContainerAppProxyID() == m_webProcessManager->getWebProcessProxyID(appDesc)) {
+            m_containerAppManager->setLaunchContainerAppOnDemand(false);
+            m_containerAppManager->startContainerTimer();
+        }
+#endif
+
+        launch->stage = StagedLaunch::StageDone;
+        return false;
     }
 
-    if (winType == WT_FLOATING)
-      page->setEnableBackgroundRun(appDesc->isEnableBackgroundRun());
+    case StagedLaunch::StageDone:
+        break;
+    }
 
-    app->setAppDescription((ApplicationDescription *)appDesc);
-    app->setAppProperties(QString::fromStdString(args));
-    app->setInstanceId(QString::fromStdString(instanceId));
-    app->setLaunchingAppId(QString::fromStdString(launchingAppId));
-    if (m_webAppManagerConfig->isCheckLaunchTimeEnabled())
-      app->startLaunchTimer();
-    app->attach(page);
-    app->setPreloadState(QString::fromStdString(args));
+    return false;
+}
 
-    page->load();
-    webPageAdded(page);
+int WebAppManager::launchStageCallback(void* data)
+{
+    WebAppManager* manager = static_cast<WebAppManager*>(data);
+    WatchdogScope watchdogScope("WebAppManager::launchStageCallback");
 
-    m_appList.push_back(app);
+    // One stage per dispatch, the oldest launch first
+    StagedLaunch* launch = manager->m_stagedLaunches.front();
+    manager->m_runningLaunchStage = true;
+    bool more = manager->runLaunchStage(launch);
+    manager->m_runningLaunchStage = false;
+    if (!more) {
+        manager->m_stagedLaunches.pop_front();
+        delete launch;
+    }
+
+    if (!manager->m_stagedLaunches.empty())
+        return G_SOURCE_CONTINUE;
+
+    manager->m_launchStageSource = 0;
+    return G_SOURCE_REMOVE;
+}
+
+// Runs the remaining stages of the launches of appId, or of all of them,
+// so the apps are found running before they are looked up or closed. An
+// app is only listed once its last stage ran, while its launch may have
+// been answered at the first one. Lookups made by a stage itself do not
+// run the launches.
+void WebAppManager::finishStagedLaunches(const std::string& appId)
+{
+    if (m_runningLaunchStage)
+        return;
+
+    m_runningLaunchStage = true;
+    std::list<StagedLaunch*>::iterator it = m_stagedLaunches.begin();
+    while (it != m_stagedLaunches.end()) {
+        StagedLaunch* launch = *it;
+        if (!appId.empty() && launch->appDesc->id() != appId) {
+            ++it;
+            continue;
+        }
 
-    if (m_appVersion.find(appDesc->id()) != m_appVersion.end()) {
-      if (m_appVersion[appDesc->id()] != appDesc->version()) {
-        app->setNeedReload(true);
-        m_appVersion[appDesc->id()] = appDesc->version();
-      }
+        while (runLaunchStage(launch)) {
+        }
+        delete launch;
+        it = m_stagedLaunches.erase(it);
     }
-    else {
-      m_appVersion[appDesc->id()] = appDesc->version();
+    m_runningLaunchStage = false;
+
+    if (m_stagedLaunches.empty() && m_launchStageSource) {
+        g_source_remove(m_launchStageSource);
+        m_launchStageSource = 0;
     }
+}
 
-    LOG_INFO(MSGID_START_LAUNCHURL, 2, PMLOGKS("APP_ID", qPrintable(app->appId())), PMLOGKFV("PID", "%d", app->page()->getWebProcessPID()), "");
+void WebAppManager::runStagedLaunches(const std::vector<StagedLaunch*>& launches)
+{
+    // A launch may have been finished already by a later launch of its app
+    std::vector<StagedLaunch*> running;
+    for (size_t i = 0; i < launches.size(); i++) {
+        StagedLaunch* launch = launches[i];
+        if (std::find(m_stagedLaunches.begin(), m_stagedLaunches.end(), launch) != m_stagedLaunches.end()
+            && std::find(running.begin(), running.end(), launch) == running.end())
+            running.push_back(launch);
+    }
 
-#ifndef PRELOADMANAGER_ENABLED
-    if (m_containerAppManager && m_containerAppManager->getLaunchContainerAppOnDemand() && getContainerAppProxyID() == m_webProcessManager->getWebProcessProxyID(appDesc)) {
-        m_containerAppManager->setLaunchContainerAppOnDemand(false);
-        m_containerAppManager->startContainerTimer();
+    m_runningLaunchStage = true;
+    while (!running.empty()) {
+        std::vector<StagedLaunch*>::iterator it = running.begin();
+        while (it != running.end()) {
+            StagedLaunch* launch = *it;
+            if (runLaunchStage(launch)) {
+                ++it;
+                continue;
+            }
+            m_stagedLaunches.remove(launch);
+            delete launch;
+            it = running.erase(it);
+        }
     }
-#endif
+    m_runningLaunchStage = false;
 
-    return app;
+    if (m_stagedLaunches.empty() && m_launchStageSource) {
+        g_source_remove(m_launchStageSource);
+        m_launchStageSource = 0;
+    }
+}
+
+// Gives up the launches still staged at shutdown. Those not answered yet
+// are failed, so a deferred bus reply is not left hanging.
+void WebAppManager::dropStagedLaunches()
+{
+    for (std::list<StagedLaunch*>::iterator it = m_stagedLaunches.begin(); it != m_stagedLaunches.end(); ++it) {
+        StagedLaunch* launch = *it;
+        if (!launch->isFinished())
+            launch->failed(ERR_CODE_LAUNCHAPP_CANCELED, err_launchCanceled);
+        delete launch;
+    }
+    m_stagedLaunches.clear();
+
+    if (m_launchStageSource) {
+        g_source_remove(m_launchStageSource);
+        m_launchStageSource = 0;
+    }
 }
 
 void WebAppManager::forceCloseAppInternal(WebAppBase* app)
 {
     app->setKeepAlive(false);
-    closeAppInternal(app);
+    closeAppInternal(app, false, false);
 }
 
 void WebAppManager::removeClosingAppList(const QString& appId)
@@ -438,8 +729,11 @@ void WebAppManager::removeClosingAppList(const QString& appId)
    m_closingAppList.remove(appId);
 }
 
-void WebAppManager::closeAppInternal(WebAppBase* app, bool ignoreCleanResource)
+void WebAppManager::closeAppInternal(WebAppBase* app, bool ignoreCleanResource, bool allowHibernation)
 {
+    TRACE_EVENT_SCOPE("WebAppManager::closeAppInternal", "appId", qPrintable(app->appId()));
+    LaunchTimeline::cancel(app->instanceId());
+
     WebPageBase* page = app->page();
     if (page && page->isClosing()) {
         LOG_INFO(MSGID_CLOSE_APP_INTERNAL, 2, PMLOGKS("APP_ID", qPrintable(app->appId())), PMLOGKFV("PID", "%d", app->page()->getWebProcessPID()), "In Closing; return");
@@ -447,22 +741,30 @@ void WebAppManager::closeAppInternal(WebAppBase* app, bool ignoreCleanResource)
     }
 
     LOG_INFO(MSGID_CLOSE_APP_INTERNAL, 2, PMLOGKS("APP_ID", qPrintable(app->appId())), PMLOGKFV("PID", "%d", app->page()->getWebProcessPID()), "");
+    FlightRecorder::record(FlightRecorder::Close, app->appId(), app->page()->getWebProcessPID());
+
+    static Counter* s_closes = Metrics::counter("wam_app_closes_total", "Apps closed");
+    s_closes->increment();
 
-    std::string type = app->getAppDescription()->defaultWindowType();
     appDeleted(app);
     webPageRemoved(app->page());
     removeWebAppFromWebProcessInfoMap(app->appId());
+    m_lastActiveMs.remove(app->appId());
     postRunningAppList();
     m_lastCrashedAppIds = QMap<QString, int>();
 
+    if (allowHibernation && !ignoreCleanResource && hibernateApp(app))
+        return;
+    m_hibernatedAppManager->forgetEvicted(app->appId());
+
     // Set m_isClosing flag first, this flag will be checked in web page suspending
     page->setClosing(true);
     app->deleteSurfaceGroup();
-    // Do suspend WebPage
-    if (type == "overlay")
-        app->hide(true);
-    else
-        app->onStageDeactivated();
+    // Hide the window so it gives up input right away, and suspend the page
+    // so the app stops running JS and media while its close callback or
+    // unload is still pending
+    app->hide(true);
+    app->onStageDeactivated();
 
     if (ignoreCleanResource)
         delete app;
@@ -471,19 +773,51 @@ void WebAppManager::closeAppInternal(WebAppBase* app, bool ignoreCleanResource)
 
         if (app == getContainerApp())
             m_containerAppManager->closeContainerApp();
-        else if (page->isRegisteredCloseCallback()) {
-            LOG_INFO(MSGID_CLOSE_APP_INTERNAL, 2, PMLOGKS("APP_ID", qPrintable(app->appId())), PMLOGKFV("PID", "%d", app->page()->getWebProcessPID()), "CloseCallback; execute");
-            app->executeCloseCallback();
-        }
-        else {
-            LOG_INFO(MSGID_CLOSE_APP_INTERNAL, 2, PMLOGKS("APP_ID", qPrintable(app->appId())), PMLOGKFV("PID", "%d", app->page()->getWebProcessPID()), "NO CloseCallback; load about:blank");
-            app->dispatchUnload();
-        }
+        else
+            app->scheduleCloseTeardown();
     }
 }
 
+bool WebAppManager::hibernateApp(WebAppBase* app)
+{
+    if (!m_hibernatedAppManager->isEnabled())
+        return false;
+
+    // Apps with an onclose callback expect it to run when they are closed
+    WebPageBase* page = app->page();
+    if (app == getContainerApp()
+        || page->isRegisteredCloseCallback()
+        || app->keepAlive()
+        || app->forceClose()
+        || app->getCrashState()
+        || app->preloadState() != WebAppBase::NONE_PRELOAD)
+        return false;
+
+    if (!m_hibernatedAppManager->hibernate(app))
+        return false;
+    FlightRecorder::record(FlightRecorder::Hibernate, app->appId(), page->getWebProcessPID());
+
+    // Parked, not only hidden: no focus, media or JS timers until revived
+    app->deleteSurfaceGroup();
+    app->hide(true);
+    app->onStageDeactivated();
+    return true;
+}
+
+void WebAppManager::closeHibernatedApp(WebAppBase* app)
+{
+    LOG_INFO(MSGID_CLOSE_APP_INTERNAL, 2, PMLOGKS("APP_ID", qPrintable(app->appId())), PMLOGKFV("PID", "%d", app->page()->getWebProcessPID()), "Hibernated app; close");
+
+    // The window is already hidden and out of the running app list
+    app->page()->setClosing(true);
+    m_closingAppList.insert(app->appId(), app);
+    app->scheduleCloseTeardown();
+}
+
 bool WebAppManager::closeAllApps(uint32_t pid)
 {
+    finishStagedLaunches();
+
     AppList runningApps;
 
     for (AppList::iterator it = m_appList.begin(); it != m_appList.end(); ++it) {
@@ -509,6 +843,8 @@ bool WebAppManager::closeAllApps(uint32_t pid)
             m_containerAppManager->closeContainerApp();
     }
 
+    m_hibernatedAppManager->evictAll(HibernatedAppManager::EvictCloseAll, pid);
+
     return runningApps.empty();
 }
 
@@ -549,6 +885,8 @@ void WebAppManager::removeWebAppFromWebProcessInfoMap(QString appId)
 
 WebAppBase* WebAppManager::findAppById(const QString& appId)
 {
+    finishStagedLaunches();
+
     for (AppList::iterator it = m_appList.begin(); it != m_appList.end(); ++it) {
         WebAppBase* app = (*it);
 
@@ -561,6 +899,8 @@ WebAppBase* WebAppManager::findAppById(const QString& appId)
 
 WebAppBase* WebAppManager::findAppByInstanceId(const QString& instanceId)
 {
+    finishStagedLaunches();
+
     for (AppList::iterator it = m_appList.begin(); it != m_appList.end(); ++it) {
         WebAppBase* app = (*it);
 
@@ -592,11 +932,18 @@ void WebAppManager::setSystemLanguage(QString language)
 
     m_deviceInfo->setSystemLanguage(language);
 
+    m_broadcastService->begin(QStringLiteral("systemLanguage"));
     for (AppList::const_iterator it = m_appList.begin(); it != m_appList.end(); ++it)
     {
         WebAppBase* app = (*it);
+        if (m_broadcastService->shouldDefer(app->page())) {
+            app->page()->deferPreferredLanguages(language);
+            continue;
+        }
         app->setPreferredLanguages(language);
+        m_broadcastService->deliver(app->page());
     }
+    m_broadcastService->end();
 
     LOG_DEBUG("New system language: %s", language.toStdString().c_str());
 }
@@ -615,16 +962,24 @@ void WebAppManager::setDeviceInfo(QString name, QString value)
 
 void WebAppManager::broadcastWebAppMessage(WebAppMessageType type, const QString& message)
 {
+    m_broadcastService->begin(QStringLiteral("webAppMessage"));
     for (AppList::const_iterator it = m_appList.begin(); it != m_appList.end(); ++it) {
         WebAppBase* app = (*it);
+        if (type == WebAppMessageType::DeviceInfoChanged && m_broadcastService->shouldDefer(app->page())) {
+            app->page()->deferDeviceInfoChanged(message);
+            continue;
+        }
         app->handleWebAppMessage(type, message);
+        m_broadcastService->deliver(app->page());
     }
 #ifndef PRELOADMANAGER_ENABLED
     if (m_containerAppManager && m_containerAppManager->getContainerApp()) {
         WebAppBase* container = m_containerAppManager->getContainerApp();
         container->handleWebAppMessage(type, message);
+        m_broadcastService->deliver(container->page());
     }
 #endif
+    m_broadcastService->end();
 }
 
 void WebAppManager::requestActivity(WebAppBase* app)
@@ -634,6 +989,11 @@ void WebAppManager::requestActivity(WebAppBase* app)
 }
 
 bool WebAppManager::processCrashed(QString appId) {
+    FlightRecorder::record(FlightRecorder::Crash, appId, m_lastCrashedAppIds.value(appId) + 1);
+    FlightRecorder::dump();
+    if (BinaryLogger::isEnabled())
+        BinaryLogger::dump();
+
     if (m_containerAppManager && (appId == m_containerAppManager->getContainerAppId())) {
         m_containerAppManager->setContainerAppReady(false);
 #ifndef PRELOADMANAGER_ENABLED
@@ -644,6 +1004,12 @@ bool WebAppManager::processCrashed(QString appId) {
         return true;
     }
 
+    // A hibernated page does not need a reload, just close it for good
+    if (m_hibernatedAppManager->find(appId)) {
+        m_hibernatedAppManager->evict(appId, HibernatedAppManager::EvictCrashed);
+        return true;
+    }
+
     WebAppBase* app = findAppById(appId);
     if (!app)
         return false;
@@ -750,11 +1116,41 @@ void WebAppManager::killCustomPluginProcess(const QString &basePath)
  * slightly faster for intra-sysmgr mainloop launches
  */
 std::string WebAppManager::launch(const std::string& appDescString, const std::string& params,
-        const std::string& launchingAppId, int& errCode, std::string& errMsg)
+        const std::string& launchingAppId, int& errCode, std::string& errMsg, StagedLaunch** staged)
 {
-    ApplicationDescription* desc = ApplicationDescription::fromJsonString(appDescString.c_str());
-    if (!desc)
+    if (staged)
+        *staged = 0;
+
+    QJsonParseError parseError;
+    QJsonDocument jsonDoc = QJsonDocument::fromJson(QByteArray(appDescString.c_str()), &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        LOG_WARNING(MSGID_APP_DESC_PARSE_FAIL, 1,
+                    PMLOGKFV("JSON", "%s", appDescString.c_str()), "Failed to parse JSON string");
+        launchFailureCounter()->increment();
         return std::string();
+    }
+
+    return launch(jsonDoc.object(), params, launchingAppId, errCode, errMsg, staged);
+}
+
+std::string WebAppManager::launch(const QJsonObject& appDesc, const std::string& params,
+        const std::string& launchingAppId, int& errCode, std::string& errMsg, StagedLaunch** staged)
+{
+    static Counter* s_containerLaunches = Metrics::counter("wam_app_launches_total", "App launch requests", "type", "container");
+    static Counter* s_relaunches = Metrics::counter("wam_app_launches_total", "App launch requests", "type", "relaunch");
+    static Counter* s_containerBasedLaunches = Metrics::counter("wam_app_launches_total", "App launch requests", "type", "containerBased");
+    static Counter* s_normalLaunches = Metrics::counter("wam_app_launches_total", "App launch requests", "type", "normal");
+
+    if (staged)
+        *staged = 0;
+
+    ApplicationDescription* desc = ApplicationDescription::fromJsonObject(appDesc);
+    LaunchTimeline::mark(LaunchTimeline::PhaseDescriptorParsed);
+
+    TRACE_EVENT_SCOPE("WebAppManager::launch", "appId", desc->id().c_str());
+
+    // An earlier launch of the app still in its stages counts as running
+    finishStagedLaunches(desc->id());
 
     std::string instanceId = "";
     std::string url = desc->entryPoint();
@@ -763,8 +1159,11 @@ std::string WebAppManager::launch(const std::string& appDescString, const std::s
 
     // Check if app is container itself, it shouldn't be relaunched like normal app
     if (isContainerApp(url)) {
+        s_containerLaunches->increment();
+        LaunchTimeline::setType("container");
+        LaunchTimeline::mark(LaunchTimeline::PhaseAdmitted);
         if (!isRunningApp(desc->id(), instanceId))
-            instanceId = onLaunchContainerApp(appDescString);
+            instanceId = onLaunchContainerApp(QJsonDocument(appDesc).toJson(QJsonDocument::Compact).toStdString());
         else {
             LOG_INFO(MSGID_CONTAINER_APP_RELAUNCHED, 2, PMLOGKS("APP_ID", qPrintable(QString::fromStdString(desc->id()))),
                   PMLOGKS("INSTANCE_ID", qPrintable(QString::fromStdString(instanceId))), "ContainerApp; Already Running");
@@ -773,17 +1172,26 @@ std::string WebAppManager::launch(const std::string& appDescString, const std::s
     }
     // Check if app is already running
     else if (isRunningApp(desc->id(), instanceId)) {
+        s_relaunches->increment();
+        LaunchTimeline::setType("relaunch");
+        LaunchTimeline::mark(LaunchTimeline::PhaseAdmitted);
+        m_hibernatedAppManager->forgetEvicted(QString::fromStdString(desc->id()));
         onRelaunchApp(instanceId, desc->id().c_str(), params.c_str(), launchingAppId.c_str());
         delete desc;
     }
     // Check if app is container-based
     else if (isContainerBasedApp(desc)) {
+        s_containerBasedLaunches->increment();
         if (desc->trustLevel() != "default" && desc->trustLevel() != "trusted") {
+            launchFailureCounter()->increment();
             delete desc;
             errCode = ERR_CODE_LAUNCHAPP_INVALID_TRUSTLEVEL;
             errMsg = err_invalidTrustLevel;
             return std::string();
         }
+        LaunchTimeline::setType("containerBased");
+        LaunchTimeline::mark(LaunchTimeline::PhaseAdmitted);
+        m_hibernatedAppManager->forgetEvicted(QString::fromStdString(desc->id()));
         instanceId = m_containerAppManager->getContainerApp()->instanceId().toStdString();
         onLaunchContainerBasedApp(url.c_str(),
             winType,
@@ -792,9 +1200,24 @@ std::string WebAppManager::launch(const std::string& appDescString, const std::s
     }
     // Run as a normal app
     else {
+        s_normalLaunches->increment();
+        LaunchTimeline::setType("normal");
+        LaunchTimeline::mark(LaunchTimeline::PhaseAdmitted);
         instanceId = generateInstanceId();
-        if (!onLaunchUrl(url, winType, desc, instanceId, params, launchingAppId, errCode, errMsg)) {
-            delete desc;
+        bool revived = onReviveHibernatedApp(winType, desc, instanceId, params, launchingAppId);
+
+        // Launch stages, frames and the page load are marked by the instance from here on
+        LaunchTimeline::bind(QString::fromStdString(instanceId));
+
+        if (!revived && staged) {
+            // App, page and window are created in later main loop iterations,
+            // below the priority of input and bus calls
+            *staged = new StagedLaunch(url, winType, desc, instanceId, params, launchingAppId);
+            m_stagedLaunches.push_back(*staged);
+            if (!m_launchStageSource)
+                m_launchStageSource = g_idle_add_full(G_PRIORITY_HIGH_IDLE, launchStageCallback, this, 0);
+        } else if (!revived && !onLaunchUrl(url, winType, desc, instanceId, params, launchingAppId, errCode, errMsg)) {
+            // The failure has been counted and desc deleted with the launch
             return std::string();
         }
     }
@@ -880,6 +1303,35 @@ QJsonObject WebAppManager::getWebProcessProfiling()
     return m_webProcessManager->getWebProcessProfiling();
 }
 
+QJsonObject WebAppManager::getAppCloseStatistics()
+{
+    QJsonObject statistics = m_closeStatistics->toJson();
+    statistics["hibernation"] = m_hibernatedAppManager->statistics();
+    return statistics;
+}
+
+QJsonObject WebAppManager::getBroadcastStatistics()
+{
+    return m_broadcastService->statistics();
+}
+
+QJsonObject WebAppManager::getFrameTimingStatistics()
+{
+    QJsonArray apps;
+    for (AppList::const_iterator it = m_appList.begin(); it != m_appList.end(); ++it) {
+        QJsonObject app = (*it)->frameTiming();
+        if (app.isEmpty())
+            continue;
+        app["id"] = (*it)->appId();
+        app["instanceId"] = (*it)->instanceId();
+        apps.append(app);
+    }
+
+    QJsonObject result;
+    result["apps"] = apps;
+    return result;
+}
+
 #ifndef PRELOADMANAGER_ENABLED
 void WebAppManager::sendLaunchContainerApp()
 {
@@ -947,6 +1399,7 @@ WebAppBase* WebAppManager::getContainerApp()
 
 void WebAppManager::setContainerAppReady(bool ready)
 {
+    FlightRecorder::record(FlightRecorder::ContainerReady, getContainerAppId(), ready);
     if (m_containerAppManager)
         m_containerAppManager->setContainerAppReady(ready);
 }
@@ -959,6 +1412,15 @@ void WebAppManager::setContainerAppLaunched(bool launched)
 
 void WebAppManager::postRunningAppList()
 {
+    if (m_batchDepth) {
+        m_runningAppListPending = true;
+        return;
+    }
+
+    static Gauge* s_runningApps = Metrics::gauge("wam_running_apps", "Running apps, the container app excluded");
+    s_runningApps->set(m_appList.size());
+    publishRunningAppsPage();
+
     if (!m_serviceSender)
         return;
 
@@ -966,6 +1428,88 @@ void WebAppManager::postRunningAppList()
     m_serviceSender->postlistRunningApps(apps);
 }
 
+void WebAppManager::setActiveAppId(QString id)
+{
+    m_activeAppId = id;
+    m_lastActiveMs[id] = RunningAppsPage::nowMs();
+    publishRunningAppsPage();
+}
+
+void WebAppManager::publishRunningAppsPage()
+{
+    if (!RunningAppsPage::isStarted())
+        return;
+
+    std::vector<wam_running_app> apps;
+    std::list<const WebAppBase*> running = runningApps();
+    for (auto it = running.begin(); it != running.end(); ++it) {
+        const WebAppBase* app = *it;
+        wam_running_app entry;
+        memset(&entry, 0, sizeof(entry));
+
+        // Longer ids than the page holds are cut, NUL terminated
+        qstrncpy(entry.app_id, app->appId().toUtf8().constData(), sizeof(entry.app_id));
+        qstrncpy(entry.instance_id, app->instanceId().toUtf8().constData(), sizeof(entry.instance_id));
+        entry.pid = m_webProcessManager->getWebProcessPID(app);
+        if (app->page()->isPreload())
+            entry.state = WAM_APP_STATE_PRELOADED;
+        else
+            entry.state = app->isActivated() ? WAM_APP_STATE_FOREGROUND : WAM_APP_STATE_BACKGROUND;
+
+        std::map<uint32_t, uint64_t>::const_iterator memory = m_webProcessMemoryKb.find(entry.pid);
+        if (memory != m_webProcessMemoryKb.end())
+            entry.memory_kb = memory->second;
+        entry.last_active_ms = m_lastActiveMs.value(app->appId());
+        apps.push_back(entry);
+    }
+
+    RunningAppsPage::publish(apps);
+}
+
+void WebAppManager::watchRunningAppsPage()
+{
+    if (!RunningAppsPage::isStarted() || m_runningAppsPageSource)
+        return;
+
+    runningAppsPageCallback(this);
+    m_runningAppsPageSource = g_timeout_add(m_webAppManagerConfig->getRunningAppsPageInterval(), runningAppsPageCallback, this);
+}
+
+int WebAppManager::runningAppsPageCallback(void* data)
+{
+    WebAppManager* manager = static_cast<WebAppManager*>(data);
+    WatchdogScope watchdogScope("WebAppManager::runningAppsPageCallback");
+
+    // /proc is read here only, not on every change of the running apps
+    manager->m_webProcessMemoryKb.clear();
+    std::list<const WebAppBase*> running = manager->runningApps();
+    for (auto it = running.begin(); it != running.end(); ++it) {
+        uint32_t pid = manager->m_webProcessManager->getWebProcessPID(*it);
+        if (!pid || manager->m_webProcessMemoryKb.count(pid))
+            continue;
+        // VmRSS is reported as "<size> kB"
+        QString vmrss = manager->m_webProcessManager->getWebProcessMemSize(pid);
+        manager->m_webProcessMemoryKb[pid] = vmrss.section(' ', 0, 0).toULongLong();
+    }
+
+    manager->publishRunningAppsPage();
+    return G_SOURCE_CONTINUE;
+}
+
+void WebAppManager::beginBatch()
+{
+    m_batchDepth++;
+}
+
+void WebAppManager::endBatch()
+{
+    if (--m_batchDepth || !m_runningAppListPending)
+        return;
+
+    m_runningAppListPending = false;
+    postRunningAppList();
+}
+
 void WebAppManager::postWebProcessCreated(const QString& appId, uint32_t pid)
 {
     if (!m_serviceSender)
@@ -1012,16 +1556,20 @@ void WebAppManager::setAccessibilityEnabled(bool enabled)
     m_isAccessibilityEnabled = enabled;
 }
 
-void WebAppManager::sendEventToAllAppsAndAllFrames(const QString& jsscript)
+void WebAppManager::sendEventToAllAppsAndAllFrames(const QString& eventName, const QString& jsscript)
 {
+    m_broadcastService->begin(eventName);
     for (auto it = m_appList.begin(); it != m_appList.end(); ++it) {
         WebAppBase* app = (*it);
         if (app->page()) {
             LOG_DEBUG("[%s] send event with %s", qPrintable(app->appId()), qPrintable(jsscript));
             // to send all subFrame, use this function instead of evaluateJavaScriptInAllFrames()
-            app->page()->evaluateJavaScriptInAllFrames(jsscript);
+            // suspended pages keep it in their mailbox until resume
+            app->page()->postJavaScript(eventName, jsscript, JsInjectionQueue::AllFrames);
+            m_broadcastService->deliver(app->page());
         }
     }
+    m_broadcastService->end();
 }
 
 void WebAppManager::serviceCall(const QString& url, const QString& payload, const QString& appId)
@@ -28,12 +28,16 @@
 
 #include "webos/webview_base.h"
 
+class AppCloseStatistics;
 class ApplicationDescription;
+class BroadcastService;
 class ContainerAppManager;
 class DeviceInfo;
+class HibernatedAppManager;
 class NetworkStatusManager;
 class PlatformModuleFactory;
 class ServiceSender;
+class StagedLaunch;
 class WebProcessManager;
 class WebAppManagerConfig;
 class WebAppBase;
@@ -79,15 +83,33 @@ public:
     WebAppBase* findAppById(const QString& appId);
     WebAppBase* findAppByInstanceId(const QString& instanceId);
 
+    // With staged given, a cold launch of a normal app returns once it is
+    // admitted and *staged is set to the launch that creates it later on
     std::string launch(const std::string& appDescString,
         const std::string& params,
         const std::string& launchingAppId,
         int& errCode,
-        std::string& errMsg);
+        std::string& errMsg,
+        StagedLaunch** staged = 0);
+    // Same with the app description already parsed, as a bus request has it
+    std::string launch(const QJsonObject& appDesc,
+        const std::string& params,
+        const std::string& launchingAppId,
+        int& errCode,
+        std::string& errMsg,
+        StagedLaunch** staged = 0);
+    // Runs staged launches right away, each stage for all of them before
+    // the next one, so every app is created and answered before the first
+    // page is created. The launches are deleted once done.
+    void runStagedLaunches(const std::vector<StagedLaunch*>& launches);
 
     std::vector<ApplicationInfo> list(bool includeSystemApps = false);
 
     QJsonObject getWebProcessProfiling();
+    AppCloseStatistics* closeStatistics() { return m_closeStatistics; }
+    QJsonObject getAppCloseStatistics();
+    QJsonObject getBroadcastStatistics();
+    QJsonObject getFrameTimingStatistics();
 #ifndef PRELOADMANAGER_ENABLED
     void sendLaunchContainerApp();
     void startContainerTimer();
@@ -105,8 +127,10 @@ public:
     int currentUiHeight();
     void setUiSize(int width, int height);
 
-    void setActiveAppId(QString id) { m_activeAppId = id; }
+    void setActiveAppId(QString id);
     const QString getActiveAppId() { return m_activeAppId; }
+    // Starts refreshing the running apps page, once a reader has asked for it
+    void watchRunningAppsPage();
 
     void onGlobalProperties(int key);
     bool purgeSurfacePool(uint32_t pid);
@@ -133,8 +157,9 @@ public:
     void killCustomPluginProcess(const QString& basePath);
     bool processCrashed(QString appId);
 
-    void closeAppInternal(WebAppBase* app, bool ignoreCleanResource = false);
+    void closeAppInternal(WebAppBase* app, bool ignoreCleanResource = false, bool allowHibernation = true);
     void forceCloseAppInternal(WebAppBase* app);
+    void closeHibernatedApp(WebAppBase* app);
 
     void webPageAdded(WebPageBase* page);
     void webPageRemoved(WebPageBase* page);
@@ -142,6 +167,10 @@ public:
 
     void appDeleted(WebAppBase* app);
     void postRunningAppList();
+    // Running app list updates inside a batch are posted once, when the
+    // outermost batch ends
+    void beginBatch();
+    void endBatch();
     std::string generateInstanceId();
     void removeClosingAppList(const QString& appId);
 
@@ -149,7 +178,7 @@ public:
     void setAccessibilityEnabled(bool enabled);
     void postWebProcessCreated(const QString& appId, uint32_t pid);
     uint32_t getWebProcessId(const QString& appId);
-    void sendEventToAllAppsAndAllFrames(const QString& jsscript);
+    void sendEventToAllAppsAndAllFrames(const QString& eventName, const QString& jsscript);
     void serviceCall(const QString& url, const QString& payload, const QString& appId);
     void updateNetworkStatus(const QJsonObject& object);
     void notifyMemoryPressure(webos::WebViewBase::MemoryPressureLevel level);
@@ -174,6 +203,17 @@ private:
     std::string onLaunchContainerApp(const std::string& appDesc);
     void onRelaunchApp(const std::string& instanceId, const std::string& appId,
         const std::string& args, const std::string& launchingAppId);
+    WebAppBase* onReviveHibernatedApp(QString winType, const ApplicationDescription* appDesc,
+        const std::string& instanceId, const std::string& args, const std::string& launchingAppId);
+    bool hibernateApp(WebAppBase* app);
+
+    bool runLaunchStage(StagedLaunch* launch);
+    void finishStagedLaunches(const std::string& appId = std::string());
+    void dropStagedLaunches();
+    static int launchStageCallback(void* data);
+
+    void publishRunningAppsPage();
+    static int runningAppsPageCallback(void* data);
 
     WebAppManager();
 
@@ -204,6 +244,9 @@ private:
     DeviceInfo* m_deviceInfo;
     WebAppManagerConfig* m_webAppManagerConfig;
     NetworkStatusManager* m_networkStatusManager;
+    AppCloseStatistics* m_closeStatistics;
+    HibernatedAppManager* m_hibernatedAppManager;
+    BroadcastService* m_broadcastService;
 
     QMap<QString, int> m_lastCrashedAppIds;
 
@@ -211,6 +254,18 @@ private:
 
     std::map<std::string, std::string> m_appVersion;
 
+    std::list<StagedLaunch*> m_stagedLaunches;
+    unsigned int m_launchStageSource;
+    bool m_runningLaunchStage;
+
+    int m_batchDepth;
+    bool m_runningAppListPending;
+
+    // Running apps page, the memory by web process pid is refreshed by the timer
+    unsigned int m_runningAppsPageSource;
+    std::map<uint32_t, uint64_t> m_webProcessMemoryKb;
+    QMap<QString, uint64_t> m_lastActiveMs;
+
     bool m_isAccessibilityEnabled;
 };
 
@@ -28,6 +28,20 @@ WebAppManagerConfig::WebAppManagerConfig()
     , m_checkLaunchTimeEnabled(false)
     , m_useSystemAppOptimization(false)
     , m_launchOptimizationEnabled(false)
+    , m_closeCallbackTimeout(10000)
+    , m_hibernationTimeout(0)
+    , m_hibernationMaxApps(2)
+    , m_hibernationMemoryBudget(0)
+    , m_binaryLogDumpFile("/tmp/wam-binary-log.dump")
+    , m_metricsInterval(10000)
+    , m_traceEventsEnabled(false)
+    , m_traceEventsFile("/tmp/wam-trace.json")
+    , m_watchdogThreshold(0)
+    , m_watchdogBacktraceEnabled(false)
+    , m_flightRecorderFile("/tmp/wam-flight-recorder.txt")
+    , m_jsonWorkerThreads(2)
+    , m_jsonOffloadThreshold(64 * 1024)
+    , m_runningAppsPageInterval(5000)
 {
     initConfiguration();
 }
@@ -68,6 +82,68 @@ void WebAppManagerConfig::initConfiguration()
     if (qgetenv("ENABLE_LAUNCH_OPTIMIZATION") == "1")
         m_launchOptimizationEnabled = true;
 
+    // Upper bound of the per-app adaptive close callback timeout
+    QString closeCallbackTimeout = QLatin1String(qgetenv("WAM_CLOSE_CALLBACK_TIMEOUT_MS"));
+    if (closeCallbackTimeout.toInt() > 0)
+        m_closeCallbackTimeout = closeCallbackTimeout.toInt();
+
+    // Closed apps are kept hidden for reopen only when the timeout is set
+    m_hibernationTimeout = std::max(QString(qgetenv("WAM_HIBERNATION_TIMEOUT_MS")).toInt(), 0);
+
+    QString hibernationMaxApps = QLatin1String(qgetenv("WAM_HIBERNATION_MAX_APPS"));
+    if (!hibernationMaxApps.isEmpty())
+        m_hibernationMaxApps = std::max(hibernationMaxApps.toInt(), 0);
+
+    // In kB for all hibernated apps, each taken as an even share of the VmRSS
+    // of its web process, 0 means no budget
+    m_hibernationMemoryBudget = std::max(QString(qgetenv("WAM_HIBERNATION_MEMORY_BUDGET_KB")).toInt(), 0);
+
+    // "pmlog" or the path of a dump file for wam-logdecode, see BinaryLogger.h
+    m_binaryLogOutput = qgetenv("WAM_BINARY_LOG").data();
+    // Written by the logControl binaryLog and binaryLogDump keys
+    if (!qgetenv("WAM_BINARY_LOG_DUMP_FILE").isEmpty())
+        m_binaryLogDumpFile = qgetenv("WAM_BINARY_LOG_DUMP_FILE").data();
+
+    // Prometheus text file, e.g. for the node exporter textfile collector
+    m_metricsFile = qgetenv("WAM_METRICS_FILE").data();
+    QString metricsInterval = QLatin1String(qgetenv("WAM_METRICS_INTERVAL_MS"));
+    if (metricsInterval.toInt() > 0)
+        m_metricsInterval = metricsInterval.toInt();
+
+    // Trace events are recorded from start up, SIGUSR2 writes them to the file
+    if (qgetenv("WAM_TRACE_EVENTS") == "1")
+        m_traceEventsEnabled = true;
+    if (!qgetenv("WAM_TRACE_EVENTS_FILE").isEmpty())
+        m_traceEventsFile = qgetenv("WAM_TRACE_EVENTS_FILE").data();
+
+    // In ms the main loop may be blocked before it counts as a stall, 0 disables the watchdog
+    m_watchdogThreshold = std::max(QString(qgetenv("WAM_WATCHDOG_THRESHOLD_MS")).toInt(), 0);
+    if (qgetenv("WAM_WATCHDOG_BACKTRACE") == "1")
+        m_watchdogBacktraceEnabled = true;
+
+    // Written when WAM or a web process crashes, the previous dumps are kept
+    // as <file>.1 to <file>.3
+    if (!qgetenv("WAM_FLIGHT_RECORDER_FILE").isEmpty())
+        m_flightRecorderFile = qgetenv("WAM_FLIGHT_RECORDER_FILE").data();
+
+    // Incoming luna calls for wam-lunareplay, see LunaTrace.h
+    m_lunaTraceFile = qgetenv("WAM_LUNA_TRACE").data();
+
+    // Luna payloads of at least the threshold in bytes are parsed and
+    // serialized off the main loop, 0 threads keeps them on it
+    QString jsonWorkerThreads = QLatin1String(qgetenv("WAM_JSON_WORKERS"));
+    if (!jsonWorkerThreads.isEmpty())
+        m_jsonWorkerThreads = std::max(jsonWorkerThreads.toInt(), 0);
+    QString jsonOffloadThreshold = QLatin1String(qgetenv("WAM_JSON_OFFLOAD_BYTES"));
+    if (jsonOffloadThreshold.toInt() > 0)
+        m_jsonOffloadThreshold = jsonOffloadThreshold.toInt();
+
+    // In ms, how often the web process memory in the running apps page is
+    // refreshed once a reader asked for the page, 0 turns the page off
+    QString runningAppsPageInterval = QLatin1String(qgetenv("WAM_RUNNING_APPS_PAGE_INTERVAL"));
+    if (!runningAppsPageInterval.isEmpty())
+        m_runningAppsPageInterval = std::max(runningAppsPageInterval.toInt(), 0);
+
     m_userScriptPath = QLatin1String(qgetenv("USER_SCRIPT_PATH"));
     if (m_userScriptPath.isEmpty())
         m_userScriptPath = QLatin1String("webOSUserScripts/userScript.js");
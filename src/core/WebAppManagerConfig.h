@@ -44,6 +44,23 @@ public:
     virtual std::string getName() const { return m_name; }
 
     virtual bool isLaunchOptimizationEnabled() const { return m_launchOptimizationEnabled; }
+    virtual int getCloseCallbackTimeout() const { return m_closeCallbackTimeout; }
+    virtual int getHibernationTimeout() const { return m_hibernationTimeout; }
+    virtual int getHibernationMaxApps() const { return m_hibernationMaxApps; }
+    virtual int getHibernationMemoryBudget() const { return m_hibernationMemoryBudget; }
+    virtual std::string getBinaryLogOutput() const { return m_binaryLogOutput; }
+    virtual std::string getBinaryLogDumpFile() const { return m_binaryLogDumpFile; }
+    virtual std::string getMetricsFile() const { return m_metricsFile; }
+    virtual int getMetricsInterval() const { return m_metricsInterval; }
+    virtual bool isTraceEventsEnabled() const { return m_traceEventsEnabled; }
+    virtual std::string getTraceEventsFile() const { return m_traceEventsFile; }
+    virtual int getWatchdogThreshold() const { return m_watchdogThreshold; }
+    virtual bool isWatchdogBacktraceEnabled() const { return m_watchdogBacktraceEnabled; }
+    virtual std::string getFlightRecorderFile() const { return m_flightRecorderFile; }
+    virtual std::string getLunaTraceFile() const { return m_lunaTraceFile; }
+    virtual int getJsonWorkerThreads() const { return m_jsonWorkerThreads; }
+    virtual int getJsonOffloadThreshold() const { return m_jsonOffloadThreshold; }
+    virtual int getRunningAppsPageInterval() const { return m_runningAppsPageInterval; }
 
 protected:
     virtual QVariant getConfiguration(QString name);
@@ -66,6 +83,23 @@ private:
     bool m_checkLaunchTimeEnabled;
     bool m_useSystemAppOptimization;
     bool m_launchOptimizationEnabled;
+    int m_closeCallbackTimeout;
+    int m_hibernationTimeout;
+    int m_hibernationMaxApps;
+    int m_hibernationMemoryBudget;
+    std::string m_binaryLogOutput;
+    std::string m_binaryLogDumpFile;
+    std::string m_metricsFile;
+    int m_metricsInterval;
+    bool m_traceEventsEnabled;
+    std::string m_traceEventsFile;
+    int m_watchdogThreshold;
+    bool m_watchdogBacktraceEnabled;
+    std::string m_flightRecorderFile;
+    std::string m_lunaTraceFile;
+    int m_jsonWorkerThreads;
+    int m_jsonOffloadThreshold;
+    int m_runningAppsPageInterval;
     QString m_userScriptPath;
     std::string m_name;
 
@@ -16,19 +16,28 @@
 
 #include "WebAppManagerService.h"
 
+#include <algorithm>
 #include <vector>
 
+#include <QJsonArray>
+#include <QJsonDocument>
+
+#include "BinaryLogger.h"
+#include "LaunchTimeline.h"
+#include "LogChannel.h"
 #include "LogManager.h"
+#include "Metrics.h"
+#include "StagedLaunch.h"
 #include "WebAppBase.h"
 
 WebAppManagerService::WebAppManagerService()
 {
 }
 
-std::string WebAppManagerService::onLaunch(const std::string& appDescString, const std::string& params,
-        const std::string& launchingAppId, int& errCode, std::string& errMsg)
+std::string WebAppManagerService::onLaunch(const QJsonObject& appDesc, const std::string& params,
+        const std::string& launchingAppId, int& errCode, std::string& errMsg, StagedLaunch** staged)
 {
-    return WebAppManager::instance()->launch(appDescString, params, launchingAppId, errCode, errMsg);
+    return WebAppManager::instance()->launch(appDesc, params, launchingAppId, errCode, errMsg, staged);
 }
 
 bool WebAppManagerService::onKillApp(const std::string& appId)
@@ -37,6 +46,220 @@ bool WebAppManagerService::onKillApp(const std::string& appId)
     return WebAppManager::instance()->onKillApp(appId);
 }
 
+QJsonObject WebAppManagerService::launchAppReply(const QJsonValue& appId, const std::string& instanceId, int errCode, const std::string& errMsg)
+{
+    QJsonObject reply;
+    if (instanceId.empty()) {
+        reply["returnValue"] = false;
+        reply["errorCode"] = errCode;
+        reply["errorText"] = QString::fromStdString(errMsg);
+    }
+    else {
+        reply["returnValue"] = true;
+        reply["appId"] = appId;
+        reply["procId"] = QString::fromStdString(instanceId);
+    }
+    return reply;
+}
+
+QJsonObject WebAppManagerService::onLaunchAppRequest(const QJsonObject& request, StagedLaunch** staged)
+{
+    int errCode;
+    std::string errMsg;
+    QJsonObject reply;
+
+    std::string appId = request["appDesc"].toObject()["id"].toString().toStdString();
+    LaunchTimeline::begin(appId);
+
+    if (  !request["appDesc"].isObject()
+       || !request["parameters"].isObject()
+       || !request["launchingAppId"].isString()
+       || !request["launchingProcId"].isString()) {
+        reply["returnValue"] = false;
+        reply["errorCode"] = ERR_CODE_LAUNCHAPP_MISS_PARAM;
+        reply["errorText"] = QString::fromStdString(err_missParam);
+        LaunchTimeline::endRequest(false);
+        return reply;
+    }
+
+    QJsonDocument doc(request["parameters"].toObject());
+    QJsonObject jsonParams = doc.object();
+    if(request["launchHidden"].toBool()) {
+        jsonParams["launchedHidden"] = true;
+    }
+
+    // if "preload" parameter is not "full" or "partial" or "minimal", there is no preload parameter.
+    if (request["preload"].isString()) {
+        jsonParams["preload"] = request["preload"].toString();
+    }
+
+    if(request["keepAlive"].toBool()) {
+        jsonParams["keepAlive"] = true;
+    }
+    doc.setObject(jsonParams);
+    QString params(doc.toJson(QJsonDocument::Compact));
+
+    LOG_INFO_WITH_CLOCK(MSGID_APPLAUNCH_START, 3,
+                        PMLOGKS("PerfType","AppLaunch"),
+                        PMLOGKS("PerfGroup", appId.c_str()),
+                        PMLOGKS("APP_ID", appId.c_str()), "params : %s", qPrintable(params));
+
+    std::string instanceId;
+    instanceId = onLaunch(request["appDesc"].toObject(),
+                          params.toStdString(),
+                          request["launchingAppId"].toString().toStdString(),
+                          errCode, errMsg, staged);
+
+    if (staged && *staged)
+        return reply;
+
+    LaunchTimeline::mark(LaunchTimeline::PhaseReplied);
+    if (!instanceId.empty())
+        LaunchTimeline::mark(QString::fromStdString(instanceId), LaunchTimeline::PhaseReplied);
+    LaunchTimeline::endRequest(!instanceId.empty());
+
+    return launchAppReply(request["appDesc"].toObject()["id"], instanceId, errCode, errMsg);
+}
+
+// Keeps the outcome of a cold launch of a launchApps batch for its reply
+class BatchLaunchResult : public StagedLaunch::Client {
+public:
+    BatchLaunchResult()
+        : errCode(0)
+    {
+    }
+
+    void launchFinished(const std::string& launchedInstanceId, int launchErrCode, const std::string& launchErrMsg) override
+    {
+        instanceId = launchedInstanceId;
+        errCode = launchErrCode;
+        errMsg = launchErrMsg;
+    }
+
+    std::string instanceId;
+    int errCode;
+    std::string errMsg;
+};
+
+// Launches the apps of {"apps": [<launchApp request>, ...]} in one go, those
+// with a higher "priority" first, and replies with the launchApp reply of
+// each app in request order. Cold launches are staged and then run stage by
+// stage across the batch. The running app list is posted once.
+QJsonObject WebAppManagerService::onLaunchAppsRequest(const QJsonObject& request)
+{
+    QJsonObject reply;
+    QJsonArray apps = request["apps"].toArray();
+    if (apps.isEmpty()) {
+        reply["returnValue"] = false;
+        reply["errorCode"] = ERR_CODE_LAUNCHAPP_MISS_PARAM;
+        reply["errorText"] = QString::fromStdString(err_missParam);
+        return reply;
+    }
+
+    // (-priority, index) pairs, so apps of the same priority keep their order
+    std::vector<std::pair<int, int> > order;
+    for (int i = 0; i < apps.size(); i++)
+        order.push_back(std::make_pair(-apps[i].toObject()["priority"].toInt(), i));
+    std::sort(order.begin(), order.end());
+
+    std::vector<QJsonObject> results(apps.size());
+    std::vector<StagedLaunch*> staged(apps.size());
+    std::vector<BatchLaunchResult> stagedResults(apps.size());
+    onBeginBatch();
+    LaunchTimeline::beginBatch();
+    for (size_t i = 0; i < order.size(); i++) {
+        int index = order[i].second;
+        results[index] = onLaunchAppRequest(apps[index].toObject(), &staged[index]);
+        if (staged[index])
+            staged[index]->setClient(&stagedResults[index]);
+    }
+    LaunchTimeline::endBatch();
+
+    // In priority order as well, every launch has told its result once
+    // they have run
+    std::vector<StagedLaunch*> launches;
+    for (size_t i = 0; i < order.size(); i++) {
+        if (staged[order[i].second])
+            launches.push_back(staged[order[i].second]);
+    }
+    WebAppManager::instance()->runStagedLaunches(launches);
+
+    for (size_t i = 0; i < staged.size(); i++) {
+        if (!staged[i])
+            continue;
+        const BatchLaunchResult& result = stagedResults[i];
+        if (!result.instanceId.empty())
+            LaunchTimeline::mark(QString::fromStdString(result.instanceId), LaunchTimeline::PhaseReplied);
+        results[i] = launchAppReply(apps[i].toObject()["appDesc"].toObject()["id"], result.instanceId, result.errCode, result.errMsg);
+    }
+    onEndBatch();
+
+    QJsonArray resultArray;
+    for (size_t i = 0; i < results.size(); i++)
+        resultArray.append(results[i]);
+
+    reply["returnValue"] = true;
+    reply["results"] = resultArray;
+    return reply;
+}
+
+QJsonObject WebAppManagerService::onKillAppRequest(const QJsonObject& request)
+{
+    bool instances;
+    instances = onKillApp(request["appId"].toString().toStdString());
+
+    QJsonObject reply;
+    if(instances)
+    {
+        reply["appId"] = request["appId"].toString();
+        reply["returnValue"] = true;
+    }
+    else
+    {
+        reply["returnValue"] = false;
+        reply["errorCode"] = ERR_CODE_KILLAPP_NO_APP;
+        reply["errorText"] = QString::fromStdString(err_noRunningApp);
+    }
+    return reply;
+}
+
+// Closes the apps of {"appIds": [...]} and replies with the killApp reply of
+// each app in request order. The running app list is posted once.
+QJsonObject WebAppManagerService::onCloseAppsRequest(const QJsonObject& request)
+{
+    QJsonObject reply;
+    QJsonArray appIds = request["appIds"].toArray();
+    if (appIds.isEmpty()) {
+        reply["returnValue"] = false;
+        reply["errorCode"] = ERR_CODE_KILLAPP_NO_APP;
+        reply["errorText"] = QString::fromStdString(err_noRunningApp);
+        return reply;
+    }
+
+    QJsonArray results;
+    onBeginBatch();
+    for (int i = 0; i < appIds.size(); i++) {
+        QJsonObject killRequest;
+        killRequest["appId"] = appIds[i];
+        results.append(onKillAppRequest(killRequest));
+    }
+    onEndBatch();
+
+    reply["returnValue"] = true;
+    reply["results"] = results;
+    return reply;
+}
+
+void WebAppManagerService::onBeginBatch()
+{
+    WebAppManager::instance()->beginBatch();
+}
+
+void WebAppManagerService::onEndBatch()
+{
+    WebAppManager::instance()->endBatch();
+}
+
 QJsonObject WebAppManagerService::onLogControl(const std::string& keys, const std::string& value)
 {
     LogManager::setLogControl(keys, value);
@@ -46,6 +269,8 @@ QJsonObject WebAppManagerService::onLogControl(const std::string& keys, const st
     reply["event"] = LogManager::getDebugEventsEnabled();
     reply["bundleMessage"] = LogManager::getDebugBundleMessagesEnabled();
     reply["mouseMove"] = LogManager::getDebugMouseMoveEnabled();
+    reply["logChannels"] = LogChannel::statistics();
+    reply["binaryLog"] = BinaryLogger::statistics();
 
     return reply;
 }
@@ -82,6 +307,25 @@ QJsonObject WebAppManagerService::getWebProcessProfiling()
     return WebAppManager::instance()->getWebProcessProfiling();
 }
 
+QJsonObject WebAppManagerService::onGetMetrics(bool text)
+{
+    QJsonObject reply;
+    if (text) {
+        reply["text"] = QString::fromStdString(Metrics::toText());
+        return reply;
+    }
+
+    // Per app statistics that do not fit a metric with one label are only
+    // in the JSON form
+    reply = Metrics::toJson();
+    QJsonObject statistics;
+    statistics["close"] = WebAppManager::instance()->getAppCloseStatistics();
+    statistics["broadcast"] = WebAppManager::instance()->getBroadcastStatistics();
+    statistics["frameTiming"] = WebAppManager::instance()->getFrameTimingStatistics();
+    reply["statistics"] = statistics;
+    return reply;
+}
+
 void WebAppManagerService::onClearBrowsingData(const int removeBrowsingDataMask)
 {
     WebAppManager::instance()->clearBrowsingData(removeBrowsingDataMask);
@@ -171,6 +415,23 @@ std::vector<ApplicationInfo> WebAppManagerService::list(bool includeSystemApps)
     return WebAppManager::instance()->list(includeSystemApps);
 }
 
+QJsonObject WebAppManagerService::runningAppsReply(const std::vector<ApplicationInfo>& apps)
+{
+    QJsonArray runningApps;
+    for (auto it = apps.begin(); it != apps.end(); ++it) {
+        QJsonObject app;
+        app["id"] = it->appId;
+        app["processid"] = it->instanceId;
+        app["webprocessid"] = QString::number(it->pid);
+        runningApps.append(app);
+    }
+
+    QJsonObject reply;
+    reply["running"] = runningApps;
+    reply["returnValue"] = true;
+    return reply;
+}
+
 QJsonObject WebAppManagerService::closeByInstanceId(QString instanceId)
 {
     LOG_INFO(MSGID_LUNA_API, 2, PMLOGKS("INSTANCE_ID", qPrintable(instanceId)), PMLOGKS("API", "closeByInstanceId"), "");
@@ -196,6 +457,11 @@ QJsonObject WebAppManagerService::closeByInstanceId(QString instanceId)
     return reply;
 }
 
+void WebAppManagerService::onRunningAppsPageRequested()
+{
+    WebAppManager::instance()->watchRunningAppsPage();
+}
+
 void WebAppManagerService::setAccessibilityEnabled(bool enable)
 {
     WebAppManager::instance()->setAccessibilityEnabled(enable);
@@ -27,6 +27,7 @@ enum ErrorCode {
     ERR_CODE_LAUNCHAPP_MISS_PARAM = 1000,
     ERR_CODE_LAUNCHAPP_UNSUPPORTED_TYPE = 1001,
     ERR_CODE_LAUNCHAPP_INVALID_TRUSTLEVEL = 1002,
+    ERR_CODE_LAUNCHAPP_CANCELED = 1003,
     ERR_CODE_KILLAPP_NO_APP = 2000,
     ERR_CODE_CLEAR_DATA_BRAWSING_EMPTY_ARRAY = 3000,
     ERR_CODE_CLEAR_DATA_BRAWSING_INVALID_VALUE = 3001,
@@ -36,6 +37,7 @@ enum ErrorCode {
 const std::string err_missParam = "Miss launch parameter(s)";
 const std::string err_unsupportedType = "Unsupported app type (Check subType)";
 const std::string err_invalidTrustLevel = "Invalid trust level (Check trustLevel)";
+const std::string err_launchCanceled = "Launch canceled, WebAppManager is shutting down";
 
 const std::string err_noRunningApp = "App is not running";
 
@@ -61,17 +63,33 @@ public:
     virtual QJsonObject listRunningApps(QJsonObject request, bool subscribed) = 0;
     virtual QJsonObject closeByProcessId(QJsonObject request) = 0;
     virtual QJsonObject getWebProcessSize(QJsonObject request) = 0;
+    virtual QJsonObject getMetrics(QJsonObject request) = 0;
     virtual QJsonObject clearBrowsingData(QJsonObject request) = 0;
     virtual QJsonObject webProcessCreated(QJsonObject request, bool subscribed) = 0;
 
+    // Reply of listRunningApps, which its subscribers get on every change
+    static QJsonObject runningAppsReply(const std::vector<ApplicationInfo>& apps);
+    // Reply of launchApp, instanceId is empty if the launch failed
+    static QJsonObject launchAppReply(const QJsonValue& appId, const std::string& instanceId, int errCode, const std::string& errMsg);
+
 protected:
-    std::string onLaunch(const std::string& appDescString,
+    std::string onLaunch(const QJsonObject& appDesc,
         const std::string& params,
         const std::string& launchingAppId,
         int& errCode,
-        std::string& errMsg);
+        std::string& errMsg,
+        StagedLaunch** staged = 0);
 
     bool onKillApp(const std::string& appId);
+    // Request handling shared by the bus service and wam-lunareplay. With
+    // staged given, a cold launch is only started, *staged is set and an
+    // empty reply is returned; the caller sets the client that answers it.
+    QJsonObject onLaunchAppRequest(const QJsonObject& request, StagedLaunch** staged = 0);
+    QJsonObject onLaunchAppsRequest(const QJsonObject& request);
+    QJsonObject onKillAppRequest(const QJsonObject& request);
+    QJsonObject onCloseAppsRequest(const QJsonObject& request);
+    void onBeginBatch();
+    void onEndBatch();
     QJsonObject onLogControl(const std::string& keys, const std::string& value);
     bool onCloseAllApps(uint32_t pid = 0);
     bool closeContainerApp();
@@ -79,7 +97,9 @@ protected:
     void onDiscardCodeCache(uint32_t pid);
     bool onPurgeSurfacePool(uint32_t pid);
     QJsonObject getWebProcessProfiling();
+    QJsonObject onGetMetrics(bool text);
     QJsonObject closeByInstanceId(QString instanceId);
+    void onRunningAppsPageRequested();
     int maskForBrowsingDataType(const char* type);
     void onClearBrowsingData(const int removeBrowsingDataMask);
 
@@ -17,33 +17,68 @@
 #ifndef WebAppManagerTracer_h
 #define WebAppManagerTracer_h
 
+#include "TraceEventRecorder.h"
+
+// Every trace point goes to LTTng when it is built in and to the in memory
+// TraceEventRecorder while that is recording
+
 #ifdef HAS_LTTNG
 
 #include "pmtrace_webappmanager3_provider.h"
 
+#define PMTRACE_LTTNG(event, label) \
+    tracepoint(pmtrace_webappmanager3, event, const_cast<char*>(label))
+
+#else // HAS_LTTNG
+
+#define PMTRACE_LTTNG(event, label)
+
+#endif // HAS_LTTNG
+
+#define PMTRACE_RECORD(phase, label)                             \
+    do {                                                         \
+        if (TraceEventRecorder::isEnabled())                     \
+            TraceEventRecorder::add(TraceEventRecorder::phase, label); \
+    } while (0)
+
 /* PMTRACE_LOG is for free form tracing. Provide a string
    which uniquely identifies your trace point. */
-#define PMTRACE(label) \
-    tracepoint(pmtrace_webappmanager3, message, label)
+#define PMTRACE(label)                     \
+    do {                                   \
+        PMTRACE_LTTNG(message, label);     \
+        PMTRACE_RECORD(Instant, label);    \
+    } while (0)
 
 /* PMTRACE_BEFORE / AFTER is for tracing a time duration
  * which is not contained within a scope (curly braces) or function,
  * or in C code where there is no mechanism to automatically detect
  * exiting a scope or function.
  */
-#define PMTRACE_BEFORE(label) \
-    tracepoint(pmtrace_webappmanager3, before, label)
-#define PMTRACE_AFTER(label) \
-    tracepoint(pmtrace_webappmanager3, after, label)
+#define PMTRACE_BEFORE(label)              \
+    do {                                   \
+        PMTRACE_LTTNG(before, label);      \
+        PMTRACE_RECORD(AsyncBegin, label); \
+    } while (0)
+#define PMTRACE_AFTER(label)               \
+    do {                                   \
+        PMTRACE_LTTNG(after, label);       \
+        PMTRACE_RECORD(AsyncEnd, label);   \
+    } while (0)
 
 /* PMTRACE_SCOPE* is for tracing a the duration of a scope.  In
  * C++ code use PMTRACE_SCOPE only, in C code use the
  * ENTRY/EXIT macros and be careful to catch all exit cases.
  */
-#define PMTRACE_SCOPE_ENTRY(label) \
-    tracepoint(pmtrace_webappmanager3, scope_entry, label)
-#define PMTRACE_SCOPE_EXIT(label) \
-    tracepoint(pmtrace_webappmanager3, scope_exit, label)
+#define PMTRACE_SCOPE_ENTRY(label)         \
+    do {                                   \
+        PMTRACE_LTTNG(scope_entry, label); \
+        PMTRACE_RECORD(Begin, label);      \
+    } while (0)
+#define PMTRACE_SCOPE_EXIT(label)          \
+    do {                                   \
+        PMTRACE_LTTNG(scope_exit, label);  \
+        PMTRACE_RECORD(End, label);        \
+    } while (0)
 #define PMTRACE_SCOPE(label) \
     PmTraceScope traceScope(label)
 
@@ -51,16 +86,22 @@
  * In C++ code use PMTRACE_FUNCTION only, in C code use the
  * ENTRY/EXIT macros and be careful to catch all exit cases.
  */
-#define PMTRACE_FUNCTION_ENTRY(label) \
-    tracepoint(pmtrace_webappmanager3, function_entry, label)
-#define PMTRACE_FUNCTION_EXIT(label) \
-    tracepoint(pmtrace_webappmanager3, function_exit, label)
+#define PMTRACE_FUNCTION_ENTRY(label)         \
+    do {                                      \
+        PMTRACE_LTTNG(function_entry, label); \
+        PMTRACE_RECORD(Begin, label);         \
+    } while (0)
+#define PMTRACE_FUNCTION_EXIT(label)          \
+    do {                                      \
+        PMTRACE_LTTNG(function_exit, label);  \
+        PMTRACE_RECORD(End, label);           \
+    } while (0)
 #define PMTRACE_FUNCTION \
-    PmTraceFunction traceFunction(const_cast<char*>(Q_FUNC_INFO))
+    PmTraceFunction traceFunction(Q_FUNC_INFO)
 
 class PmTraceScope {
 public:
-    PmTraceScope(char* label)
+    PmTraceScope(const char* label)
         : scopeLabel(label)
     {
         PMTRACE_SCOPE_ENTRY(scopeLabel);
@@ -72,7 +113,7 @@ public:
     }
 
 private:
-    char* scopeLabel;
+    const char* scopeLabel;
 
     // Prevent heap allocation
     void operator delete(void*);
@@ -83,7 +124,7 @@ private:
 
 class PmTraceFunction {
 public:
-    PmTraceFunction(char* label)
+    PmTraceFunction(const char* label)
         : fnLabel(label)
     {
         PMTRACE_FUNCTION_ENTRY(fnLabel);
@@ -95,7 +136,7 @@ public:
     }
 
 private:
-    char* fnLabel;
+    const char* fnLabel;
 
     // Prevent heap allocation
     void operator delete(void*);
@@ -104,18 +145,4 @@ private:
     PmTraceFunction& operator=(const PmTraceFunction&);
 };
 
-#else // HAS_LTNG
-
-#define PMTRACE(label)
-#define PMTRACE_BEFORE(label)
-#define PMTRACE_AFTER(label)
-#define PMTRACE_SCOPE_ENTRY(label)
-#define PMTRACE_SCOPE_EXIT(label)
-#define PMTRACE_SCOPE(label)
-#define PMTRACE_FUNCTION_ENTRY(label)
-#define PMTRACE_FUNCTION_EXIT(label)
-#define PMTRACE_FUNCTION
-
-#endif // HAS_LTTNG
-
 #endif // WebAppManagerTracer_h
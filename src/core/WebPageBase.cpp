@@ -38,6 +38,7 @@ WebPageBase::WebPageBase()
     , m_isLoadErrorPageStart(false)
     , m_enableBackgroundRun(false)
     , m_loadErrorPolicy(QStringLiteral("default"))
+    , m_injectionQueue(this)
     , m_cleaningResources(false)
     , m_isPreload(false)
 {
@@ -54,6 +55,7 @@ WebPageBase::WebPageBase(const QUrl& url, ApplicationDescription* desc, const QS
     , m_defaultUrl(url)
     , m_launchParams(params)
     , m_loadErrorPolicy(QStringLiteral("default"))
+    , m_injectionQueue(this)
     , m_cleaningResources(false)
     , m_isPreload(false)
 {
@@ -101,6 +103,12 @@ void WebPageBase::load()
     }
 }
 
+void WebPageBase::reloadForLaunch()
+{
+    // Used when a hibernated page is revived, load again as a new launch
+    load();
+}
+
 void WebPageBase::setupLaunchEvent()
 {
     QString launchEventJS = QStringLiteral(
@@ -124,7 +132,7 @@ void WebPageBase::setupLaunchEvent()
 
 void WebPageBase::sendLocaleChangeEvent(const QString& language)
 {
-    evaluateJavaScript(QStringLiteral(
+    postJavaScript(QStringLiteral("webOSLocaleChange"), QStringLiteral(
         "setTimeout(function () {"
         "    var localeEvent=new CustomEvent('webOSLocaleChange');"
         "    document.dispatchEvent(localeEvent);"
@@ -132,8 +140,35 @@ void WebPageBase::sendLocaleChangeEvent(const QString& language)
     ));
 }
 
+void WebPageBase::deferDeviceInfoChanged(const QString& deviceInfo)
+{
+    if (!m_deferredDeviceInfo.contains(deviceInfo))
+        m_deferredDeviceInfo.append(deviceInfo);
+}
+
+void WebPageBase::applyDeferredCalls()
+{
+    if (!m_deferredLanguage.isEmpty()) {
+        QString language;
+        language.swap(m_deferredLanguage);
+        setPreferredLanguages(language);
+        sendLocaleChangeEvent(language);
+    }
+
+    QStringList deviceInfo;
+    deviceInfo.swap(m_deferredDeviceInfo);
+    for (QStringList::const_iterator it = deviceInfo.begin(); it != deviceInfo.end(); ++it)
+        handleDeviceInfoChanged(*it);
+}
+
+void WebPageBase::postJavaScript(const QString& key, const QString& jsCode, JsInjectionQueue::Target target)
+{
+    m_injectionQueue.post(key, jsCode, target);
+}
+
 void WebPageBase::cleanResources()
 {
+    m_injectionQueue.clear();
     setCleaningResources(true);
 }
 
@@ -19,8 +19,10 @@
 
 #include <QObject>
 #include <QtCore/QString>
+#include <QtCore/QStringList>
 #include <QtCore/QUrl>
 
+#include "JsInjectionQueue.h"
 #include "ObserverList.h"
 
 #include "webos/webview_base.h"
@@ -84,6 +86,7 @@ public:
     virtual void updatePageSettings() = 0;
     virtual void handleDeviceInfoChanged(const QString& deviceInfo) = 0;
     virtual bool relaunch(const QString& args, const QString& launchingAppId);
+    virtual void reloadForLaunch();
     virtual void evaluateJavaScript(const QString& jsCode) = 0;
     virtual void evaluateJavaScriptInAllFrames(const QString& jsCode, const char* method = "") = 0;
     virtual void setForceActivateVtg(bool enabled) = 0;
@@ -121,6 +124,16 @@ public:
     void load();
     void setEnableBackgroundRun(bool enable) { m_enableBackgroundRun = enable; }
     void sendLocaleChangeEvent(const QString& language);
+    void postJavaScript(const QString& key, const QString& jsCode,
+        JsInjectionQueue::Target target = JsInjectionQueue::MainFrame);
+    void flushJavaScript() { m_injectionQueue.flush(); }
+    bool hasPendingJavaScript() const { return !m_injectionQueue.isEmpty(); }
+    bool isJavaScriptHeld() const { return m_injectionQueue.isHeld(); }
+    // Engine calls of a broadcast to a held page, made when it is released
+    // instead of waking its renderer now. Only the latest language is kept.
+    void deferPreferredLanguages(const QString& language) { m_deferredLanguage = language; }
+    void deferDeviceInfoChanged(const QString& deviceInfo);
+    void applyDeferredCalls();
     void setCleaningResources(bool cleaningResources) { m_cleaningResources = cleaningResources; }
     bool cleaningResources() const { return m_cleaningResources; }
     bool doHostedWebAppRelaunch(const QString& launchParams);
@@ -196,6 +209,7 @@ protected:
     QString m_launchParams;
     QString m_loadErrorPolicy;
     ObserverList<WebPageObserver> m_observers;
+    JsInjectionQueue m_injectionQueue;
 
 private:
     void setBackgroundColorOfBody(const QString& color);
@@ -203,6 +217,8 @@ private:
 
     bool m_cleaningResources;
     bool m_isPreload;
+    QString m_deferredLanguage;
+    QStringList m_deferredDeviceInfo;
 };
 
 #endif // WEBPAGEBASE_H
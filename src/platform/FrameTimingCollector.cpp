@@ -0,0 +1,141 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "FrameTimingCollector.h"
+
+#include <algorithm>
+
+#include <QJsonArray>
+
+// Intervals over one and a half 60 Hz frames missed at least one vsync
+static const int64_t kJankIntervalUs = 25000;
+// Longer intervals are a window with nothing to draw, not a slow frame
+static const int64_t kIdleGapUs = 500000;
+
+FrameTimingCollector::FrameTimingCollector()
+    : m_swapCount(0)
+    , m_phase(Launch)
+    , m_launchStartUs(0)
+    , m_launchEndUs(0)
+{
+    resetStats(m_stats[Launch]);
+    resetStats(m_stats[Steady]);
+}
+
+void FrameTimingCollector::resetStats(Stats& stats)
+{
+    std::fill(stats.buckets, stats.buckets + kBucketCount, 0);
+    stats.frames = 0;
+    stats.jank = 0;
+    stats.idleGaps = 0;
+    stats.totalUs = 0;
+    stats.maxIntervalUs = 0;
+}
+
+void FrameTimingCollector::startLaunch(int64_t nowUs)
+{
+    // A relaunch or revive starts over, the previous swaps are not part of it
+    m_phase = Launch;
+    m_launchStartUs = nowUs;
+    m_launchEndUs = 0;
+    m_swapCount = 0;
+    resetStats(m_stats[Launch]);
+}
+
+void FrameTimingCollector::endLaunch()
+{
+    if (m_phase != Launch)
+        return;
+
+    m_phase = Steady;
+    m_launchEndUs = lastSwapUs();
+}
+
+int64_t FrameTimingCollector::lastSwapUs() const
+{
+    return m_swapCount ? m_swapUs[(m_swapCount - 1) % kRingSize] : 0;
+}
+
+void FrameTimingCollector::frameSwapped(int64_t nowUs)
+{
+    if (!m_launchStartUs)
+        m_launchStartUs = nowUs;
+
+    Stats& stats = m_stats[m_phase];
+    int64_t previousUs = lastSwapUs();
+    m_swapUs[m_swapCount++ % kRingSize] = nowUs;
+    if (!previousUs)
+        return;
+
+    int64_t intervalUs = nowUs - previousUs;
+    if (intervalUs >= kIdleGapUs) {
+        stats.idleGaps++;
+        return;
+    }
+
+    stats.buckets[std::min<int64_t>(intervalUs / 1000, kBucketCount - 1)]++;
+    stats.frames++;
+    stats.totalUs += intervalUs;
+    stats.maxIntervalUs = std::max(stats.maxIntervalUs, intervalUs);
+    if (intervalUs > kJankIntervalUs)
+        stats.jank++;
+}
+
+QJsonObject FrameTimingCollector::statsToJson(const Stats& stats)
+{
+    QJsonObject result;
+    result["frames"] = static_cast<int>(stats.frames);
+    result["jank"] = static_cast<int>(stats.jank);
+    result["idleGaps"] = static_cast<int>(stats.idleGaps);
+    if (!stats.frames)
+        return result;
+
+    // Upper bound of the bucket, the last bucket is open so its max is used
+    uint32_t p95Rank = (stats.frames * 95 + 99) / 100;
+    uint32_t seen = 0;
+    double p95 = stats.maxIntervalUs / 1000.0;
+    for (int i = 0; i < kBucketCount - 1; i++) {
+        seen += stats.buckets[i];
+        if (seen >= p95Rank) {
+            p95 = std::min<double>(i + 1, p95);
+            break;
+        }
+    }
+
+    result["p95FrameTime"] = p95;
+    result["meanFrameTime"] = stats.totalUs / 1000.0 / stats.frames;
+    result["maxFrameTime"] = stats.maxIntervalUs / 1000.0;
+    return result;
+}
+
+QJsonObject FrameTimingCollector::toJson() const
+{
+    QJsonObject launch = statsToJson(m_stats[Launch]);
+    if (m_launchEndUs)
+        launch["duration"] = (m_launchEndUs - m_launchStartUs) / 1000.0;
+
+    QJsonArray recent;
+    unsigned first = m_swapCount > kRingSize ? m_swapCount - kRingSize : 0;
+    for (unsigned i = first + 1; i < m_swapCount; i++)
+        recent.append((m_swapUs[i % kRingSize] - m_swapUs[(i - 1) % kRingSize]) / 1000.0);
+
+    QJsonObject result;
+    result["phase"] = m_phase == Launch ? QStringLiteral("launch") : QStringLiteral("steady");
+    result["launch"] = launch;
+    result["steady"] = statsToJson(m_stats[Steady]);
+    result["recentFrameTimes"] = recent;
+    return result;
+}
@@ -0,0 +1,73 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef FRAMETIMINGCOLLECTOR_H
+#define FRAMETIMINGCOLLECTOR_H
+
+#include <stdint.h>
+
+#include <QJsonObject>
+
+// Frame swap timing of one app window. Swap times go to a ring and the
+// intervals between them are counted in 1 ms buckets, separately for the
+// launch (until the window goes quiet for the launch finish timeout) and
+// for the steady state after it. Recording a swap is a few stores.
+class FrameTimingCollector {
+public:
+    enum Phase {
+        Launch,
+        Steady,
+        PhaseCount
+    };
+
+    FrameTimingCollector();
+
+    void startLaunch(int64_t nowUs);
+    // The launch ends with the last swap before the window went quiet
+    void endLaunch();
+    void frameSwapped(int64_t nowUs);
+
+    Phase phase() const { return m_phase; }
+    int64_t lastSwapUs() const;
+
+    QJsonObject toJson() const;
+
+private:
+    static const int kRingSize = 64;
+    static const int kBucketCount = 101;
+
+    struct Stats {
+        uint32_t buckets[kBucketCount];
+        uint32_t frames;
+        uint32_t jank;
+        uint32_t idleGaps;
+        int64_t totalUs;
+        int64_t maxIntervalUs;
+    };
+
+    static void resetStats(Stats& stats);
+    static QJsonObject statsToJson(const Stats& stats);
+
+    int64_t m_swapUs[kRingSize];
+    unsigned m_swapCount;
+
+    Phase m_phase;
+    int64_t m_launchStartUs;
+    int64_t m_launchEndUs;
+    Stats m_stats[PhaseCount];
+};
+
+#endif // FRAMETIMINGCOLLECTOR_H
@@ -0,0 +1,120 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "InputLatencyTracker.h"
+
+#include <glib.h>
+
+#include "LogManager.h"
+#include "MainLoopWatchdog.h"
+#include "Metrics.h"
+
+static const int64_t kInputLatencyBucketsMs[] = { 8, 16, 33, 50, 100, 150, 250, 500, 1000 };
+static const int kInputLatencyBucketsMsCount = sizeof(kInputLatencyBucketsMs) / sizeof(kInputLatencyBucketsMs[0]);
+
+static const int64_t kSlowInputUs = 100000;
+// Input that changes nothing on screen gets no frame of its own
+static const int64_t kMaxInputLatencyUs = 1000000;
+
+static const char* const kInputTypeNames[] = {
+    "key",
+    "mouseButton",
+    "wheel"
+};
+
+InputLatencyTracker::InputLatencyTracker()
+    : m_receivedUs(0)
+    , m_dispatchedUs(0)
+    , m_type(Key)
+    , m_coalesced(0)
+{
+}
+
+void InputLatencyTracker::inputReceived(InputType type)
+{
+    gint64 now = g_get_monotonic_time();
+    if (m_receivedUs && now - m_receivedUs > kMaxInputLatencyUs)
+        dropPending();
+
+    if (m_receivedUs) {
+        m_coalesced++;
+        return;
+    }
+
+    m_receivedUs = now;
+    m_dispatchedUs = 0;
+    m_type = type;
+    m_coalesced = 0;
+}
+
+void InputLatencyTracker::inputDispatched()
+{
+    if (!m_receivedUs || m_dispatchedUs)
+        return;
+
+    static Histogram* s_dispatchLatency = Metrics::histogram("wam_input_dispatch_latency_us",
+        "Input events from their arrival in WAM to the web contents",
+        Metrics::kLatencyBucketsUs, Metrics::kLatencyBucketsUsCount);
+
+    m_dispatchedUs = g_get_monotonic_time();
+    s_dispatchLatency->observe(m_dispatchedUs - m_receivedUs);
+}
+
+void InputLatencyTracker::inputFiltered()
+{
+    // Only the event being timed, coalesced events were not
+    if (m_receivedUs && !m_dispatchedUs)
+        m_receivedUs = 0;
+}
+
+void InputLatencyTracker::dropPending()
+{
+    static Counter* s_withoutFrame = Metrics::counter("wam_input_events_without_frame_total",
+        "Input events with no frame swapped within a second");
+    s_withoutFrame->increment();
+    m_receivedUs = 0;
+}
+
+void InputLatencyTracker::frameSwapped(const QString& appId)
+{
+    if (!m_receivedUs || !m_dispatchedUs)
+        return;
+
+    gint64 now = g_get_monotonic_time();
+    int64_t latencyUs = now - m_receivedUs;
+    if (latencyUs > kMaxInputLatencyUs) {
+        dropPending();
+        return;
+    }
+
+    // One histogram for all apps, the app of a slow event is in its log
+    static Histogram* s_latency = Metrics::histogram("wam_input_latency_ms", "Input events from their arrival in WAM to the next frame",
+        kInputLatencyBucketsMs, kInputLatencyBucketsMsCount);
+    s_latency->observe(latencyUs / 1000);
+
+    if (latencyUs >= kSlowInputUs) {
+        int callbackUs = 0;
+        const char* callback = MainLoopWatchdog::slowestCallbackSince(m_receivedUs, &callbackUs);
+        LOG_INFO_LIMITED(MSGID_SLOW_INPUT_EVENT, 6, PMLOGKS("APP_ID", qPrintable(appId)),
+            PMLOGKS("TYPE", kInputTypeNames[m_type]),
+            PMLOGKFV("LATENCY_MS", "%d", static_cast<int>(latencyUs / 1000)),
+            PMLOGKFV("DISPATCH_MS", "%d", static_cast<int>((m_dispatchedUs - m_receivedUs) / 1000)),
+            PMLOGKS("CALLBACK", callback ? callback : "untagged"),
+            PMLOGKFV("CALLBACK_MS", "%d", callbackUs / 1000), "coalesced %d", m_coalesced);
+    }
+
+    m_receivedUs = 0;
+}
@@ -0,0 +1,56 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef INPUTLATENCYTRACKER_H
+#define INPUTLATENCYTRACKER_H
+
+#include <stdint.h>
+
+#include <QString>
+
+// Input to frame latency of one window. The oldest input event without a
+// frame yet is timed from its arrival in WAM, through its dispatch to the
+// web contents, to the next frame swap of the window; events arriving in
+// between are coalesced into it. Latencies of all apps go to one histogram,
+// and slow events are logged with their app and the slowest main loop
+// callback in between.
+class InputLatencyTracker {
+public:
+    enum InputType {
+        Key,
+        MouseButton,
+        Wheel,
+        InputTypeCount
+    };
+
+    InputLatencyTracker();
+
+    void inputReceived(InputType type);
+    void inputDispatched();
+    // Filtered by WAM, never reaches the page
+    void inputFiltered();
+    void frameSwapped(const QString& appId);
+
+private:
+    void dropPending();
+
+    int64_t m_receivedUs;
+    int64_t m_dispatchedUs;
+    InputType m_type;
+    int m_coalesced;
+};
+
+#endif // INPUTLATENCYTRACKER_H
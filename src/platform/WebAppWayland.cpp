@@ -19,8 +19,14 @@
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonArray>
 
+#include <glib.h>
+
 #include "ApplicationDescription.h"
+#include "LaunchTimeline.h"
 #include "LogManager.h"
+#include "MainLoopWatchdog.h"
+#include "WebAppManager.h"
+#include "WebAppManagerConfig.h"
 #include "WebAppWaylandWindow.h"
 #include "WebPageBase.h"
 #include "WindowTypes.h"
@@ -48,6 +54,7 @@ WebAppWayland::WebAppWayland(QString type, int width, int height)
     , m_enableInputRegion(false)
     , m_isFocused(false)
     , m_vkbHeight(0)
+    , m_firstFrameMarked(false)
     , m_lostFocusBySetWindowProperty(false)
 {
     init(width, height);
@@ -61,6 +68,7 @@ WebAppWayland::WebAppWayland(QString type, WebAppWaylandWindow* window, int widt
     , m_enableInputRegion(false)
     , m_isFocused(false)
     , m_vkbHeight(0)
+    , m_firstFrameMarked(false)
     , m_lostFocusBySetWindowProperty(false)
 {
     init(width, height);
@@ -102,7 +110,13 @@ void WebAppWayland::init(int width, int height)
 
 void WebAppWayland::startLaunchTimer()
 {
-    if(!getHiddenWindow()) {
+    m_firstFrameMarked = false;
+    if (getHiddenWindow())
+        return;
+
+    // Launch frames are always timed, the launch time check only if enabled
+    m_frameTiming.startLaunch(g_get_monotonic_time());
+    if (WebAppManager::instance()->config()->isCheckLaunchTimeEnabled()) {
         LOG_DEBUG("APP_LAUNCHTIME_CHECK_STARTED [appId:%s]", qPrintable(appId()));
         m_elapsedLaunchTimer.start();
     }
@@ -110,21 +124,44 @@ void WebAppWayland::startLaunchTimer()
 
 void WebAppWayland::onDelegateWindowFrameSwapped()
 {
+    if (!m_firstFrameMarked) {
+        LaunchTimeline::mark(instanceId(), LaunchTimeline::PhaseFirstFrameSwapped);
+        m_firstFrameMarked = true;
+    }
+
+    // Going quiet for the launch finish timeout ends the launch frames,
+    // also when the launch time check is off
+    gint64 now = g_get_monotonic_time();
+    if (m_frameTiming.phase() == FrameTimingCollector::Launch && m_frameTiming.lastSwapUs()
+        && now - m_frameTiming.lastSwapUs() >= kLaunchFinishAssureTimeoutMs * 1000LL)
+        m_frameTiming.endLaunch();
+    m_frameTiming.frameSwapped(now);
+
     if(m_elapsedLaunchTimer.isRunning()) {
         m_lastSwappedTime = m_elapsedLaunchTimer.elapsed_ms();
 
-        m_launchTimeoutTimer.stop();
-        m_launchTimeoutTimer.start(kLaunchFinishAssureTimeoutMs,
-                                   this,
-                                   &WebAppWayland::onLaunchTimeout);
+        // One deadline for the launch, onLaunchTimeout() moves it past the
+        // last swap instead of restarting the timer on every frame
+        if (!m_launchTimeoutTimer.isRunning())
+            m_launchTimeoutTimer.start(kLaunchFinishAssureTimeoutMs,
+                                       this,
+                                       &WebAppWayland::onLaunchTimeout);
     }
 }
 
 void WebAppWayland::onLaunchTimeout()
 {
     if(m_elapsedLaunchTimer.isRunning()) {
-        m_launchTimeoutTimer.stop();
+        int quietMs = static_cast<int>((g_get_monotonic_time() - m_frameTiming.lastSwapUs()) / 1000);
+        if (quietMs < kLaunchFinishAssureTimeoutMs) {
+            m_launchTimeoutTimer.start(kLaunchFinishAssureTimeoutMs - quietMs,
+                                       this,
+                                       &WebAppWayland::onLaunchTimeout);
+            return;
+        }
+
         m_elapsedLaunchTimer.stop();
+        m_frameTiming.endLaunch();
         LOG_DEBUG("APP_LAUNCHTIME_CHECK_ALL_FRAMES_DONE [appId:%s time:%d]", qPrintable(appId()), m_lastSwappedTime);
     }
 }
@@ -489,6 +526,7 @@ void WebAppWayland::goBackground()
 
 void WebAppWayland::webPageLoadFinishedSlot()
 {
+    WatchdogScope watchdogScope("WebAppWayland::webPageLoadFinishedSlot");
     if (getHiddenWindow())
         return;
     if(needReload()) {
@@ -496,6 +534,7 @@ void WebAppWayland::webPageLoadFinishedSlot()
         setNeedReload(false);
         return;
     }
+    LaunchTimeline::mark(instanceId(), LaunchTimeline::PhaseLoadFinished);
 
     QString logUrl = truncateURL(page()->url().toString());
     LOG_INFO_WITH_CLOCK(MSGID_APP_LOADED, 5,
@@ -510,6 +549,7 @@ void WebAppWayland::webPageLoadFinishedSlot()
 
 void WebAppWayland::webPageLoadFailedSlot(int errorCode)
 {
+    WatchdogScope watchdogScope("WebAppWayland::webPageLoadFailedSlot");
     // Do not load error page while preoload app launching.
     if (preloadState() != NONE_PRELOAD)
         closeAppInternal();
@@ -564,6 +604,7 @@ void WebAppWayland::showWindow()
 
 void WebAppWayland::showWindowSlot()
 {
+    WatchdogScope watchdogScope("WebAppWayland::showWindowSlot");
     showWindow();
 }
 
@@ -575,6 +616,7 @@ void WebAppWayland::titleChanged()
 void WebAppWayland::firstFrameVisuallyCommitted()
 {
     LOG_INFO(MSGID_WAM_DEBUG, 2, PMLOGKS("APP_ID", qPrintable(appId())), PMLOGKFV("PID", "%d", page()->getWebProcessPID()), "firstFrameVisuallyCommitted");
+    LaunchTimeline::mark(instanceId(), LaunchTimeline::PhaseVisuallyCommitted);
     // if m_preloadState != NONE_PRELOAD, then we must ignore the first frame commit
     // if getHiddenWindow() == true, then we have specifically requested that the window is to be hidden,
     // and therefore we have to do an explicit show
@@ -602,6 +644,7 @@ void WebAppWayland::navigationHistoryChanged()
 
 void WebAppWayland::webViewRecreatedSlot()
 {
+    WatchdogScope watchdogScope("WebAppWayland::webViewRecreatedSlot");
     m_appWindow->attachWebContents(page()->getWebContents());
     m_appWindow->RecreatedWebContents();
     page()->setPageProperties();
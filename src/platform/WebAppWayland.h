@@ -17,6 +17,7 @@
 #ifndef WEBAPPWAYLAND_H
 #define WEBAPPWAYLAND_H
 
+#include "FrameTimingCollector.h"
 #include "Timer.h"
 #include "WebAppBase.h"
 
@@ -83,6 +84,7 @@ public:
     void deleteSurfaceGroup() override;
     void keyboardVisibilityChanged(bool visible, int height) override;
     void doClose() override;
+    QJsonObject frameTiming() const override { return m_frameTiming.toJson(); }
 
     // WebAppWayland
     virtual void setKeyMask(webos::WebOSKeyMask keyMask, bool value);
@@ -137,6 +139,9 @@ private:
 
     ElapsedTimer m_elapsedLaunchTimer;
     OneShotTimer<WebAppWayland> m_launchTimeoutTimer;
+    FrameTimingCollector m_frameTiming;
+    // The first swap of the current launch is in the launch timeline
+    bool m_firstFrameMarked;
 
     bool m_lostFocusBySetWindowProperty;
 };
@@ -127,6 +127,7 @@ bool WebAppWaylandWindow::event(WebOSEvent* event)
         return true;
 
     logEventDebugging(event);
+    bool timed = trackInputEvent(event);
 
     // TODO: Implement each event handler and
     // remove above event() function used for qtwebengine.
@@ -150,8 +151,8 @@ bool WebAppWaylandWindow::event(WebOSEvent* event)
             m_webApp->stateAboutToChange(GetWindowHostStateAboutToChange());
             return true;
         case WebOSEvent::Swap:
-            if (m_webApp->isCheckLaunchTimeEnabled())
-                m_webApp->onDelegateWindowFrameSwapped();
+            m_inputLatency.frameSwapped(m_webApp->appId());
+            m_webApp->onDelegateWindowFrameSwapped();
             break;
         case WebOSEvent::KeyPress:
             break;
@@ -160,15 +161,16 @@ bool WebAppWaylandWindow::event(WebOSEvent* event)
         case WebOSEvent::MouseButtonPress:
             m_lastMouseEvent.SetType(WebOSEvent::MouseButtonPress);
             m_lastMouseEvent.SetFlags(event->GetFlags());
-            return onCursorVisibileChangeEvent(event);
+            return onCursorVisibileChangeEvent(event, timed);
         case WebOSEvent::MouseButtonRelease:
             m_lastMouseEvent.SetType(WebOSEvent::MouseButtonRelease);
         case WebOSEvent::MouseMove:
-            return onCursorVisibileChangeEvent(event);
+            return onCursorVisibileChangeEvent(event, timed);
         case WebOSEvent::Wheel:
             if (!m_cursorEnabled) {
                 // if magic is disabled, then all mouse event should be filtered
                 // but this wheel event is not related to cursor visibility
+                m_inputLatency.inputFiltered();
                 return true;
             }
             break;
@@ -213,6 +215,8 @@ bool WebAppWaylandWindow::event(WebOSEvent* event)
             break;
     }
 
+    if (timed)
+        m_inputLatency.inputDispatched();
     return WebAppWindowDelegate::event(event);
 }
 
@@ -259,15 +263,19 @@ void WebAppWaylandWindow::onWindowStateChangeEvent()
     }
 }
 
-bool WebAppWaylandWindow::onCursorVisibileChangeEvent(WebOSEvent* e)
+bool WebAppWaylandWindow::onCursorVisibileChangeEvent(WebOSEvent* e, bool timed)
 {
     if (!m_cursorEnabled) {
         if (cursorVisible())
             setCursorVisible(false);
+        if (timed)
+            m_inputLatency.inputFiltered();
         return true;
     }
 
     // This event is not handled, so keep the event being dispatched.
+    if (timed)
+        m_inputLatency.inputDispatched();
     return false;
 }
 
@@ -292,13 +300,13 @@ void WebAppWaylandWindow::logEventDebugging(WebOSEvent* event)
        if (event->GetType() == WebOSEvent::MouseMove) {
            if (m_cursorEnabled) {
                // log all mouse move events
-               LOG_INFO(MSGID_MOUSE_MOVE_EVENT, 3,
+               LOG_INFO_LIMITED(MSGID_MOUSE_MOVE_EVENT, 3,
                     PMLOGKS("APP_ID", qPrintable(m_webApp->appId())),
                     PMLOGKFV("X", "%.f", static_cast<WebOSMouseEvent*>(event)->GetX()),
                     PMLOGKFV("Y", "%.f", static_cast<WebOSMouseEvent*>(event)->GetY()), "");
             }
             else {
-                LOG_INFO(MSGID_MOUSE_MOVE_EVENT, 1,
+                LOG_INFO_LIMITED(MSGID_MOUSE_MOVE_EVENT, 1,
                     PMLOGKS("APP_ID", qPrintable(m_webApp->appId())),
                     "Mouse event should be Disabled by blank cursor");
             }
@@ -308,20 +316,20 @@ void WebAppWaylandWindow::logEventDebugging(WebOSEvent* event)
     if (LogManager::getDebugEventsEnabled()) {
         if (event->GetType() == WebOSEvent::KeyPress || event->GetType() == WebOSEvent::KeyRelease) {
             // remote key event
-            LOG_INFO(MSGID_KEY_EVENT, 3,
+            LOG_INFO_LIMITED(MSGID_KEY_EVENT, 3,
                 PMLOGKS("APP_ID", qPrintable(m_webApp->appId())),
                 PMLOGKFV("VALUE_HEX", "%x", static_cast<WebOSKeyEvent*>(event)->GetCode()),
                 PMLOGKS("STATUS", event->GetType() == WebOSEvent::KeyPress ? "KeyPress" : "KeyRelease"), "");
         }
         else if (event->GetType() == WebOSEvent::MouseButtonPress || event->GetType() == WebOSEvent::MouseButtonRelease) {
             if (!m_cursorEnabled) {
-                LOG_INFO(MSGID_MOUSE_BUTTON_EVENT, 1,
+                LOG_INFO_LIMITED(MSGID_MOUSE_BUTTON_EVENT, 1,
                     PMLOGKS("APP_ID", qPrintable(m_webApp->appId())),
                     "Mouse event should be Disabled by blank cursor");
             }
             else {
                 // mouse button event
-                LOG_INFO(MSGID_MOUSE_BUTTON_EVENT, 3,
+                LOG_INFO_LIMITED(MSGID_MOUSE_BUTTON_EVENT, 3,
                     PMLOGKS("APP_ID", qPrintable(m_webApp->appId())),
                     PMLOGKFV("VALUE", "%d", (int)static_cast<WebOSMouseEvent*>(event)->GetButton()),
                     PMLOGKS("STATUS", event->GetType() == WebOSEvent::MouseButtonPress ? "MouseButtonPress" : "MouseButtonRelease"), "");
@@ -330,13 +338,34 @@ void WebAppWaylandWindow::logEventDebugging(WebOSEvent* event)
         else if (event->GetType() != WebOSEvent::MouseMove) {
             // log all window event except mouseMove
             // to print mouseMove event, set mouseMove : true
-            LOG_INFO(MSGID_WINDOW_EVENT, 2,
+            LOG_INFO_LIMITED(MSGID_WINDOW_EVENT, 2,
                 PMLOGKS("APP_ID", qPrintable(m_webApp->appId())),
                 PMLOGKFV("TYPE", "%d", event->GetType()), "");
         }
     }
 }
 
+// Returns whether the event is timed, only those are dispatched or filtered
+bool WebAppWaylandWindow::trackInputEvent(WebOSEvent* event)
+{
+    // Mouse moves are left out, the cursor is drawn without a page frame
+    switch (event->GetType()) {
+        case WebOSEvent::KeyPress:
+        case WebOSEvent::KeyRelease:
+            m_inputLatency.inputReceived(InputLatencyTracker::Key);
+            return true;
+        case WebOSEvent::MouseButtonPress:
+        case WebOSEvent::MouseButtonRelease:
+            m_inputLatency.inputReceived(InputLatencyTracker::MouseButton);
+            return true;
+        case WebOSEvent::Wheel:
+            m_inputLatency.inputReceived(InputLatencyTracker::Wheel);
+            return true;
+        default:
+            return false;
+    }
+}
+
 void WebAppWaylandWindow::sendKeyCode(int keyCode)
 {
     if (!m_xinputActivated) {
@@ -17,6 +17,8 @@
 #ifndef WEBAPPWAYLANDWINDOW_H
 #define WEBAPPWAYLANDWINDOW_H
 
+#include "InputLatencyTracker.h"
+
 #include "webos/webapp_window_base.h"
 
 class WebAppWayland;
@@ -57,9 +59,10 @@ protected:
 
 private:
     void onWindowStateChangeEvent();
-    bool onCursorVisibileChangeEvent(WebOSEvent* e);
+    bool onCursorVisibileChangeEvent(WebOSEvent* e, bool timed);
     static WebAppWaylandWindow* createWindow();
     void logEventDebugging(WebOSEvent* event);
+    bool trackInputEvent(WebOSEvent* event);
 
 private:
     static WebAppWaylandWindow* s_instance;
@@ -71,6 +74,7 @@ private:
     bool m_xinputActivated;
 
     WebOSMouseEvent m_lastMouseEvent;
+    InputLatencyTracker m_inputLatency;
 };
 
 #endif
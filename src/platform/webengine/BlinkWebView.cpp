@@ -56,32 +56,20 @@ void BlinkWebView::setDelegate(WebPageBlinkDelegate* delegate)
 
 void BlinkWebView::HandleBrowserControlCommand(const std::string& command, const std::vector<std::string>& arguments)
 {
-    if (m_delegate) {
-        QString message = QString::fromStdString(command);
-        QStringList params;
-        Q_FOREACH (const std::string& arg, arguments)
-             params << QString::fromStdString(arg);
-        m_delegate->handleBrowserControlCommand(message, params);
-    }
+    if (m_delegate)
+        m_delegate->handleBrowserControlCommand(command, arguments);
 }
 
 void BlinkWebView::HandleBrowserControlFunction(const std::string& command, const std::vector<std::string>& arguments, std::string* result)
 {
-    if (m_delegate) {
-        QString message = QString::fromStdString(command);
-        QStringList params;
-        Q_FOREACH (const std::string& arg, arguments)
-            params << QString::fromStdString(arg);
-        QString ret;
-        m_delegate->handleBrowserControlFunction(message, params, &ret);
-        *result = ret.toStdString();
-    }
+    if (m_delegate)
+        m_delegate->handleBrowserControlFunction(command, arguments, result);
 }
 
 void BlinkWebView::OnLoadProgressChanged(double progress)
 {
     m_progress = (int)(progress * 100);
-    LOG_INFO(MSGID_PAGE_LOADING, 1, PMLOGKS("", ""), "PROGRESS: %d%%", m_progress);
+    LOG_INFO_LIMITED(MSGID_PAGE_LOADING, 1, PMLOGKS("", ""), "PROGRESS: %d%%", m_progress);
 }
 
 void BlinkWebView::Close()
@@ -15,135 +15,337 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "LogManager.h"
+#include "Metrics.h"
 #include "PalmSystemBlink.h"
 #include "WebAppBase.h"
 #include "WebAppWayland.h"
+#include "WebAppManagerTracer.h"
 #include "WebPageBlink.h"
 
+#include <stdlib.h>
+
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QJsonObject>
 #include <QtCore/QJsonDocument>
-#include <QtCore/QDataStream>
 
 PalmSystemBlink::PalmSystemBlink(WebAppBase* app)
     : PalmSystemWebOS(app)
 {
 }
 
-QString PalmSystemBlink::handleBrowserControlMessage(const QString& message, const QStringList& params)
-{
-    if (message == "initialize") {
-        return initialize().toJson();
-    } else if (message == "country") {
-        return country();
-    } else if (message == "locale") {
-        return locale();
-    } else if (message == "localeRegion") {
-        return localeRegion();
-    } else if (message == "isMinimal") {
-        if(isMinimal())
-            return QString("true");
-        else
-            return QString("false");
-    } else if (message == "identifier") {
-        return identifier();
-    } else if (message == "screenOrientation") {
-        return screenOrientation();
-    } else if (message == "currentCountryGroup") {
-        return getDeviceInfo("CountryGroup");
-    } else if (message == "stageReady") {
-        stageReady();
-    } else if (message == "containerReady") {
-        setContainerAppReady(m_app->appId());
-    } else if (message == "activate") {
-        LOG_INFO(MSGID_PALMSYSTEM, 2, PMLOGKS("APP_ID", qPrintable(m_app->appId())), PMLOGKFV("PID", "%d", m_app->page()->getWebProcessPID()), "PalmSystem.activate()");
-        activate();
-    } else if (message == "deactivate") {
-        LOG_INFO(MSGID_PALMSYSTEM, 2, PMLOGKS("APP_ID", qPrintable(m_app->appId())), PMLOGKFV("PID", "%d", m_app->page()->getWebProcessPID()), "PalmSystem.deactivate()");
-        deactivate();
-    } else if (message == "isActivated") {
-        if(isActivated())
-            return QString("true");
-        else
-            return QString("false");
-    } else if (message == "isKeyboardVisible") {
-        if(isKeyboardVisible())
-            return QString("true");
-        else
-            return QString("false");
-    } else if (message == "getIdentifier" || message == "identifier") {
-        return QString(identifier().toUtf8());
-    } else if (message == "launchParams") {
-        LOG_INFO(MSGID_PALMSYSTEM, 2, PMLOGKS("APP_ID", qPrintable(m_app->appId())), PMLOGKFV("PID", "%d", m_app->page()->getWebProcessPID()), "PalmSystem.launchParams Updated by app; %s", qPrintable(params[0]));
-        updateLaunchParams(params[0]);
-    } else if (message == "screenOrientation") {
-        QByteArray res;
-        QDataStream out(res);
-        out << QVariant(screenOrientation());
-        return QString(res);
-    } else if (message == "keepAlive") {
-        if (params.size() > 0)
-            setKeepAlive(params[0] == "true");
-    } else if (message == "PmLogInfoWithClock") {
-        if (params.size() == 3)
-            pmLogInfoWithClock(params[0], params[1], params[2]);
-    } else if (message == "PmLogString") {
-        if (params.size() > 3)
-            pmLogString(static_cast<PmLogLevel>(params[0].toInt()), params[1], params[2], params[3]);
-    } else if (message == "setWindowProperty") {
-        if (params.size() > 1) {
-            LOG_INFO(MSGID_PALMSYSTEM, 2, PMLOGKS("APP_ID", qPrintable(m_app->appId())), PMLOGKFV("PID", "%d", m_app->page()->getWebProcessPID()),
-                "PalmSystem.window.setProperty('%s', '%s')", qPrintable(params[0]), qPrintable(params[1]));
-            m_app->setWindowProperty(params[0], params[1]);
-        }
-    } else if (message == "platformBack") {
-        LOG_INFO(MSGID_PALMSYSTEM, 2, PMLOGKS("APP_ID", qPrintable(m_app->appId())), PMLOGKFV("PID", "%d", m_app->page()->getWebProcessPID()), "PalmSystem.platformBack()");
-        m_app->platformBack();
-    } else if (message == "setCursor") {
-        QVariant v1, v2, v3;
-        v1 = params.at(0);
-        v2 = params.at(1);
-        v3 = params.at(2);
-        m_app->setCursor(v1.toString(), v2.toInt(), v3.toInt());
-    } else if (message == "setInputRegion") {
-        QByteArray data;
-        for (int i = 0; i < params.count(); i++) {
-            data.append(params.at(i));
-        }
-        setInputRegion(data);
-    } else if (message == "setKeyMask") {
-        QByteArray data;
-        for (int i = 0; i < params.count(); i++) {
-            data.append(params.at(i));
-        }
-        setGroupClientEnvironment(KeyMask, data);
-    } else if (message == "focusOwner") {
-        setGroupClientEnvironment(FocusOwner, NULL);
-    } else if (message == "focusLayer") {
-        setGroupClientEnvironment(FocusLayer, NULL);
-    } else if (message == "hide") {
-        hide();
-    } else if (message == "setLoadErrorPolicy") {
-        if (params.size() > 0) {
-            LOG_INFO(MSGID_PALMSYSTEM, 2, PMLOGKS("APP_ID", qPrintable(m_app->appId())), PMLOGKFV("PID", "%d", m_app->page()->getWebProcessPID()), "PalmSystem.setLoadErrorPolicy(%s)", qPrintable(params[0]));
-            setLoadErrorPolicy(params[0]);
-        }
-    } else if (message == "onCloseNotify") {
-        if (params.size() > 0) {
-            LOG_INFO(MSGID_PALMSYSTEM, 2, PMLOGKS("APP_ID", qPrintable(m_app->appId())), PMLOGKFV("PID", "%d", m_app->page()->getWebProcessPID()), "PalmSystem.onCloseNotify(%s)", qPrintable(params[0]));
-            onCloseNotify(params[0]);
-        }
-    } else if (message == "cursorVisibility") {
-        return cursorVisibility() ? "true" : "false";
-    } else if (message == "serviceCall") {
-        if (m_app->page()->isClosing()) {
-          LOG_INFO(MSGID_PALMSYSTEM, 2, PMLOGKS("APP_ID", qPrintable(m_app->appId())), PMLOGKFV("PID", "%d", m_app->page()->getWebProcessPID()), "PalmSystem.serviceCall(%s, %s)", qPrintable(params[0]), qPrintable(params[1]));
-          m_app->serviceCall(params[0], params[1], m_app->appId());
-        } else {
-            LOG_WARNING(MSGID_SERVICE_CALL_FAIL, 2, PMLOGKS("APP_ID", qPrintable(m_app->appId())),
-              PMLOGKS("URL", qPrintable(params[0])), "Page is NOT in closing");
-        }
+// Command names are matched with a switch on a compile-time FNV-1a hash.
+// Case labels must be unique, so a hash collision between two commands is
+// a build error and every known command is resolved with one comparison.
+static constexpr uint32_t commandHash(const char* name, uint32_t hash = 2166136261u)
+{
+    return *name ? commandHash(name + 1, (hash ^ static_cast<uint8_t>(*name)) * 16777619u) : hash;
+}
+
+static uint32_t commandHash(const std::string& name)
+{
+    uint32_t hash = 2166136261u;
+    for (std::string::const_iterator it = name.begin(); it != name.end(); ++it)
+        hash = (hash ^ static_cast<uint8_t>(*it)) * 16777619u;
+    return hash;
+}
+
+// The one list of PalmSystem commands: name, id, minimum argument count and
+// handler. The enum, the command table and the lookup switch are expanded
+// from it.
+#define BROWSER_CONTROL_COMMANDS(X) \
+    X("initialize", Initialize, 0, handleInitialize) \
+    X("country", Country, 0, handleCountry) \
+    X("locale", Locale, 0, handleLocale) \
+    X("localeRegion", LocaleRegion, 0, handleLocaleRegion) \
+    X("isMinimal", IsMinimal, 0, handleIsMinimal) \
+    X("identifier", Identifier, 0, handleIdentifier) \
+    X("screenOrientation", ScreenOrientation, 0, handleScreenOrientation) \
+    X("currentCountryGroup", CurrentCountryGroup, 0, handleCurrentCountryGroup) \
+    X("stageReady", StageReady, 0, handleStageReady) \
+    X("containerReady", ContainerReady, 0, handleContainerReady) \
+    X("activate", Activate, 0, handleActivate) \
+    X("deactivate", Deactivate, 0, handleDeactivate) \
+    X("isActivated", IsActivated, 0, handleIsActivated) \
+    X("isKeyboardVisible", IsKeyboardVisible, 0, handleIsKeyboardVisible) \
+    X("getIdentifier", GetIdentifier, 0, handleIdentifier) \
+    X("launchParams", LaunchParams, 1, handleLaunchParams) \
+    X("keepAlive", KeepAlive, 1, handleKeepAlive) \
+    X("PmLogInfoWithClock", PmLogInfoWithClock, 3, handlePmLogInfoWithClock) \
+    X("PmLogString", PmLogString, 4, handlePmLogString) \
+    X("setWindowProperty", SetWindowProperty, 2, handleSetWindowProperty) \
+    X("platformBack", PlatformBack, 0, handlePlatformBack) \
+    X("setCursor", SetCursor, 3, handleSetCursor) \
+    X("setInputRegion", SetInputRegion, 0, handleSetInputRegion) \
+    X("setKeyMask", SetKeyMask, 0, handleSetKeyMask) \
+    X("focusOwner", FocusOwner, 0, handleFocusOwner) \
+    X("focusLayer", FocusLayer, 0, handleFocusLayer) \
+    X("hide", Hide, 0, handleHide) \
+    X("setLoadErrorPolicy", SetLoadErrorPolicy, 1, handleSetLoadErrorPolicy) \
+    X("onCloseNotify", OnCloseNotify, 1, handleOnCloseNotify) \
+    X("cursorVisibility", CursorVisibility, 0, handleCursorVisibility) \
+    X("serviceCall", ServiceCall, 2, handleServiceCall)
+
+enum BrowserControlCommand {
+#define COMMAND_ENUM(NAME, ID, ARGS, HANDLER) Cmd##ID,
+    BROWSER_CONTROL_COMMANDS(COMMAND_ENUM)
+#undef COMMAND_ENUM
+    CmdCount,
+    CmdUnknown = CmdCount
+};
+
+const PalmSystemBlink::CommandEntry PalmSystemBlink::s_commands[] = {
+#define COMMAND_ENTRY(NAME, ID, ARGS, HANDLER) { NAME, ARGS, &PalmSystemBlink::HANDLER },
+    BROWSER_CONTROL_COMMANDS(COMMAND_ENTRY)
+#undef COMMAND_ENTRY
+};
+
+int BrowserControlArgs::toInt(int i) const
+{
+    return static_cast<int>(strtol(m_args[i].c_str(), NULL, 10));
+}
+
+int PalmSystemBlink::lookupCommand(const std::string& name)
+{
+    int command = CmdUnknown;
+
+#define COMMAND_CASE(NAME, ID, ARGS, HANDLER) case commandHash(NAME): command = Cmd##ID; break;
+    switch (commandHash(name)) {
+        BROWSER_CONTROL_COMMANDS(COMMAND_CASE)
+        default:
+            break;
+    }
+#undef COMMAND_CASE
+
+    // The hash only selects the candidate, an unknown name may share it
+    if (command != CmdUnknown && name != s_commands[command].name)
+        command = CmdUnknown;
+    return command;
+}
+
+QString PalmSystemBlink::handleBrowserControlMessage(const std::string& message, const std::vector<std::string>& params)
+{
+    TRACE_EVENT_SCOPE("PalmSystem", "command", message.c_str());
+
+    QElapsedTimer timer;
+    timer.start();
+
+    int command = lookupCommand(message);
+    QString result;
+
+    if (command == CmdUnknown) {
+        LOG_DEBUG("[%s] Unknown PalmSystem command: %s", qPrintable(m_app->appId()), message.c_str());
+    } else if (static_cast<int>(params.size()) < s_commands[command].minArgs) {
+        LOG_WARNING(MSGID_PALMSYSTEM, 2, PMLOGKS("APP_ID", qPrintable(m_app->appId())), PMLOGKS("COMMAND", message.c_str()),
+            "Not enough arguments; %d given", static_cast<int>(params.size()));
+    } else {
+        BrowserControlArgs args(params);
+        result = (this->*s_commands[command].handler)(args);
     }
 
+    // Per command, the set of commands is fixed unlike the set of apps
+    const char* commandName = command < CmdCount ? s_commands[command].name : "unknown";
+    static Histogram* s_latency[CmdCount + 1];
+    if (!s_latency[command])
+        s_latency[command] = Metrics::histogram("wam_palmsystem_command_duration_us", "PalmSystem command handling time",
+            Metrics::kLatencyBucketsUs, Metrics::kLatencyBucketsUsCount, "command", commandName);
+    s_latency[command]->observe(timer.nsecsElapsed() / 1000);
+
+    static Counter* s_calls[CmdCount + 1];
+    if (!s_calls[command])
+        s_calls[command] = Metrics::counter("wam_palmsystem_calls_total", "PalmSystem commands called", "command", commandName);
+    s_calls[command]->increment();
+
+    return result;
+}
+
+QString PalmSystemBlink::handleInitialize(const BrowserControlArgs& args)
+{
+    return initialize().toJson();
+}
+
+QString PalmSystemBlink::handleCountry(const BrowserControlArgs& args)
+{
+    return country();
+}
+
+QString PalmSystemBlink::handleLocale(const BrowserControlArgs& args)
+{
+    return locale();
+}
+
+QString PalmSystemBlink::handleLocaleRegion(const BrowserControlArgs& args)
+{
+    return localeRegion();
+}
+
+QString PalmSystemBlink::handleIsMinimal(const BrowserControlArgs& args)
+{
+    return isMinimal() ? QStringLiteral("true") : QStringLiteral("false");
+}
+
+QString PalmSystemBlink::handleIdentifier(const BrowserControlArgs& args)
+{
+    return identifier();
+}
+
+QString PalmSystemBlink::handleScreenOrientation(const BrowserControlArgs& args)
+{
+    return screenOrientation();
+}
+
+QString PalmSystemBlink::handleCurrentCountryGroup(const BrowserControlArgs& args)
+{
+    return getDeviceInfo("CountryGroup");
+}
+
+QString PalmSystemBlink::handleStageReady(const BrowserControlArgs& args)
+{
+    stageReady();
+    return QString();
+}
+
+QString PalmSystemBlink::handleContainerReady(const BrowserControlArgs& args)
+{
+    setContainerAppReady(m_app->appId());
+    return QString();
+}
+
+QString PalmSystemBlink::handleActivate(const BrowserControlArgs& args)
+{
+    LOG_INFO(MSGID_PALMSYSTEM, 2, PMLOGKS("APP_ID", qPrintable(m_app->appId())), PMLOGKFV("PID", "%d", m_app->page()->getWebProcessPID()), "PalmSystem.activate()");
+    activate();
+    return QString();
+}
+
+QString PalmSystemBlink::handleDeactivate(const BrowserControlArgs& args)
+{
+    LOG_INFO(MSGID_PALMSYSTEM, 2, PMLOGKS("APP_ID", qPrintable(m_app->appId())), PMLOGKFV("PID", "%d", m_app->page()->getWebProcessPID()), "PalmSystem.deactivate()");
+    deactivate();
+    return QString();
+}
+
+QString PalmSystemBlink::handleIsActivated(const BrowserControlArgs& args)
+{
+    return isActivated() ? QStringLiteral("true") : QStringLiteral("false");
+}
+
+QString PalmSystemBlink::handleIsKeyboardVisible(const BrowserControlArgs& args)
+{
+    return isKeyboardVisible() ? QStringLiteral("true") : QStringLiteral("false");
+}
+
+QString PalmSystemBlink::handleLaunchParams(const BrowserControlArgs& args)
+{
+    LOG_INFO_LIMITED(MSGID_PALMSYSTEM, 2, PMLOGKS("APP_ID", qPrintable(m_app->appId())), PMLOGKFV("PID", "%d", m_app->page()->getWebProcessPID()), "PalmSystem.launchParams Updated by app; %s", args.at(0).c_str());
+    updateLaunchParams(args.string(0));
+    return QString();
+}
+
+QString PalmSystemBlink::handleKeepAlive(const BrowserControlArgs& args)
+{
+    setKeepAlive(args.isTrue(0));
+    return QString();
+}
+
+QString PalmSystemBlink::handlePmLogInfoWithClock(const BrowserControlArgs& args)
+{
+    // Apps use this with exactly msgid, perfType and perfGroup
+    if (args.size() == 3)
+        pmLogInfoWithClock(args.string(0), args.string(1), args.string(2));
+    return QString();
+}
+
+QString PalmSystemBlink::handlePmLogString(const BrowserControlArgs& args)
+{
+    pmLogString(static_cast<PmLogLevel>(args.toInt(0)), args.string(1), args.string(2), args.string(3));
+    return QString();
+}
+
+QString PalmSystemBlink::handleSetWindowProperty(const BrowserControlArgs& args)
+{
+    LOG_INFO_LIMITED(MSGID_PALMSYSTEM, 2, PMLOGKS("APP_ID", qPrintable(m_app->appId())), PMLOGKFV("PID", "%d", m_app->page()->getWebProcessPID()),
+        "PalmSystem.window.setProperty('%s', '%s')", args.at(0).c_str(), args.at(1).c_str());
+    m_app->setWindowProperty(args.string(0), args.string(1));
+    return QString();
+}
+
+QString PalmSystemBlink::handlePlatformBack(const BrowserControlArgs& args)
+{
+    LOG_INFO(MSGID_PALMSYSTEM, 2, PMLOGKS("APP_ID", qPrintable(m_app->appId())), PMLOGKFV("PID", "%d", m_app->page()->getWebProcessPID()), "PalmSystem.platformBack()");
+    m_app->platformBack();
+    return QString();
+}
+
+QString PalmSystemBlink::handleSetCursor(const BrowserControlArgs& args)
+{
+    m_app->setCursor(args.string(0), args.toInt(1), args.toInt(2));
+    return QString();
+}
+
+QString PalmSystemBlink::handleSetInputRegion(const BrowserControlArgs& args)
+{
+    QByteArray data;
+    for (int i = 0; i < args.size(); i++)
+        data.append(args.at(i).data(), args.at(i).size());
+    setInputRegion(data);
+    return QString();
+}
+
+QString PalmSystemBlink::handleSetKeyMask(const BrowserControlArgs& args)
+{
+    QByteArray data;
+    for (int i = 0; i < args.size(); i++)
+        data.append(args.at(i).data(), args.at(i).size());
+    setGroupClientEnvironment(KeyMask, data);
+    return QString();
+}
+
+QString PalmSystemBlink::handleFocusOwner(const BrowserControlArgs& args)
+{
+    setGroupClientEnvironment(FocusOwner, NULL);
+    return QString();
+}
+
+QString PalmSystemBlink::handleFocusLayer(const BrowserControlArgs& args)
+{
+    setGroupClientEnvironment(FocusLayer, NULL);
+    return QString();
+}
+
+QString PalmSystemBlink::handleHide(const BrowserControlArgs& args)
+{
+    hide();
+    return QString();
+}
+
+QString PalmSystemBlink::handleSetLoadErrorPolicy(const BrowserControlArgs& args)
+{
+    LOG_INFO(MSGID_PALMSYSTEM, 2, PMLOGKS("APP_ID", qPrintable(m_app->appId())), PMLOGKFV("PID", "%d", m_app->page()->getWebProcessPID()), "PalmSystem.setLoadErrorPolicy(%s)", args.at(0).c_str());
+    setLoadErrorPolicy(args.string(0));
+    return QString();
+}
+
+QString PalmSystemBlink::handleOnCloseNotify(const BrowserControlArgs& args)
+{
+    LOG_INFO(MSGID_PALMSYSTEM, 2, PMLOGKS("APP_ID", qPrintable(m_app->appId())), PMLOGKFV("PID", "%d", m_app->page()->getWebProcessPID()), "PalmSystem.onCloseNotify(%s)", args.at(0).c_str());
+    onCloseNotify(args.string(0));
+    return QString();
+}
+
+QString PalmSystemBlink::handleCursorVisibility(const BrowserControlArgs& args)
+{
+    return cursorVisibility() ? QStringLiteral("true") : QStringLiteral("false");
+}
+
+QString PalmSystemBlink::handleServiceCall(const BrowserControlArgs& args)
+{
+    if (m_app->page()->isClosing()) {
+        LOG_INFO_LIMITED(MSGID_PALMSYSTEM, 2, PMLOGKS("APP_ID", qPrintable(m_app->appId())), PMLOGKFV("PID", "%d", m_app->page()->getWebProcessPID()), "PalmSystem.serviceCall(%s, %s)", args.at(0).c_str(), args.at(1).c_str());
+        m_app->serviceCall(args.string(0), args.string(1), m_app->appId());
+    } else {
+        LOG_WARNING(MSGID_SERVICE_CALL_FAIL, 2, PMLOGKS("APP_ID", qPrintable(m_app->appId())),
+          PMLOGKS("URL", args.at(0).c_str()), "Page is NOT in closing");
+    }
     return QString();
 }
 
@@ -19,11 +19,38 @@
 
 #include "PalmSystemWebOS.h"
 
+#include <string>
+#include <vector>
+
+#include <QByteArray>
+#include <QJsonObject>
+
+// Read-only view of the arguments of a PalmSystem browser control call.
+// Arguments stay in the std::string vector coming from the engine and are
+// converted only when a handler reads them.
+class BrowserControlArgs {
+public:
+    explicit BrowserControlArgs(const std::vector<std::string>& args)
+        : m_args(args)
+    {
+    }
+
+    int size() const { return static_cast<int>(m_args.size()); }
+    const std::string& at(int i) const { return m_args[i]; }
+    QString string(int i) const { return QString::fromStdString(m_args[i]); }
+    QByteArray bytes(int i) const { return QByteArray::fromRawData(m_args[i].data(), m_args[i].size()); }
+    int toInt(int i) const;
+    bool isTrue(int i) const { return m_args[i] == "true"; }
+
+private:
+    const std::vector<std::string>& m_args;
+};
+
 class PalmSystemBlink : public PalmSystemWebOS {
 public:
     PalmSystemBlink(WebAppBase* app);
 
-    QString handleBrowserControlMessage(const QString& message, const QStringList& params);
+    QString handleBrowserControlMessage(const std::string& message, const std::vector<std::string>& params);
 
     // PalmSystemWebOS
     void setCountry() override;
@@ -40,6 +67,49 @@ protected:
 
     virtual QString trustLevel() const;
     virtual void onCloseNotify(const QString& params);
+
+private:
+    typedef QString (PalmSystemBlink::*CommandHandler)(const BrowserControlArgs& args);
+
+    struct CommandEntry {
+        const char* name;
+        int minArgs;
+        CommandHandler handler;
+    };
+
+    static const CommandEntry s_commands[];
+    static int lookupCommand(const std::string& name);
+
+    QString handleInitialize(const BrowserControlArgs& args);
+    QString handleCountry(const BrowserControlArgs& args);
+    QString handleLocale(const BrowserControlArgs& args);
+    QString handleLocaleRegion(const BrowserControlArgs& args);
+    QString handleIsMinimal(const BrowserControlArgs& args);
+    QString handleIdentifier(const BrowserControlArgs& args);
+    QString handleScreenOrientation(const BrowserControlArgs& args);
+    QString handleCurrentCountryGroup(const BrowserControlArgs& args);
+    QString handleStageReady(const BrowserControlArgs& args);
+    QString handleContainerReady(const BrowserControlArgs& args);
+    QString handleActivate(const BrowserControlArgs& args);
+    QString handleDeactivate(const BrowserControlArgs& args);
+    QString handleIsActivated(const BrowserControlArgs& args);
+    QString handleIsKeyboardVisible(const BrowserControlArgs& args);
+    QString handleLaunchParams(const BrowserControlArgs& args);
+    QString handleKeepAlive(const BrowserControlArgs& args);
+    QString handlePmLogInfoWithClock(const BrowserControlArgs& args);
+    QString handlePmLogString(const BrowserControlArgs& args);
+    QString handleSetWindowProperty(const BrowserControlArgs& args);
+    QString handlePlatformBack(const BrowserControlArgs& args);
+    QString handleSetCursor(const BrowserControlArgs& args);
+    QString handleSetInputRegion(const BrowserControlArgs& args);
+    QString handleSetKeyMask(const BrowserControlArgs& args);
+    QString handleFocusOwner(const BrowserControlArgs& args);
+    QString handleFocusLayer(const BrowserControlArgs& args);
+    QString handleHide(const BrowserControlArgs& args);
+    QString handleSetLoadErrorPolicy(const BrowserControlArgs& args);
+    QString handleOnCloseNotify(const BrowserControlArgs& args);
+    QString handleCursorVisibility(const BrowserControlArgs& args);
+    QString handleServiceCall(const BrowserControlArgs& args);
 };
 
 #endif // PALMSYSTEMBLINK_H_
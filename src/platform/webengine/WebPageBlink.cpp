@@ -24,11 +24,16 @@
 #include <QtCore/QUrlQuery>
 #include <QTextStream>
 
+#include "AppCloseStatistics.h"
 #include "ApplicationDescription.h"
 #include "BlinkWebProcessManager.h"
 #include "BlinkWebView.h"
+#include "FlightRecorder.h"
 #include "LogManager.h"
+#include "MainLoopWatchdog.h"
+#include "Metrics.h"
 #include "PalmSystemBlink.h"
+#include "WebAppManager.h"
 #include "WebAppManagerConfig.h"
 #include "WebAppManagerTracer.h"
 #include "WebPageObserver.h"
@@ -38,8 +43,6 @@
  * public API
  */
 
-static const int kExecuteCloseCallbackTimeOutMs = 10000;
-
 QString getHostname(const std::string& url)
 {
   // Convert given url to QURL and
@@ -182,17 +185,17 @@ void* WebPageBlink::getWebContents()
     return (void*)d->pageView->GetWebContents();
 }
 
-void WebPageBlink::handleBrowserControlCommand(const QString& command, const QStringList& arguments)
+void WebPageBlink::handleBrowserControlCommand(const std::string& command, const std::vector<std::string>& arguments)
 {
     handleBrowserControlMessage(command, arguments);
 }
 
-void WebPageBlink::handleBrowserControlFunction(const QString& command, const QStringList& arguments, QString* result)
+void WebPageBlink::handleBrowserControlFunction(const std::string& command, const std::vector<std::string>& arguments, std::string* result)
 {
-    *result = handleBrowserControlMessage(command, arguments);
+    *result = handleBrowserControlMessage(command, arguments).toStdString();
 }
 
-QString WebPageBlink::handleBrowserControlMessage(const QString& message, const QStringList& params)
+QString WebPageBlink::handleBrowserControlMessage(const std::string& message, const std::vector<std::string>& params)
 {
     if (!d->m_palmSystem)
         return QString();
@@ -373,6 +376,16 @@ void WebPageBlink::setLaunchParams(const QString& params)
         d->m_palmSystem->setLaunchParams(params);
 }
 
+void WebPageBlink::reloadForLaunch()
+{
+    // Drop the webOSLaunch script of the previous launch, load() adds a new one
+    setupStaticUserScripts();
+    setCustomUserScript();
+    if (d->m_palmSystem)
+        d->m_palmSystem->setInitialized(false);
+    WebPageBase::reloadForLaunch();
+}
+
 void WebPageBlink::setUseLaunchOptimization(bool enabled){
     if (getWebAppManagerConfig()->isLaunchOptimizationEnabled())
         d->pageView->SetUseLaunchOptimization(enabled);
@@ -400,12 +413,17 @@ void WebPageBlink::setForceActivateVtg(bool enabled)
 
 void WebPageBlink::suspendWebPageAll()
 {
+    TRACE_EVENT_SCOPE("WebPageBlink::suspendWebPageAll", "appId", qPrintable(appId()));
     LOG_INFO(MSGID_SUSPEND_WEBPAGE, 2, PMLOGKS("APP_ID", qPrintable(appId())), PMLOGKFV("PID", "%d", getWebProcessPID()), "%s", __func__);
 
     d->pageView->SetVisible(false);
     if (m_isSuspended || m_enableBackgroundRun)
         return;
 
+    static Counter* s_suspends = Metrics::counter("wam_page_suspends_total", "Web pages suspended");
+    s_suspends->increment();
+    FlightRecorder::record(FlightRecorder::Suspend, appId(), getWebProcessPID());
+
     if (!(qgetenv("WAM_KEEP_RTC_CONNECTIONS_ON_SUSPEND") == "1")) {
         // On sending applications to background, disconnect RTC
         d->pageView->DropAllPeerConnections(webos::DROP_PEER_CONNECTION_REASON_PAGE_HIDDEN);
@@ -432,6 +450,9 @@ void WebPageBlink::suspendWebPageAll()
     }
 
     m_isSuspended = true;
+    // Deliver queued scripts in one batch on resume instead of waking the page,
+    // whether or not its DOM gets suspended as well
+    m_injectionQueue.setHeld(true);
     if (shouldStopJSOnSuspend()) {
         m_domSuspendTimer.start(suspendDelay(), this,
                             &WebPageBlink::suspendWebPagePaintingAndJSExecution);
@@ -441,7 +462,9 @@ void WebPageBlink::suspendWebPageAll()
 
 void WebPageBlink::resumeWebPageAll()
 {
+    TRACE_EVENT_SCOPE("WebPageBlink::resumeWebPageAll", "appId", qPrintable(appId()));
     LOG_INFO(MSGID_RESUME_ALL, 2, PMLOGKS("APP_ID", qPrintable(appId())), PMLOGKFV("PID", "%d", getWebProcessPID()), "");
+    FlightRecorder::record(FlightRecorder::Resume, appId(), getWebProcessPID());
     // resume painting
     // Resume DOM and JS Excution
     // set visibility : visible (dispatch visibilitychange event)
@@ -449,6 +472,8 @@ void WebPageBlink::resumeWebPageAll()
     if (shouldStopJSOnSuspend()) {
         resumeWebPagePaintingAndJSExecution();
     }
+    m_isSuspended = false;
+    m_injectionQueue.setHeld(false);
     resumeWebPageMedia();
     d->pageView->SetVisible(true);
 }
@@ -487,6 +512,7 @@ void WebPageBlink::resumeWebPageMedia()
 
 void WebPageBlink::suspendWebPagePaintingAndJSExecution()
 {
+    WatchdogScope watchdogScope("WebPageBlink::suspendWebPagePaintingAndJSExecution");
     LOG_INFO(MSGID_SUSPEND_WEBPAGE, 2, PMLOGKS("APP_ID", qPrintable(appId())), PMLOGKFV("PID", "%d", getWebProcessPID()), "%s; m_isSuspended : %s", __func__, m_isSuspended ? "true" : "false; will be returned");
     if (m_domSuspendTimer.isRunning()) {
         LOG_INFO(MSGID_SUSPEND_WEBPAGE_DELAYED, 2, PMLOGKS("APP_ID", qPrintable(appId())), PMLOGKFV("PID", "%d", getWebProcessPID()), "DomSuspendTimer Expired; suspend DOM");
@@ -526,6 +552,7 @@ void WebPageBlink::resumeWebPagePaintingAndJSExecution()
             LOG_INFO(MSGID_RESUME_WEBPAGE, 2, PMLOGKS("APP_ID", qPrintable(appId())), PMLOGKFV("PID", "%d", getWebProcessPID()), "DONE");
         }
         m_isSuspended = false;
+        m_injectionQueue.setHeld(false);
     }
 }
 
@@ -559,7 +586,7 @@ void WebPageBlink::updateExtensionData(const QString& key, const QString& value)
     ).arg(escapeData(key)).arg(escapeData(value));
     LOG_INFO(MSGID_PALMSYSTEM, 2, PMLOGKS("APP_ID", qPrintable(appId())), PMLOGKFV("PID", "%d", getWebProcessPID()), "Update; key:%s; value:%s",
         qPrintable(key), qPrintable(value));
-    evaluateJavaScript(eventJS);
+    postJavaScript(QStringLiteral("injectionData:") + key, eventJS);
 }
 
 void WebPageBlink::updatePageSettings()
@@ -599,11 +626,18 @@ void WebPageBlink::handleDeviceInfoChanged(const QString& deviceInfo)
 
 void WebPageBlink::evaluateJavaScript(const QString& jsCode)
 {
+    // Queued scripts were posted earlier, keep them in order. A held
+    // mailbox stays held for its one delivery on resume, so a direct
+    // script, e.g. the close callback, runs ahead of it then.
+    if (!m_injectionQueue.isHeld())
+        m_injectionQueue.flush();
     d->pageView->RunJavaScript(jsCode.toStdString());
 }
 
 void WebPageBlink::evaluateJavaScriptInAllFrames(const QString &script, const char *method)
 {
+    if (!m_injectionQueue.isHeld())
+        m_injectionQueue.flush();
     d->pageView->RunJavaScriptInAllFrames(script.toStdString());
 }
 
@@ -617,6 +651,7 @@ void WebPageBlink::cleanResources()
 
 void WebPageBlink::close()
 {
+    WatchdogScope watchdogScope("WebPageBlink::close");
     Q_EMIT webPageClosePageRequested();
 }
 
@@ -633,6 +668,7 @@ void WebPageBlink::didDropAllPeerConnections()
 
 void WebPageBlink::loadFinished(const std::string& url)
 {
+    WatchdogScope watchdogScope("WebPageBlink::loadFinished");
     LOG_INFO(MSGID_WEBPAGE_LOAD_FINISHED, 2,
         PMLOGKS("APP_ID", qPrintable(appId())),
         PMLOGKFV("PID", "%d", getWebProcessPID()),
@@ -653,6 +689,7 @@ void WebPageBlink::loadFinished(const std::string& url)
 
 void WebPageBlink::loadStarted()
 {
+    WatchdogScope watchdogScope("WebPageBlink::loadStarted");
     LOG_INFO(MSGID_PAGE_LOADING, 3, PMLOGKS("APP_ID", qPrintable(appId())), PMLOGKFV("PID", "%d", getWebProcessPID()),  PMLOGKS("LOADING", "STARTED"), "");
     m_hasCloseCallback = false;
     handleLoadStarted();
@@ -665,6 +702,7 @@ void WebPageBlink::loadStopped(const std::string& url)
 
 void WebPageBlink::loadFailed(const std::string& url, int errCode, const std::string& errDesc)
 {
+    WatchdogScope watchdogScope("WebPageBlink::loadFailed");
     Q_EMIT webPageLoadFailed(errCode);
 
     // We follow through only if we have SSL error
@@ -734,8 +772,10 @@ void WebPageBlink::recreateWebView()
         setVisibilityState(WebPageBase::WebPageVisibilityState::WebPageVisibilityStateLaunching);
     }
 
-    if (m_isSuspended)
+    if (m_isSuspended) {
         m_isSuspended = false;
+        m_injectionQueue.setHeld(false);
+    }
 }
 
 void WebPageBlink::setVisible(bool visible)
@@ -757,6 +797,10 @@ void WebPageBlink::notifyMemoryPressure(webos::WebViewBase::MemoryPressureLevel
 
 void WebPageBlink::renderProcessCrashed()
 {
+    WatchdogScope watchdogScope("WebPageBlink::renderProcessCrashed");
+    static Counter* s_crashes = Metrics::counter("wam_render_process_crashes_total", "Render process crashes seen by web pages");
+    s_crashes->increment();
+
     LOG_INFO(MSGID_WEBPROC_CRASH, 2, PMLOGKS("APP_ID", qPrintable(appId())), PMLOGKFV("PID", "%d", getWebProcessPID()), "m_isSuspended : %s", m_isSuspended?"true":"false");
     if (isClosing()) {
         LOG_INFO(MSGID_WEBPROC_CRASH, 2, PMLOGKS("APP_ID", qPrintable(appId())), PMLOGKFV("PID", "%d", getWebProcessPID()), "In Closing; return");
@@ -943,6 +987,10 @@ int WebPageBlink::renderProcessPid() const
 void WebPageBlink::didRunCloseCallback()
 {
     m_closeCallbackTimer.stop();
+    if (m_closeCallbackElapsedTimer.isRunning()) {
+        WebAppManager::instance()->closeStatistics()->addCloseCallbackSample(appId(), m_closeCallbackElapsedTimer.elapsed_ms(), false);
+        m_closeCallbackElapsedTimer.stop();
+    }
     LOG_INFO(MSGID_WAM_DEBUG, 2, PMLOGKS("APP_ID", qPrintable(appId())), PMLOGKFV("PID", "%d", getWebProcessPID()), "WebPageBlink::didRunCloseCallback(); onclose callback done");
     Q_EMIT closeCallbackExecuted();
 }
@@ -959,12 +1007,19 @@ void WebPageBlink::executeCloseCallback(bool forced)
 
     evaluateJavaScript(script);
 
-    m_closeCallbackTimer.start(kExecuteCloseCallbackTimeOutMs, this, &WebPageBlink::timeoutCloseCallback);
+    // The timeout follows how long this app's callback took on previous closes
+    int timeout = WebAppManager::instance()->closeStatistics()->closeCallbackTimeout(appId());
+    m_closeCallbackElapsedTimer.start();
+    m_closeCallbackTimer.start(timeout, this, &WebPageBlink::timeoutCloseCallback);
 }
 
 void WebPageBlink::timeoutCloseCallback()
 {
     m_closeCallbackTimer.stop();
+    if (m_closeCallbackElapsedTimer.isRunning()) {
+        WebAppManager::instance()->closeStatistics()->addCloseCallbackSample(appId(), m_closeCallbackElapsedTimer.elapsed_ms(), true);
+        m_closeCallbackElapsedTimer.stop();
+    }
     LOG_INFO(MSGID_WAM_DEBUG, 2, PMLOGKS("APP_ID", qPrintable(appId())), PMLOGKFV("PID", "%d", getWebProcessPID()), "WebPageBlink::timeoutCloseCallback(); onclose callback Timeout");
     Q_EMIT timeoutExecuteCloseCallback();
 }
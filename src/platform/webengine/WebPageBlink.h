@@ -46,6 +46,7 @@ public:
     void init() override;
     void* getWebContents() override;
     void setLaunchParams(const QString& params) override;
+    void reloadForLaunch() override;
     void notifyMemoryPressure(webos::WebViewBase::MemoryPressureLevel level) override;
     QUrl url() const override;
     void replaceBaseUrl(QUrl newUrl) override;
@@ -165,10 +166,10 @@ protected:
     bool inspectable();
 
     // WebPageDelegate
-    void handleBrowserControlCommand(const QString& command, const QStringList& arguments) override;
-    void handleBrowserControlFunction(const QString& command, const QStringList& arguments, QString* result) override;
+    void handleBrowserControlCommand(const std::string& command, const std::vector<std::string>& arguments) override;
+    void handleBrowserControlFunction(const std::string& command, const std::vector<std::string>& arguments, std::string* result) override;
 
-    QString handleBrowserControlMessage(const QString& message, const QStringList& params);
+    QString handleBrowserControlMessage(const std::string& message, const std::vector<std::string>& params);
 
 protected Q_SLOTS:
     virtual void didFinishLaunchingSlot();
@@ -191,6 +192,7 @@ private:
     bool m_vkbWasOverlap;
     bool m_hasCloseCallback;
     OneShotTimer<WebPageBlink> m_closeCallbackTimer;
+    ElapsedTimer m_closeCallbackElapsedTimer;
     QString m_trustLevel;
     QString m_loadFailedHostname;
 };
@@ -0,0 +1,141 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Turns a dump of BinaryLogger (WAM_BINARY_LOG=<path> or the logControl
+// binaryLog and binaryLogDump keys) back into text, one line per record:
+//   <seconds>.<us> [<thread id>] <level> [<msgid>] <message>
+
+#include <stdio.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "BinaryLogFormat.h"
+
+struct DecodedFormat {
+    int level;
+    std::string msgid;
+    std::string format;
+};
+
+static const char* levelName(int level)
+{
+    // PmLogLevel values
+    switch (level) {
+    case 0: return "EMERG";
+    case 1: return "ALERT";
+    case 2: return "CRIT";
+    case 3: return "ERR";
+    case 4: return "WARNING";
+    case 5: return "NOTICE";
+    case 6: return "INFO";
+    case 7: return "DEBUG";
+    default: return "?";
+    }
+}
+
+static bool readString(FILE* file, std::string& value)
+{
+    uint16_t length;
+    if (fread(&length, sizeof(length), 1, file) != 1)
+        return false;
+    value.resize(length);
+    return !length || fread(&value[0], 1, length, file) == length;
+}
+
+static int decode(FILE* file, FILE* out)
+{
+    char magic[sizeof(BinaryLogFormat::kFileMagic)];
+    if (fread(magic, sizeof(magic), 1, file) != 1 || memcmp(magic, BinaryLogFormat::kFileMagic, sizeof(magic))) {
+        fprintf(stderr, "Not a WAM binary log\n");
+        return 1;
+    }
+
+    std::map<uint16_t, DecodedFormat> formats;
+    std::vector<char> payload;
+    bool truncated = false;
+    int chunk;
+    while ((chunk = fgetc(file)) != EOF) {
+        if (chunk == BinaryLogFormat::ChunkFormat) {
+            uint16_t id;
+            uint8_t level;
+            DecodedFormat format;
+            if (fread(&id, sizeof(id), 1, file) != 1 || fread(&level, sizeof(level), 1, file) != 1
+                || !readString(file, format.msgid) || !readString(file, format.format)) {
+                truncated = true;
+                break;
+            }
+            format.level = level;
+            formats[id] = format;
+        } else if (chunk == BinaryLogFormat::ChunkRecord) {
+            BinaryLogFormat::RecordHeader header;
+            if (fread(&header, sizeof(header), 1, file) != 1) {
+                truncated = true;
+                break;
+            }
+            payload.resize(header.payloadSize);
+            if (header.payloadSize && fread(&payload[0], 1, header.payloadSize, file) != header.payloadSize) {
+                truncated = true;
+                break;
+            }
+
+            std::map<uint16_t, DecodedFormat>::const_iterator it = formats.find(header.formatId);
+            if (it == formats.end()) {
+                fprintf(out, "<unknown format %u>\n", header.formatId);
+                continue;
+            }
+            std::string text = BinaryLogFormat::formatText(it->second.format.c_str(), payload.data(), payload.size());
+            // Debug logs have no msgid
+            fprintf(out, "%llu.%06llu [%u] %s %s%s%s\n",
+                static_cast<unsigned long long>(header.timestampNs / 1000000000ULL),
+                static_cast<unsigned long long>(header.timestampNs % 1000000000ULL / 1000),
+                header.threadId, levelName(it->second.level), it->second.msgid.c_str(),
+                it->second.msgid.empty() ? "" : " ", text.c_str());
+        } else {
+            fprintf(stderr, "Corrupted chunk at offset %ld\n", ftell(file) - 1);
+            return 1;
+        }
+    }
+
+    // A dump cut short by a crash still decodes up to the last full record
+    if (truncated || ferror(file)) {
+        fprintf(stderr, "Truncated record at offset %ld\n", ftell(file));
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <binary log> [<binary log> ...]\n", argv[0]);
+        return 1;
+    }
+
+    int result = 0;
+    for (int i = 1; i < argc; i++) {
+        FILE* file = fopen(argv[i], "rb");
+        if (!file) {
+            fprintf(stderr, "Cannot open %s\n", argv[i]);
+            result = 1;
+            continue;
+        }
+        result |= decode(file, stdout);
+        fclose(file);
+    }
+    return result;
+}
@@ -0,0 +1,577 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Load generator for the WAM luna service. Calls the service methods at a
+// given rate with a bound on calls in flight, keeps listRunningApps
+// subscribers attached, and prints per method latency percentiles, error
+// rates and how long the subscription updates take to reach subscribers:
+//   wam-lunaload --rate=50 --concurrency=8 --subscribers=20 launchApp killApp=2 listRunningApps
+// Runs against the bus of the environment, e.g. a private hub started for
+// the test with WAM registered on it.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <glib.h>
+#include <luna-service2/lunaservice.h>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+static const int kTickMs = 5;
+static const int kDrainTimeoutMs = 5000;
+static const char kLaunchingAppId[] = "com.webos.lunaload";
+
+enum Method {
+    LaunchApp,
+    KillApp,
+    CloseAllApps,
+    ListRunningApps,
+    GetWebProcessSize,
+    ClearBrowsingData,
+    LaunchApps,
+    CloseApps,
+    MethodCount
+};
+
+static const char* const kMethodNames[] = {
+    "launchApp",
+    "killApp",
+    "closeAllApps",
+    "listRunningApps",
+    "getWebProcessSize",
+    "clearBrowsingData",
+    "launchApps",
+    "closeApps"
+};
+
+struct Options {
+    Options()
+        : service("com.palm.webappmanager")
+        , rate(10)
+        , concurrency(4)
+        , durationMs(10000)
+        , apps(4)
+        , subscribers(0)
+    {
+    }
+
+    std::string service;
+    std::string appDescPath;
+    std::string jsonPath;
+    double rate;            // calls per second, 0 issues as fast as concurrency allows
+    int concurrency;
+    int durationMs;
+    int apps;
+    int subscribers;
+    std::vector<Method> schedule;   // methods in issue order, repeated
+};
+
+struct MethodStats {
+    MethodStats()
+        : calls(0)
+        , errors(0)
+    {
+    }
+
+    int calls;
+    int errors;
+    std::vector<double> latencyMs;
+};
+
+class LunaLoad;
+
+struct PendingCall {
+    LunaLoad* load;
+    Method method;
+    gint64 startUs;
+};
+
+struct Subscriber {
+    LunaLoad* load;
+    LSMessageToken token;
+    bool initialReplied;
+};
+
+class LunaLoad {
+public:
+    explicit LunaLoad(const Options& options);
+
+    bool start();
+    void run();
+    void stop();
+    void print() const;
+    bool writeJson(const char* path) const;
+
+private:
+    static gboolean tick(gpointer data);
+    static bool replied(LSHandle* handle, LSMessage* message, void* context);
+    static bool subscriptionUpdated(LSHandle* handle, LSMessage* message, void* context);
+
+    void fill();
+    bool issue(Method method);
+    std::string uri(Method method) const;
+    QJsonObject payload(Method method);
+    QJsonObject launchRequest(const QString& id) const;
+    QString appId(int index) const { return QStringLiteral("%1.app%2").arg(kLaunchingAppId).arg(index); }
+    double elapsedMs() const { return (g_get_monotonic_time() - m_startUs) / 1000.0; }
+
+    Options m_options;
+    QJsonObject m_appDescTemplate;
+    LSHandle* m_handle;
+    GMainLoop* m_loop;
+    std::vector<Subscriber*> m_subscribers;
+
+    gint64 m_startUs;
+    int m_issued;
+    int m_inFlight;
+    int m_callFailures;
+    int m_nextLaunch;
+    int m_nextKill;
+
+    // Send time of the last call that changes the running app list,
+    // subscription updates are measured against it
+    gint64 m_lastChangeUs;
+
+    MethodStats m_stats[MethodCount];
+    std::vector<double> m_fanOutMs;
+};
+
+LunaLoad::LunaLoad(const Options& options)
+    : m_options(options)
+    , m_handle(0)
+    , m_loop(0)
+    , m_startUs(0)
+    , m_issued(0)
+    , m_inFlight(0)
+    , m_callFailures(0)
+    , m_nextLaunch(0)
+    , m_nextKill(0)
+    , m_lastChangeUs(0)
+{
+    m_appDescTemplate["main"] = QStringLiteral("index.html");
+    m_appDescTemplate["folderPath"] = QStringLiteral("/tmp");
+    m_appDescTemplate["defaultWindowType"] = QStringLiteral("card");
+    m_appDescTemplate["trustLevel"] = QStringLiteral("default");
+    m_appDescTemplate["version"] = QStringLiteral("1.0.0");
+}
+
+bool LunaLoad::start()
+{
+    if (!m_options.appDescPath.empty()) {
+        QFile file(QString::fromStdString(m_options.appDescPath));
+        if (!file.open(QIODevice::ReadOnly)) {
+            fprintf(stderr, "Cannot read %s\n", m_options.appDescPath.c_str());
+            return false;
+        }
+        m_appDescTemplate = QJsonDocument::fromJson(file.readAll()).object();
+    }
+
+    LSError lsError;
+    LSErrorInit(&lsError);
+    // WAM methods are on the private bus
+    if (!LSRegisterPubPriv(0, &m_handle, false, &lsError)) {
+        fprintf(stderr, "Cannot register on the bus: %s\n", lsError.message);
+        LSErrorFree(&lsError);
+        return false;
+    }
+
+    m_loop = g_main_loop_new(0, FALSE);
+    if (!LSGmainAttach(m_handle, m_loop, &lsError)) {
+        fprintf(stderr, "Cannot attach to the main loop: %s\n", lsError.message);
+        LSErrorFree(&lsError);
+        return false;
+    }
+
+    std::string subscribeUri = uri(ListRunningApps);
+    for (int i = 0; i < m_options.subscribers; i++) {
+        Subscriber* subscriber = new Subscriber();
+        subscriber->load = this;
+        subscriber->token = LSMESSAGE_TOKEN_INVALID;
+        subscriber->initialReplied = false;
+        if (!LSCall(m_handle, subscribeUri.c_str(), "{\"subscribe\":true}", subscriptionUpdated, subscriber,
+                &subscriber->token, &lsError)) {
+            fprintf(stderr, "Cannot subscribe: %s\n", lsError.message);
+            LSErrorFree(&lsError);
+            delete subscriber;
+            return false;
+        }
+        m_subscribers.push_back(subscriber);
+    }
+    return true;
+}
+
+void LunaLoad::run()
+{
+    m_startUs = g_get_monotonic_time();
+    g_timeout_add(kTickMs, tick, this);
+    g_main_loop_run(m_loop);
+}
+
+void LunaLoad::stop()
+{
+    LSError lsError;
+    LSErrorInit(&lsError);
+    for (size_t i = 0; i < m_subscribers.size(); i++) {
+        if (!LSCallCancel(m_handle, m_subscribers[i]->token, &lsError)) {
+            LSErrorFree(&lsError);
+            LSErrorInit(&lsError);
+        }
+        delete m_subscribers[i];
+    }
+    m_subscribers.clear();
+
+    // Unregistering also drops calls left in flight after the drain timeout
+    if (m_handle && !LSUnregister(m_handle, &lsError))
+        LSErrorFree(&lsError);
+    m_handle = 0;
+
+    if (m_loop)
+        g_main_loop_unref(m_loop);
+    m_loop = 0;
+}
+
+gboolean LunaLoad::tick(gpointer data)
+{
+    LunaLoad* load = static_cast<LunaLoad*>(data);
+    double elapsed = load->elapsedMs();
+
+    if (elapsed < load->m_options.durationMs) {
+        load->fill();
+        return G_SOURCE_CONTINUE;
+    }
+
+    if (load->m_inFlight && elapsed < load->m_options.durationMs + kDrainTimeoutMs)
+        return G_SOURCE_CONTINUE;
+
+    g_main_loop_quit(load->m_loop);
+    return G_SOURCE_REMOVE;
+}
+
+void LunaLoad::fill()
+{
+    if (elapsedMs() >= m_options.durationMs)
+        return;
+
+    // Calls due by now at the configured rate, all of them at rate 0
+    double due = m_options.rate > 0 ? elapsedMs() * m_options.rate / 1000 : m_issued + m_options.concurrency;
+    while (m_issued < due && m_inFlight < m_options.concurrency) {
+        Method method = m_options.schedule[m_issued % m_options.schedule.size()];
+        m_issued++;
+        if (!issue(method))
+            m_callFailures++;
+    }
+}
+
+bool LunaLoad::issue(Method method)
+{
+    PendingCall* call = new PendingCall();
+    call->load = this;
+    call->method = method;
+    call->startUs = g_get_monotonic_time();
+
+    if (method == LaunchApp || method == KillApp || method == CloseAllApps || method == LaunchApps || method == CloseApps)
+        m_lastChangeUs = call->startUs;
+
+    QByteArray body = QJsonDocument(payload(method)).toJson(QJsonDocument::Compact);
+    LSError lsError;
+    LSErrorInit(&lsError);
+    if (!LSCallOneReply(m_handle, uri(method).c_str(), body.constData(), replied, call, 0, &lsError)) {
+        fprintf(stderr, "%s: %s\n", kMethodNames[method], lsError.message);
+        LSErrorFree(&lsError);
+        m_stats[method].calls++;
+        m_stats[method].errors++;
+        delete call;
+        return false;
+    }
+    m_inFlight++;
+    return true;
+}
+
+std::string LunaLoad::uri(Method method) const
+{
+    return "palm://" + m_options.service + "/" + kMethodNames[method];
+}
+
+QJsonObject LunaLoad::launchRequest(const QString& id) const
+{
+    QJsonObject appDesc = m_appDescTemplate;
+    appDesc["id"] = id;
+
+    QJsonObject request;
+    request["appDesc"] = appDesc;
+    request["parameters"] = QJsonObject();
+    request["launchingAppId"] = QString::fromLatin1(kLaunchingAppId);
+    request["launchingProcId"] = QString();
+    return request;
+}
+
+QJsonObject LunaLoad::payload(Method method)
+{
+    QJsonObject request;
+    switch (method) {
+    case LaunchApp:
+        request = launchRequest(appId(m_nextLaunch++ % m_options.apps));
+        break;
+    case KillApp:
+        request["appId"] = appId(m_nextKill++ % m_options.apps);
+        break;
+    // The batch methods launch or close all --apps apps in one call
+    case LaunchApps: {
+        QJsonArray apps;
+        for (int i = 0; i < m_options.apps; i++)
+            apps.append(launchRequest(appId(i)));
+        request["apps"] = apps;
+        break;
+    }
+    case CloseApps: {
+        QJsonArray appIds;
+        for (int i = 0; i < m_options.apps; i++)
+            appIds.append(appId(i));
+        request["appIds"] = appIds;
+        break;
+    }
+    case ListRunningApps:
+        request["includeSysApps"] = true;
+        break;
+    case ClearBrowsingData: {
+        QJsonArray types;
+        types.append(QStringLiteral("cache"));
+        request["types"] = types;
+        break;
+    }
+    default:
+        break;
+    }
+    return request;
+}
+
+bool LunaLoad::replied(LSHandle* handle, LSMessage* message, void* context)
+{
+    PendingCall* call = static_cast<PendingCall*>(context);
+    LunaLoad* load = call->load;
+    MethodStats& stats = load->m_stats[call->method];
+
+    stats.calls++;
+    stats.latencyMs.push_back((g_get_monotonic_time() - call->startUs) / 1000.0);
+
+    // killApp of an app that is not running is an expected failure under a
+    // random mix, it still counts, the rate shows how often it happened
+    QJsonObject reply = QJsonDocument::fromJson(LSMessageGetPayload(message)).object();
+    if (LSMessageIsHubErrorMessage(message) || !reply["returnValue"].toBool(true))
+        stats.errors++;
+
+    load->m_inFlight--;
+    delete call;
+
+    load->fill();
+    return true;
+}
+
+bool LunaLoad::subscriptionUpdated(LSHandle* handle, LSMessage* message, void* context)
+{
+    Subscriber* subscriber = static_cast<Subscriber*>(context);
+    LunaLoad* load = subscriber->load;
+
+    // The first reply answers the subscription itself
+    if (!subscriber->initialReplied) {
+        subscriber->initialReplied = true;
+        return true;
+    }
+
+    if (load->m_lastChangeUs)
+        load->m_fanOutMs.push_back((g_get_monotonic_time() - load->m_lastChangeUs) / 1000.0);
+    return true;
+}
+
+static double percentile(std::vector<double> samples, int percent)
+{
+    if (samples.empty())
+        return 0;
+    std::sort(samples.begin(), samples.end());
+    return samples.at((samples.size() - 1) * percent / 100);
+}
+
+static double maximum(const std::vector<double>& samples)
+{
+    return samples.empty() ? 0 : *std::max_element(samples.begin(), samples.end());
+}
+
+void LunaLoad::print() const
+{
+    double seconds = m_options.durationMs / 1000.0;
+    printf("%-20s %8s %8s %7s %9s %9s %9s %9s\n", "method", "calls", "errors", "err%", "p50 ms", "p90 ms", "p99 ms", "max ms");
+    for (int i = 0; i < MethodCount; i++) {
+        const MethodStats& stats = m_stats[i];
+        if (!stats.calls)
+            continue;
+        printf("%-20s %8d %8d %6.1f%% %9.2f %9.2f %9.2f %9.2f\n", kMethodNames[i], stats.calls, stats.errors,
+            stats.errors * 100.0 / stats.calls, percentile(stats.latencyMs, 50), percentile(stats.latencyMs, 90),
+            percentile(stats.latencyMs, 99), maximum(stats.latencyMs));
+    }
+
+    if (m_options.subscribers) {
+        printf("%-20s %8d updates to %d subscribers %9.2f %9.2f %9.2f %9.2f\n", "fan-out",
+            static_cast<int>(m_fanOutMs.size()), m_options.subscribers,
+            percentile(m_fanOutMs, 50), percentile(m_fanOutMs, 90), percentile(m_fanOutMs, 99), maximum(m_fanOutMs));
+    }
+
+    int answered = 0;
+    for (int i = 0; i < MethodCount; i++)
+        answered += m_stats[i].calls;
+    printf("%d calls issued, %.1f/s answered, %d not sent, %d unanswered\n",
+        m_issued, answered / seconds, m_callFailures, m_inFlight);
+}
+
+bool LunaLoad::writeJson(const char* path) const
+{
+    QJsonArray methods;
+    for (int i = 0; i < MethodCount; i++) {
+        const MethodStats& stats = m_stats[i];
+        if (!stats.calls)
+            continue;
+        QJsonObject method;
+        method["method"] = QString::fromLatin1(kMethodNames[i]);
+        method["calls"] = stats.calls;
+        method["errors"] = stats.errors;
+        method["p50"] = percentile(stats.latencyMs, 50);
+        method["p90"] = percentile(stats.latencyMs, 90);
+        method["p99"] = percentile(stats.latencyMs, 99);
+        method["max"] = maximum(stats.latencyMs);
+        methods.append(method);
+    }
+
+    QJsonObject fanOut;
+    fanOut["subscribers"] = m_options.subscribers;
+    fanOut["updates"] = static_cast<int>(m_fanOutMs.size());
+    fanOut["p50"] = percentile(m_fanOutMs, 50);
+    fanOut["p90"] = percentile(m_fanOutMs, 90);
+    fanOut["p99"] = percentile(m_fanOutMs, 99);
+    fanOut["max"] = maximum(m_fanOutMs);
+
+    QJsonObject result;
+    result["rate"] = m_options.rate;
+    result["concurrency"] = m_options.concurrency;
+    result["duration"] = m_options.durationMs;
+    result["issued"] = m_issued;
+    result["unanswered"] = m_inFlight;
+    result["methods"] = methods;
+    result["fanOut"] = fanOut;
+
+    QFile file(QString::fromLatin1(path));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    file.write(QJsonDocument(result).toJson());
+    return true;
+}
+
+static void usage()
+{
+    fprintf(stderr,
+        "Usage: wam-lunaload [options] <method>[=<weight>]...\n"
+        "  --rate=<calls/s>      calls issued per second, 0 for as many as --concurrency allows (10)\n"
+        "  --concurrency=<n>     calls in flight at most (4)\n"
+        "  --duration=<s>        time to issue calls for (10)\n"
+        "  --apps=<n>            distinct app ids launched and killed (4)\n"
+        "  --app-desc=<file>     app description template for launchApp, \"id\" is set per call\n"
+        "  --subscribers=<n>     listRunningApps subscriptions held during the run (0)\n"
+        "  --service=<name>      service to call (com.palm.webappmanager)\n"
+        "  --json=<file>         also write the results as JSON\n"
+        "Methods: launchApp killApp closeAllApps listRunningApps getWebProcessSize clearBrowsingData\n"
+        "         launchApps closeApps (batches of all --apps apps)\n"
+        "A method with weight N is issued N times per round of the schedule.\n");
+}
+
+static bool parseMethod(const char* arg, std::vector<Method>& schedule)
+{
+    std::string name(arg);
+    int weight = 1;
+    size_t equals = name.find('=');
+    if (equals != std::string::npos) {
+        weight = atoi(name.c_str() + equals + 1);
+        name.resize(equals);
+    }
+
+    for (int i = 0; i < MethodCount; i++) {
+        if (name == kMethodNames[i] && weight > 0) {
+            schedule.insert(schedule.end(), weight, static_cast<Method>(i));
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool parseOptions(int argc, char** argv, Options& options)
+{
+    for (int arg = 1; arg < argc; arg++) {
+        const char* value = strchr(argv[arg], '=');
+        if (!strncmp(argv[arg], "--rate=", 7))
+            options.rate = atof(value + 1);
+        else if (!strncmp(argv[arg], "--concurrency=", 14))
+            options.concurrency = atoi(value + 1);
+        else if (!strncmp(argv[arg], "--duration=", 11))
+            options.durationMs = static_cast<int>(atof(value + 1) * 1000);
+        else if (!strncmp(argv[arg], "--apps=", 7))
+            options.apps = atoi(value + 1);
+        else if (!strncmp(argv[arg], "--app-desc=", 11))
+            options.appDescPath = value + 1;
+        else if (!strncmp(argv[arg], "--subscribers=", 14))
+            options.subscribers = atoi(value + 1);
+        else if (!strncmp(argv[arg], "--service=", 10))
+            options.service = value + 1;
+        else if (!strncmp(argv[arg], "--json=", 7))
+            options.jsonPath = value + 1;
+        else if (!strncmp(argv[arg], "--", 2) || !parseMethod(argv[arg], options.schedule))
+            return false;
+    }
+
+    return !options.schedule.empty() && options.rate >= 0 && options.concurrency > 0
+        && options.durationMs > 0 && options.apps > 0 && options.subscribers >= 0;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        usage();
+        return 2;
+    }
+
+    LunaLoad load(options);
+    if (!load.start()) {
+        load.stop();
+        return 1;
+    }
+
+    load.run();
+    load.print();
+
+    int result = 0;
+    if (!options.jsonPath.empty() && !load.writeJson(options.jsonPath.c_str())) {
+        fprintf(stderr, "Cannot write %s\n", options.jsonPath.c_str());
+        result = 1;
+    }
+
+    load.stop();
+    return result;
+}
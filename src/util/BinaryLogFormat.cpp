@@ -0,0 +1,173 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "BinaryLogFormat.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+const char BinaryLogFormat::kFileMagic[8] = { 'W', 'A', 'M', 'B', 'L', 'O', 'G', '1' };
+
+class PayloadReader {
+public:
+    PayloadReader(const char* payload, size_t size)
+        : m_pos(payload)
+        , m_end(payload + size)
+    {
+    }
+
+    bool next(char& type, uint64_t& number, std::string& text)
+    {
+        if (m_pos >= m_end)
+            return false;
+
+        type = *m_pos++;
+        if (type == BinaryLogFormat::ArgString) {
+            uint16_t length;
+            if (m_end - m_pos < static_cast<ptrdiff_t>(sizeof(length)))
+                return false;
+            memcpy(&length, m_pos, sizeof(length));
+            m_pos += sizeof(length);
+            if (m_end - m_pos < length)
+                return false;
+            text.assign(m_pos, length);
+            m_pos += length;
+            return true;
+        }
+
+        if (m_end - m_pos < static_cast<ptrdiff_t>(sizeof(number)))
+            return false;
+        memcpy(&number, m_pos, sizeof(number));
+        m_pos += sizeof(number);
+        return true;
+    }
+
+private:
+    const char* m_pos;
+    const char* m_end;
+};
+
+std::string BinaryLogFormat::formatText(const char* format, const char* payload, size_t size)
+{
+    PayloadReader reader(payload, size);
+    std::string out;
+    char buffer[512];
+
+    for (const char* p = format; *p; p++) {
+        if (*p != '%') {
+            out += *p;
+            continue;
+        }
+        if (p[1] == '%') {
+            out += '%';
+            p++;
+            continue;
+        }
+
+        // Flags, width and precision are kept, length modifiers are
+        // replaced since every number is stored with 64 bits. A '*' width
+        // or precision was written as an argument of its own and is
+        // replaced by its value, snprintf never sees it.
+        std::string spec("%");
+        const char* q = p + 1;
+        char type;
+        uint64_t number = 0;
+        std::string text;
+        bool missing = false;
+        while (*q && strchr("-+ #0123456789.*", *q)) {
+            if (*q != '*') {
+                spec += *q++;
+                continue;
+            }
+            q++;
+            if (!reader.next(type, number, text) || type == ArgString || type == ArgDouble) {
+                missing = true;
+                continue;
+            }
+            // A negative precision means none, a negative width left aligns
+            long long value = static_cast<long long>(number);
+            if (value < 0 && !spec.empty() && spec[spec.size() - 1] == '.')
+                spec.erase(spec.size() - 1);
+            else
+                spec += std::to_string(std::min(std::max(value, -256LL), 256LL));
+        }
+        while (*q && strchr("hlLqjzt", *q))
+            q++;
+        if (!*q)
+            break;
+        char conversion = *q;
+        p = q;
+
+        if (missing || !reader.next(type, number, text)) {
+            out += "<missing>";
+            continue;
+        }
+
+        switch (conversion) {
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+        case 'c':
+            spec += "ll";
+            spec += conversion;
+            if (type == ArgDouble) {
+                double value;
+                memcpy(&value, &number, sizeof(value));
+                number = static_cast<uint64_t>(static_cast<long long>(value));
+            }
+            if (conversion == 'd' || conversion == 'i')
+                snprintf(buffer, sizeof(buffer), spec.c_str(), static_cast<long long>(number));
+            else if (conversion == 'c')
+                snprintf(buffer, sizeof(buffer), "%c", static_cast<char>(number));
+            else
+                snprintf(buffer, sizeof(buffer), spec.c_str(), static_cast<unsigned long long>(number));
+            out += buffer;
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G': {
+            double value;
+            if (type == ArgDouble)
+                memcpy(&value, &number, sizeof(value));
+            else
+                value = static_cast<double>(static_cast<long long>(number));
+            spec += conversion;
+            snprintf(buffer, sizeof(buffer), spec.c_str(), value);
+            out += buffer;
+            break;
+        }
+        case 's':
+            out += type == ArgString ? text : std::string("<not a string>");
+            break;
+        case 'p':
+            snprintf(buffer, sizeof(buffer), "0x%llx", static_cast<unsigned long long>(number));
+            out += buffer;
+            break;
+        default:
+            out += spec;
+            out += conversion;
+            break;
+        }
+    }
+    return out;
+}
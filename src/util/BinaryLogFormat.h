@@ -0,0 +1,61 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef BINARYLOGFORMAT_H
+#define BINARYLOGFORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+// Layout shared by BinaryLogger and the offline decoder (wam-logdecode).
+//
+// A dump file starts with kFileMagic followed by chunks:
+//   'F' uint16 id, uint8 level, uint16 length, msgid, uint16 length, format
+//   'R' RecordHeader, payload
+// A format chunk always precedes the first record that uses it.
+// The payload is a sequence of arguments, each a type byte followed by
+// 8 bytes for numbers or an uint16 length and the bytes for strings.
+// All values are in host byte order.
+class BinaryLogFormat {
+public:
+    enum ChunkType {
+        ChunkFormat = 'F',
+        ChunkRecord = 'R'
+    };
+
+    enum ArgType {
+        ArgInt = 'i',
+        ArgUInt = 'u',
+        ArgDouble = 'd',
+        ArgString = 's',
+        ArgPointer = 'p'
+    };
+
+    struct RecordHeader {
+        uint16_t formatId;
+        uint16_t payloadSize;
+        uint32_t threadId;
+        uint64_t timestampNs;
+    };
+
+    static const char kFileMagic[8];
+
+    // Expands a printf style format with the arguments of a payload
+    static std::string formatText(const char* format, const char* payload, size_t size);
+};
+
+#endif // BINARYLOGFORMAT_H
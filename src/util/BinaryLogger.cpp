@@ -0,0 +1,422 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "BinaryLogger.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdio.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#include <QJsonObject>
+
+#include "LogManager.h"
+
+static const size_t kRingSize = 64 * 1024;
+static const int kFlushIntervalMs = 50;
+static const size_t kHistoryRecords = 2048;
+static const uint16_t kInvalidFormatId = 0xffff;
+
+// Written by its own thread only (head) and drained by the flush thread (tail).
+// A ring is retired when its thread exits and freed once it is drained.
+struct ThreadRing {
+    explicit ThreadRing(uint32_t id)
+        : threadId(id)
+        , head(0)
+        , tail(0)
+        , dropped(0)
+        , retired(false)
+        , next(0)
+    {
+    }
+
+    uint32_t threadId;
+    std::atomic<uint64_t> head;
+    std::atomic<uint64_t> tail;
+    std::atomic<uint64_t> dropped;
+    std::atomic<bool> retired;
+    ThreadRing* next;
+    char data[kRingSize];
+};
+
+class ThreadRingOwner {
+public:
+    ThreadRingOwner()
+        : ring(0)
+    {
+    }
+
+    ~ThreadRingOwner()
+    {
+        if (ring)
+            ring->retired.store(true, std::memory_order_release);
+    }
+
+    ThreadRing* ring;
+};
+
+struct LogFormat {
+    int level;
+    const char* msgid;
+    const char* format;
+};
+
+struct LogRecord {
+    BinaryLogFormat::RecordHeader header;
+    std::string payload;
+};
+
+std::atomic<bool> BinaryLogger::s_enabled(false);
+
+// Rings are added lock free at the head of the list and only unlinked by
+// drainAll() under s_mutex
+static std::atomic<ThreadRing*> s_rings(0);
+static thread_local ThreadRingOwner t_ringOwner;
+
+// Registration has its own lock so a call site never waits for the flush
+// thread writing the file. Formats are never removed and a deque keeps
+// them in place while more are added.
+static std::mutex s_formatsMutex;
+static std::deque<LogFormat> s_formats;
+
+// Everything below is guarded by s_mutex
+static std::mutex s_mutex;
+static std::condition_variable s_wakeup;
+static std::thread* s_thread = 0;
+static bool s_stopping = false;
+static std::string s_output;
+static bool s_toPmLog = false;
+static FILE* s_file = 0;
+static std::string s_dumpPath;
+static std::vector<bool> s_formatWritten;
+static std::deque<LogRecord> s_history;
+static uint64_t s_recordCount = 0;
+static uint64_t s_bytesWritten = 0;
+static uint64_t s_retiredDropped = 0;
+
+static uint64_t monotonicNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + now.tv_nsec;
+}
+
+static ThreadRing* createThreadRing()
+{
+    ThreadRing* ring = new ThreadRing(static_cast<uint32_t>(syscall(SYS_gettid)));
+    ThreadRing* first = s_rings.load(std::memory_order_relaxed);
+    do {
+        ring->next = first;
+    } while (!s_rings.compare_exchange_weak(first, ring, std::memory_order_release, std::memory_order_relaxed));
+    t_ringOwner.ring = ring;
+    return ring;
+}
+
+static const LogFormat* formatAt(uint16_t id)
+{
+    std::lock_guard<std::mutex> lock(s_formatsMutex);
+    return id < s_formats.size() ? &s_formats[id] : 0;
+}
+
+static void copyToRing(ThreadRing* ring, uint64_t position, const void* data, size_t size)
+{
+    size_t offset = position % kRingSize;
+    size_t first = std::min(size, kRingSize - offset);
+    memcpy(ring->data + offset, data, first);
+    memcpy(ring->data, static_cast<const char*>(data) + first, size - first);
+}
+
+static void copyFromRing(const ThreadRing* ring, uint64_t position, void* data, size_t size)
+{
+    size_t offset = position % kRingSize;
+    size_t first = std::min(size, kRingSize - offset);
+    memcpy(data, ring->data + offset, first);
+    memcpy(static_cast<char*>(data) + first, ring->data, size - first);
+}
+
+static void writeString(FILE* file, const char* value)
+{
+    uint16_t length = static_cast<uint16_t>(strlen(value));
+    fwrite(&length, sizeof(length), 1, file);
+    fwrite(value, 1, length, file);
+}
+
+static void writeFormat(FILE* file, uint16_t id, const LogFormat& format)
+{
+    uint8_t level = static_cast<uint8_t>(format.level);
+    fputc(BinaryLogFormat::ChunkFormat, file);
+    fwrite(&id, sizeof(id), 1, file);
+    fwrite(&level, sizeof(level), 1, file);
+    writeString(file, format.msgid);
+    writeString(file, format.format);
+}
+
+static void writeRecord(FILE* file, const LogRecord& record)
+{
+    fputc(BinaryLogFormat::ChunkRecord, file);
+    fwrite(&record.header, sizeof(record.header), 1, file);
+    fwrite(record.payload.data(), 1, record.payload.size(), file);
+}
+
+static void handleRecord(const LogRecord& record)
+{
+    uint16_t id = record.header.formatId;
+    const LogFormat* entry = formatAt(id);
+    if (!entry)
+        return;
+
+    const LogFormat& format = *entry;
+    if (s_file) {
+        if (id >= s_formatWritten.size())
+            s_formatWritten.resize(id + 1, false);
+        if (!s_formatWritten[id]) {
+            writeFormat(s_file, id, format);
+            s_formatWritten[id] = true;
+        }
+        writeRecord(s_file, record);
+        s_bytesWritten += 1 + sizeof(record.header) + record.payload.size();
+    }
+
+    PmLogLevel level = static_cast<PmLogLevel>(format.level);
+    if (s_toPmLog && isWAMLogEnabled(level)) {
+        std::string text = BinaryLogFormat::formatText(format.format, record.payload.data(), record.payload.size());
+        if (level == kPmLogLevel_Debug)
+            PmLogDebug(GetWAMPmLogContext(), "%s", text.c_str());
+        else
+            PmLogInfo(GetWAMPmLogContext(), format.msgid, 0, "%s", text.c_str());
+    }
+
+    s_history.push_back(record);
+    if (s_history.size() > kHistoryRecords)
+        s_history.pop_front();
+    s_recordCount++;
+}
+
+static void drainRing(ThreadRing* ring)
+{
+    uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+    uint64_t head = ring->head.load(std::memory_order_acquire);
+
+    while (head - tail >= sizeof(BinaryLogFormat::RecordHeader)) {
+        LogRecord record;
+        copyFromRing(ring, tail, &record.header, sizeof(record.header));
+        record.payload.resize(record.header.payloadSize);
+        copyFromRing(ring, tail + sizeof(record.header), &record.payload[0], record.payload.size());
+        tail += sizeof(record.header) + record.payload.size();
+        handleRecord(record);
+    }
+    ring->tail.store(tail, std::memory_order_release);
+}
+
+static void unlinkRing(ThreadRing* ring)
+{
+    // New rings are only pushed at the head, so the head is the only link
+    // that can change under us
+    ThreadRing* head = ring;
+    if (s_rings.compare_exchange_strong(head, ring->next, std::memory_order_acq_rel))
+        return;
+    for (ThreadRing* it = head; it; it = it->next) {
+        if (it->next == ring) {
+            it->next = ring->next;
+            return;
+        }
+    }
+}
+
+static void drainAll()
+{
+    ThreadRing* ring = s_rings.load(std::memory_order_acquire);
+    while (ring) {
+        ThreadRing* next = ring->next;
+        // The thread is gone once retired, so this drain sees its last record
+        bool retired = ring->retired.load(std::memory_order_acquire);
+        drainRing(ring);
+        if (retired) {
+            s_retiredDropped += ring->dropped.load(std::memory_order_relaxed);
+            unlinkRing(ring);
+            delete ring;
+        }
+        ring = next;
+    }
+    if (s_file)
+        fflush(s_file);
+}
+
+static void flushLoop()
+{
+    std::unique_lock<std::mutex> lock(s_mutex);
+    while (!s_stopping) {
+        s_wakeup.wait_for(lock, std::chrono::milliseconds(kFlushIntervalMs));
+        drainAll();
+    }
+}
+
+bool BinaryLogger::start(const std::string& output)
+{
+    if (s_thread && output == s_output)
+        return true;
+
+    stop();
+    if (output.empty())
+        return false;
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (output == "pmlog") {
+        s_toPmLog = true;
+    } else {
+        s_file = fopen(output.c_str(), "w");
+        if (!s_file) {
+            LOG_WARNING(MSGID_BINARY_LOG_FAIL, 1, PMLOGKS("PATH", output.c_str()), "");
+            return false;
+        }
+        fwrite(BinaryLogFormat::kFileMagic, sizeof(BinaryLogFormat::kFileMagic), 1, s_file);
+        s_formatWritten.clear();
+    }
+
+    s_output = output;
+    s_stopping = false;
+    s_thread = new std::thread(flushLoop);
+    s_enabled.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void BinaryLogger::stop()
+{
+    if (!s_thread)
+        return;
+
+    s_enabled.store(false, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        s_stopping = true;
+    }
+    s_wakeup.notify_one();
+    s_thread->join();
+    delete s_thread;
+    s_thread = 0;
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    drainAll();
+    if (s_file) {
+        fclose(s_file);
+        s_file = 0;
+    }
+    s_toPmLog = false;
+    s_output.clear();
+}
+
+uint16_t BinaryLogger::registerFormat(int level, const char* msgid, const char* format)
+{
+    std::lock_guard<std::mutex> lock(s_formatsMutex);
+    if (s_formats.size() >= kInvalidFormatId)
+        return kInvalidFormatId;
+
+    LogFormat entry = { level, msgid, format };
+    s_formats.push_back(entry);
+    return static_cast<uint16_t>(s_formats.size() - 1);
+}
+
+void BinaryLogger::commit(uint16_t formatId, const char* payload, size_t size)
+{
+    ThreadRing* ring = t_ringOwner.ring ? t_ringOwner.ring : createThreadRing();
+    size_t total = sizeof(BinaryLogFormat::RecordHeader) + size;
+
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    uint64_t tail = ring->tail.load(std::memory_order_acquire);
+    if (kRingSize - (head - tail) < total) {
+        // Never block the caller, the flush thread is behind
+        ring->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    BinaryLogFormat::RecordHeader header = { formatId, static_cast<uint16_t>(size), ring->threadId, monotonicNs() };
+    copyToRing(ring, head, &header, sizeof(header));
+    copyToRing(ring, head + sizeof(header), payload, size);
+    ring->head.store(head + total, std::memory_order_release);
+}
+
+void BinaryLogger::setDumpPath(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_dumpPath = path;
+}
+
+std::string BinaryLogger::dumpPath()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_dumpPath;
+}
+
+bool BinaryLogger::dump()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    drainAll();
+
+    // Everything is in the file already when the logger writes to it
+    if (s_file && s_output == s_dumpPath)
+        return true;
+
+    FILE* file = s_dumpPath.empty() ? 0 : fopen(s_dumpPath.c_str(), "w");
+    if (!file) {
+        LOG_WARNING(MSGID_BINARY_LOG_FAIL, 1, PMLOGKS("PATH", s_dumpPath.c_str()), "");
+        return false;
+    }
+
+    fwrite(BinaryLogFormat::kFileMagic, sizeof(BinaryLogFormat::kFileMagic), 1, file);
+    size_t formatCount;
+    {
+        std::lock_guard<std::mutex> formatsLock(s_formatsMutex);
+        formatCount = s_formats.size();
+    }
+    for (size_t i = 0; i < formatCount; i++)
+        writeFormat(file, static_cast<uint16_t>(i), *formatAt(static_cast<uint16_t>(i)));
+    for (std::deque<LogRecord>::const_iterator it = s_history.begin(); it != s_history.end(); ++it)
+        writeRecord(file, *it);
+    fclose(file);
+    return true;
+}
+
+QJsonObject BinaryLogger::statistics()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    uint64_t dropped = s_retiredDropped;
+    int threads = 0;
+    for (ThreadRing* ring = s_rings.load(std::memory_order_acquire); ring; ring = ring->next) {
+        dropped += ring->dropped.load(std::memory_order_relaxed);
+        threads++;
+    }
+
+    QJsonObject result;
+    result["enabled"] = isEnabled();
+    result["output"] = s_toPmLog ? QStringLiteral("pmlog") : (s_file ? QStringLiteral("file") : QStringLiteral("off"));
+    result["records"] = static_cast<double>(s_recordCount);
+    result["dropped"] = static_cast<double>(dropped);
+    result["bytesWritten"] = static_cast<double>(s_bytesWritten);
+    {
+        std::lock_guard<std::mutex> formatsLock(s_formatsMutex);
+        result["formats"] = static_cast<int>(s_formats.size());
+    }
+    result["threads"] = threads;
+    result["history"] = static_cast<int>(s_history.size());
+    return result;
+}
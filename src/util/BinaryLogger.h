@@ -0,0 +1,137 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef BINARYLOGGER_H
+#define BINARYLOGGER_H
+
+#include <algorithm>
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <type_traits>
+
+#include "BinaryLogFormat.h"
+
+class QJsonObject;
+
+// Optional low overhead log backend. A call site registers its format once
+// and then writes only the format id and the raw arguments into a lock free
+// ring of the calling thread, the text is never formatted on that thread.
+// A background thread drains the rings every few ms into a dump file (see
+// BinaryLogFormat.h, decoded offline by wam-logdecode) or formats them into
+// PmLog. The last drained records are kept in memory so they can be dumped
+// as context of a crash.
+class BinaryLogger {
+public:
+    // Started with WAM_BINARY_LOG and switched by the logControl "binaryLog"
+    // key. output is "pmlog" or the path of a dump file, which logControl
+    // only sets to the configured dump path; empty turns the logger off.
+    static bool start(const std::string& output);
+    static void stop();
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    // level is a PmLogLevel, the strings must outlive the logger
+    static uint16_t registerFormat(int level, const char* msgid, const char* format);
+
+    template <typename... Args>
+    static void write(uint16_t formatId, Args... args)
+    {
+        char payload[kMaxPayloadSize];
+        size_t size = 0;
+        encodeArgs(payload, size, args...);
+        commit(formatId, payload, size);
+    }
+
+    // Writes the recent records of every thread in the dump file format to
+    // the configured dump path, see WAM_BINARY_LOG_DUMP_FILE. Done on the
+    // logControl "binaryLogDump" key, a web process crash and a flight
+    // recorder dump, never from a signal handler.
+    static void setDumpPath(const std::string& path);
+    static std::string dumpPath();
+    static bool dump();
+    static QJsonObject statistics();
+
+private:
+    static const size_t kMaxPayloadSize = 1024;
+    static const size_t kNumberSize = 1 + sizeof(uint64_t);
+
+    static void commit(uint16_t formatId, const char* payload, size_t size);
+
+    static void encodeArgs(char*, size_t&) {}
+
+    template <typename T, typename... Rest>
+    static void encodeArgs(char* payload, size_t& size, T value, Rest... rest)
+    {
+        encodeArg(payload, size, value);
+        encodeArgs(payload, size, rest...);
+    }
+
+    static void encodeNumber(char* payload, size_t& size, char type, uint64_t value)
+    {
+        if (size + kNumberSize > kMaxPayloadSize)
+            return;
+        payload[size] = type;
+        memcpy(payload + size + 1, &value, sizeof(value));
+        size += kNumberSize;
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type
+    encodeArg(char* payload, size_t& size, T value)
+    {
+        encodeNumber(payload, size,
+            std::is_signed<T>::value ? BinaryLogFormat::ArgInt : BinaryLogFormat::ArgUInt,
+            static_cast<uint64_t>(value));
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_floating_point<T>::value>::type
+    encodeArg(char* payload, size_t& size, T value)
+    {
+        double number = value;
+        uint64_t bits;
+        memcpy(&bits, &number, sizeof(bits));
+        encodeNumber(payload, size, BinaryLogFormat::ArgDouble, bits);
+    }
+
+    template <typename T>
+    static void encodeArg(char* payload, size_t& size, const T* value)
+    {
+        encodeNumber(payload, size, BinaryLogFormat::ArgPointer, reinterpret_cast<uintptr_t>(value));
+    }
+
+    static void encodeArg(char* payload, size_t& size, const char* value)
+    {
+        // Strings longer than the rest of the payload are truncated
+        if (size + 1 + sizeof(uint16_t) > kMaxPayloadSize)
+            return;
+        size_t length = value ? strlen(value) : 0;
+        length = std::min(length, kMaxPayloadSize - size - 1 - sizeof(uint16_t));
+        uint16_t encodedLength = static_cast<uint16_t>(length);
+
+        payload[size] = BinaryLogFormat::ArgString;
+        memcpy(payload + size + 1, &encodedLength, sizeof(encodedLength));
+        if (length)
+            memcpy(payload + size + 1 + sizeof(encodedLength), value, length);
+        size += 1 + sizeof(encodedLength) + length;
+    }
+
+    static std::atomic<bool> s_enabled;
+};
+
+#endif // BINARYLOGGER_H
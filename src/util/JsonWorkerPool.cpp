@@ -0,0 +1,214 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "JsonWorkerPool.h"
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <glib.h>
+
+#include "MainLoopWatchdog.h"
+#include "Metrics.h"
+
+struct PoolEntry {
+    JsonWorkerPool::Job* job;
+    const void* stream;
+    bool done;
+    gint64 submittedUs;
+};
+
+static size_t s_threshold = 0;
+static std::vector<std::thread*> s_threads;
+
+// Submitted jobs in submission order and the number in flight per
+// stream, main thread only
+static std::deque<PoolEntry*> s_submitted;
+static std::map<const void*, int> s_streamJobs;
+
+// Everything below is guarded by s_mutex, as is PoolEntry::done
+static std::mutex s_mutex;
+static std::condition_variable s_wakeup;
+static std::deque<PoolEntry*> s_queue;
+static bool s_stopping = false;
+static guint s_finishSource = 0;
+
+static void finishJob(PoolEntry* entry)
+{
+    static Histogram* s_delay = Metrics::histogram("wam_json_offload_delay_us", "JSON work from submission to its result on the main loop",
+        Metrics::kLatencyBucketsUs, Metrics::kLatencyBucketsUsCount);
+
+    if (entry->stream) {
+        std::map<const void*, int>::iterator it = s_streamJobs.find(entry->stream);
+        if (!--it->second)
+            s_streamJobs.erase(it);
+    }
+
+    entry->job->finished();
+    s_delay->observe(g_get_monotonic_time() - entry->submittedUs);
+    delete entry->job;
+    delete entry;
+}
+
+static gboolean finishDoneJobs(gpointer)
+{
+    WatchdogScope watchdogScope("JsonWorkerPool::finishDoneJobs");
+
+    // A done job waits only for the earlier jobs of its stream
+    std::vector<PoolEntry*> done;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        s_finishSource = 0;
+        std::set<const void*> waiting;
+        std::deque<PoolEntry*>::iterator it = s_submitted.begin();
+        while (it != s_submitted.end()) {
+            PoolEntry* entry = *it;
+            if (entry->done && (!entry->stream || !waiting.count(entry->stream))) {
+                done.push_back(entry);
+                it = s_submitted.erase(it);
+                continue;
+            }
+            if (entry->stream)
+                waiting.insert(entry->stream);
+            ++it;
+        }
+    }
+
+    for (size_t i = 0; i < done.size(); i++)
+        finishJob(done[i]);
+    return G_SOURCE_REMOVE;
+}
+
+static void workerLoop()
+{
+    static Histogram* s_runTime = Metrics::histogram("wam_json_worker_duration_us", "JSON work run on a worker thread",
+        Metrics::kLatencyBucketsUs, Metrics::kLatencyBucketsUsCount);
+
+    std::unique_lock<std::mutex> lock(s_mutex);
+    while (true) {
+        s_wakeup.wait(lock, [] { return s_stopping || !s_queue.empty(); });
+        if (s_queue.empty())
+            return;
+
+        PoolEntry* entry = s_queue.front();
+        s_queue.pop_front();
+        lock.unlock();
+
+        gint64 startTime = g_get_monotonic_time();
+        entry->job->run();
+        s_runTime->observe(g_get_monotonic_time() - startTime);
+
+        lock.lock();
+        entry->done = true;
+        if (!s_finishSource)
+            s_finishSource = g_idle_add_full(G_PRIORITY_DEFAULT, finishDoneJobs, 0, 0);
+    }
+}
+
+void JsonWorkerPool::start(int threads, size_t threshold)
+{
+    s_threshold = threshold;
+    if (!s_threads.empty())
+        return;
+
+    for (int i = 0; i < threads; i++)
+        s_threads.push_back(new std::thread(workerLoop));
+}
+
+void JsonWorkerPool::stop()
+{
+    if (s_threads.empty())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        s_stopping = true;
+    }
+    s_wakeup.notify_all();
+    for (size_t i = 0; i < s_threads.size(); i++) {
+        s_threads[i]->join();
+        delete s_threads[i];
+    }
+    s_threads.clear();
+
+    // The workers drained the queue before they exited, what is left is
+    // finishing the jobs in order
+    s_stopping = false;
+    if (s_finishSource) {
+        g_source_remove(s_finishSource);
+        s_finishSource = 0;
+    }
+    while (!s_submitted.empty()) {
+        PoolEntry* entry = s_submitted.front();
+        s_submitted.pop_front();
+        finishJob(entry);
+    }
+}
+
+bool JsonWorkerPool::isRunning()
+{
+    return !s_threads.empty();
+}
+
+size_t JsonWorkerPool::threshold()
+{
+    return s_threshold;
+}
+
+bool JsonWorkerPool::shouldOffload(size_t bytes, const void* stream)
+{
+    if (s_threads.empty())
+        return false;
+    return bytes >= s_threshold || isBusy(stream);
+}
+
+bool JsonWorkerPool::isBusy(const void* stream)
+{
+    return stream && s_streamJobs.count(stream);
+}
+
+void JsonWorkerPool::submit(Job* job, const void* stream)
+{
+    static Counter* s_offloaded = Metrics::counter("wam_json_offloaded_total", "JSON payloads parsed or serialized on a worker thread");
+
+    if (s_threads.empty()) {
+        job->run();
+        job->finished();
+        delete job;
+        return;
+    }
+
+    s_offloaded->increment();
+
+    PoolEntry* entry = new PoolEntry;
+    entry->job = job;
+    entry->stream = stream;
+    entry->done = false;
+    entry->submittedUs = g_get_monotonic_time();
+    s_submitted.push_back(entry);
+    if (stream)
+        s_streamJobs[stream]++;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        s_queue.push_back(entry);
+    }
+    s_wakeup.notify_one();
+}
@@ -0,0 +1,52 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef JSONWORKERPOOL_H
+#define JSONWORKERPOOL_H
+
+#include <stddef.h>
+
+// Worker threads for parsing and serializing large JSON payloads off the
+// main loop. A job runs on a worker and then finishes on the main loop.
+// Jobs of one stream, e.g. the updates of one subscription, finish in the
+// order they were submitted, and the work of a stream is submitted while
+// one of its jobs is in flight, see shouldOffload(). Jobs and work of
+// different streams, or without a stream, are not ordered against each
+// other. Main thread only, apart from Job::run().
+class JsonWorkerPool {
+public:
+    class Job {
+    public:
+        virtual ~Job() {}
+
+        virtual void run() = 0;      // on a worker thread
+        virtual void finished() = 0; // on the main loop
+    };
+
+    // No threads keeps all the work on the main loop
+    static void start(int threads, size_t threshold);
+    static void stop();
+
+    static bool isRunning();
+    // Payloads of at least this many bytes go to the pool
+    static size_t threshold();
+    // Whether work on a payload of the given size goes to the pool
+    static bool shouldOffload(size_t bytes, const void* stream = 0);
+    static bool isBusy(const void* stream);
+    static void submit(Job* job, const void* stream = 0);
+};
+
+#endif // JSONWORKERPOOL_H
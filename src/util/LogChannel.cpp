@@ -0,0 +1,211 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "LogChannel.h"
+
+#include <map>
+
+#include <glib.h>
+
+#include <QJsonObject>
+
+#include "LogManager.h"
+#include "Timer.h"
+
+static const int kDefaultMessagesPerSecond = 10;
+static const int kReportIntervalMs = 10000;
+
+struct LogChannelConfig {
+    LogChannelConfig()
+        : messagesPerSecond(-1)
+        , sampleEvery(-1)
+        , exempt(false)
+    {
+    }
+
+    // -1 means the default is used
+    int messagesPerSecond;
+    int sampleEvery;
+    bool exempt;
+};
+
+static LogChannel* s_channels = 0;
+static int s_defaultMessagesPerSecond = kDefaultMessagesPerSecond;
+static int s_defaultSampleEvery = 1;
+
+static std::map<std::string, LogChannelConfig>& channelConfigs()
+{
+    static std::map<std::string, LogChannelConfig> configs;
+    return configs;
+}
+
+class LogChannelReporter {
+public:
+    void schedule()
+    {
+        if (!m_timer.isRunning())
+            m_timer.start(kReportIntervalMs, this, &LogChannelReporter::report);
+    }
+
+    void report() { LogChannel::reportSuppressed(); }
+
+private:
+    OneShotTimer<LogChannelReporter> m_timer;
+};
+
+static LogChannelReporter& reporter()
+{
+    static LogChannelReporter reporter;
+    return reporter;
+}
+
+LogChannel::LogChannel(const char* name)
+    : m_name(name)
+    , m_next(s_channels)
+    , m_messagesPerSecond(0)
+    , m_sampleEvery(1)
+    , m_exempt(false)
+    , m_tokens(0)
+    , m_lastRefillUs(g_get_monotonic_time())
+    , m_seen(0)
+    , m_passed(0)
+    , m_suppressed(0)
+    , m_suppressedSinceReport(0)
+{
+    s_channels = this;
+    applyConfig();
+    m_tokens = m_messagesPerSecond * 2;
+}
+
+LogChannel::~LogChannel()
+{
+    for (LogChannel** it = &s_channels; *it; it = &(*it)->m_next) {
+        if (*it == this) {
+            *it = m_next;
+            break;
+        }
+    }
+}
+
+void LogChannel::applyConfig()
+{
+    std::map<std::string, LogChannelConfig>::const_iterator it = channelConfigs().find(m_name);
+    bool hasConfig = it != channelConfigs().end();
+
+    m_messagesPerSecond = hasConfig && it->second.messagesPerSecond >= 0 ? it->second.messagesPerSecond : s_defaultMessagesPerSecond;
+    m_sampleEvery = hasConfig && it->second.sampleEvery >= 1 ? it->second.sampleEvery : s_defaultSampleEvery;
+    m_exempt = hasConfig && it->second.exempt;
+    if (m_tokens > m_messagesPerSecond * 2)
+        m_tokens = m_messagesPerSecond * 2;
+}
+
+bool LogChannel::allow()
+{
+    if (m_exempt) {
+        m_passed++;
+        return true;
+    }
+
+    bool pass = (m_seen++ % m_sampleEvery) == 0;
+
+    // 0 messages per second means no rate limit
+    if (pass && m_messagesPerSecond > 0) {
+        int64_t now = g_get_monotonic_time();
+        double burst = m_messagesPerSecond * 2;
+        m_tokens += (now - m_lastRefillUs) * m_messagesPerSecond / 1000000.0;
+        if (m_tokens > burst)
+            m_tokens = burst;
+        m_lastRefillUs = now;
+
+        if (m_tokens >= 1)
+            m_tokens -= 1;
+        else
+            pass = false;
+    }
+
+    if (pass) {
+        m_passed++;
+        return true;
+    }
+
+    m_suppressed++;
+    m_suppressedSinceReport++;
+    reporter().schedule();
+    return false;
+}
+
+void LogChannel::setRateLimit(const std::string& name, int messagesPerSecond)
+{
+    if (name.empty())
+        s_defaultMessagesPerSecond = messagesPerSecond;
+    else
+        channelConfigs()[name].messagesPerSecond = messagesPerSecond;
+
+    for (LogChannel* channel = s_channels; channel; channel = channel->m_next)
+        channel->applyConfig();
+}
+
+void LogChannel::setSampling(const std::string& name, int sampleEvery)
+{
+    if (name.empty())
+        s_defaultSampleEvery = sampleEvery;
+    else
+        channelConfigs()[name].sampleEvery = sampleEvery;
+
+    for (LogChannel* channel = s_channels; channel; channel = channel->m_next)
+        channel->applyConfig();
+}
+
+void LogChannel::setExempt(const std::string& name, bool exempt)
+{
+    channelConfigs()[name].exempt = exempt;
+
+    for (LogChannel* channel = s_channels; channel; channel = channel->m_next)
+        channel->applyConfig();
+}
+
+void LogChannel::reportSuppressed()
+{
+    for (LogChannel* channel = s_channels; channel; channel = channel->m_next) {
+        if (!channel->m_suppressedSinceReport)
+            continue;
+
+        LOG_INFO(MSGID_LOG_SUPPRESSED, 2, PMLOGKS("CHANNEL", channel->m_name),
+            PMLOGKFV("COUNT", "%u", channel->m_suppressedSinceReport), "Suppressed %u messages", channel->m_suppressedSinceReport);
+        channel->m_suppressedSinceReport = 0;
+    }
+}
+
+QJsonObject LogChannel::statistics()
+{
+    // Call sites sharing a msgid are reported together
+    QJsonObject channels;
+    for (LogChannel* channel = s_channels; channel; channel = channel->m_next) {
+        QJsonObject entry = channels[channel->m_name].toObject();
+        entry["rateLimit"] = channel->m_messagesPerSecond;
+        entry["sampling"] = channel->m_sampleEvery;
+        entry["exempt"] = channel->m_exempt;
+        entry["passed"] = entry["passed"].toDouble() + channel->m_passed;
+        entry["suppressed"] = entry["suppressed"].toDouble() + channel->m_suppressed;
+        channels[channel->m_name] = entry;
+    }
+
+    QJsonObject result;
+    result["defaultRateLimit"] = s_defaultMessagesPerSecond;
+    result["defaultSampling"] = s_defaultSampleEvery;
+    result["channels"] = channels;
+    return result;
+}
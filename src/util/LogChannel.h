@@ -0,0 +1,67 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef LOGCHANNEL_H
+#define LOGCHANNEL_H
+
+#include <stdint.h>
+#include <string>
+
+class QJsonObject;
+
+// Per call site limiter for logs that fire on every event (load progress,
+// input events, PalmSystem calls). A channel passes every Nth message
+// (sampling) and at most a given number of messages per second with a
+// burst of twice that (token bucket). Suppressed messages are reported
+// periodically as one "suppressed N messages" line per channel.
+// Channels are named by their msgid and are configured by name through
+// logControl; all of this runs on the main thread only. Channels whose
+// logs the user turned on through logControl are exempt and pass every
+// message.
+class LogChannel {
+public:
+    explicit LogChannel(const char* name);
+    ~LogChannel();
+
+    bool allow();
+    const char* name() const { return m_name; }
+
+    // An empty name changes the default of every channel without its own setting
+    static void setRateLimit(const std::string& name, int messagesPerSecond);
+    static void setSampling(const std::string& name, int sampleEvery);
+    static void setExempt(const std::string& name, bool exempt);
+    static void reportSuppressed();
+    static QJsonObject statistics();
+
+private:
+    void applyConfig();
+
+    const char* m_name;
+    LogChannel* m_next;
+
+    int m_messagesPerSecond;
+    int m_sampleEvery;
+    bool m_exempt;
+    double m_tokens;
+    int64_t m_lastRefillUs;
+
+    uint64_t m_seen;
+    uint64_t m_passed;
+    uint64_t m_suppressed;
+    uint32_t m_suppressedSinceReport;
+};
+
+#endif // LOGCHANNEL_H
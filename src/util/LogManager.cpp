@@ -16,10 +16,24 @@
 
 #include "LogManager.h"
 
+#include <stdlib.h>
+
+#include "BinaryLogger.h"
+#include "LogChannel.h"
+
 static bool m_debugEventsEnable = false;
 static bool m_debugBundleMessagesEnable = false;
 static bool m_debugMouseMoveEnable = false;
 
+// Event logs the user asked for are not rate limited
+static void updateEventChannels()
+{
+    LogChannel::setExempt(MSGID_KEY_EVENT, m_debugEventsEnable);
+    LogChannel::setExempt(MSGID_MOUSE_BUTTON_EVENT, m_debugEventsEnable);
+    LogChannel::setExempt(MSGID_WINDOW_EVENT, m_debugEventsEnable);
+    LogChannel::setExempt(MSGID_MOUSE_MOVE_EVENT, m_debugMouseMoveEnable);
+}
+
 void LogManager::setLogControl(const std::string& keys, const std::string& value)
 {
     LOG_DEBUG("[LogManager::setLogControl] keys : %s, value : %s", keys.c_str(), value.c_str());
@@ -33,12 +47,14 @@ void LogManager::setLogControl(const std::string& keys, const std::string& value
             m_debugEventsEnable = false;
             m_debugBundleMessagesEnable = false;
         }
+        updateEventChannels();
     }
     else if (keys == "event") {
         if (value == "on")
             m_debugEventsEnable = true;
         else if (value == "off")
             m_debugEventsEnable = false;
+        updateEventChannels();
     }
     else if (keys == "bundleMessage") {
         if (value == "on")
@@ -51,6 +67,36 @@ void LogManager::setLogControl(const std::string& keys, const std::string& value
             m_debugMouseMoveEnable = true;
         else if (value == "off")
             m_debugMouseMoveEnable = false;
+        updateEventChannels();
+    }
+    else if (keys == "rateLimit" || keys == "sampling") {
+        // value is "<count>" for the default or "<msgid>:<count>" for one channel
+        std::string channel;
+        std::string count = value;
+        std::string::size_type separator = value.rfind(':');
+        if (separator != std::string::npos) {
+            channel = value.substr(0, separator);
+            count = value.substr(separator + 1);
+        }
+
+        int n = atoi(count.c_str());
+        if (keys == "rateLimit" && n >= 0)
+            LogChannel::setRateLimit(channel, n);
+        else if (keys == "sampling" && n >= 1)
+            LogChannel::setSampling(channel, n);
+    }
+    else if (keys == "binaryLog") {
+        // value is "off", "pmlog" or "file" for the configured dump file,
+        // callers never choose a path
+        if (value == "off")
+            BinaryLogger::stop();
+        else if (value == "pmlog")
+            BinaryLogger::start(value);
+        else if (value == "file")
+            BinaryLogger::start(BinaryLogger::dumpPath());
+    }
+    else if (keys == "binaryLogDump") {
+        BinaryLogger::dump();
     }
 }
 
@@ -25,6 +25,9 @@
 #define LOG_INFO(...) \
     do {              \
     } while (0)
+#define LOG_INFO_LIMITED(...) \
+    do {                      \
+    } while (0)
 #define LOG_DEBUG(...) \
     do {               \
     } while (0)
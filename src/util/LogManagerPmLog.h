@@ -19,25 +19,81 @@
 
 #include <PmLogLib.h>
 
+#include "BinaryLogger.h"
+#include "LogChannel.h"
+
 #define LOG_CONTEXT "WAM"
 #define LOG_APP_ID "APP_ID"
 
+PmLogContext GetWAMPmLogContext();
+
+inline bool isWAMLogEnabled(PmLogLevel level)
+{
+    PmLogLevel contextLevel;
+    return PmLogGetContextLevel(GetWAMPmLogContext(), &contextLevel) == kPmLogErr_None
+        && level <= contextLevel;
+}
+
+// Checks the level of the WAM context before the log statement, so its
+// arguments (qPrintable(), QString::arg(), ...) are evaluated only when
+// the message is actually written
+#define WAM_LOG_IF_ENABLED(__level, __statement) \
+    do {                                         \
+        if (isWAMLogEnabled(__level))            \
+            __statement;                         \
+    } while (0)
+
 // convenience macro for logging just app id to a specific msgid
-#define LOG_INFO_APPID(__msgid, __appid) \
-    PmLogInfo(GetWAMPmLogContext(), __msgid, 1, PMLOGKS(LOG_APP_ID, __appid), "")
-#define LOG_INFO_APPID_WITH_CLOCK(__msgid, __appid)                                        \
-    PmLogInfoWithClock(GetWAMPmLogContext(), __msgid, 3, PMLOGKS("PerfType", "AppLaunch"), \
-        PMLOGKS("PerfGroup", __appid),                                                     \
-        PMLOGKS(LOG_APP_ID, __appid), "")
+#define LOG_INFO_APPID(__msgid, __appid)                       \
+    WAM_LOG_IF_ENABLED(kPmLogLevel_Info,                       \
+        PmLogInfo(GetWAMPmLogContext(), __msgid, 1, PMLOGKS(LOG_APP_ID, __appid), ""))
+#define LOG_INFO_APPID_WITH_CLOCK(__msgid, __appid)                                            \
+    WAM_LOG_IF_ENABLED(kPmLogLevel_Info,                                                       \
+        PmLogInfoWithClock(GetWAMPmLogContext(), __msgid, 3, PMLOGKS("PerfType", "AppLaunch"), \
+            PMLOGKS("PerfGroup", __appid),                                                     \
+            PMLOGKS(LOG_APP_ID, __appid), ""))
 
 // Use these to log using PmLogLib v3 API
-#define LOG_INFO(__msgid, ...) PmLogInfo(GetWAMPmLogContext(), __msgid, ##__VA_ARGS__)
-#define LOG_INFO_WITH_CLOCK(__msgid, ...) PmLogInfoWithClock(GetWAMPmLogContext(), __msgid, ##__VA_ARGS__)
-#define LOG_DEBUG(...) PmLogDebug(GetWAMPmLogContext(), ##__VA_ARGS__)
-#define LOG_WARNING(__msgid, ...) PmLogWarning(GetWAMPmLogContext(), __msgid, ##__VA_ARGS__)
-#define LOG_ERROR(__msgid, ...) PmLogError(GetWAMPmLogContext(), __msgid, ##__VA_ARGS__)
-#define LOG_CRITICAL(__msgid, ...) PmLogCritical(GetWAMPmLogContext(), __msgid, ##__VA_ARGS__)
+#define LOG_INFO(__msgid, ...) \
+    WAM_LOG_IF_ENABLED(kPmLogLevel_Info, PmLogInfo(GetWAMPmLogContext(), __msgid, ##__VA_ARGS__))
+#define LOG_INFO_WITH_CLOCK(__msgid, ...) \
+    WAM_LOG_IF_ENABLED(kPmLogLevel_Info, PmLogInfoWithClock(GetWAMPmLogContext(), __msgid, ##__VA_ARGS__))
+#define LOG_WARNING(__msgid, ...) \
+    WAM_LOG_IF_ENABLED(kPmLogLevel_Warning, PmLogWarning(GetWAMPmLogContext(), __msgid, ##__VA_ARGS__))
+#define LOG_ERROR(__msgid, ...) \
+    WAM_LOG_IF_ENABLED(kPmLogLevel_Error, PmLogError(GetWAMPmLogContext(), __msgid, ##__VA_ARGS__))
+#define LOG_CRITICAL(__msgid, ...) \
+    WAM_LOG_IF_ENABLED(kPmLogLevel_Critical, PmLogCritical(GetWAMPmLogContext(), __msgid, ##__VA_ARGS__))
 
-PmLogContext GetWAMPmLogContext();
+// For call sites that log on every event, limited by the LogChannel of the
+// call site, see LogChannel.h
+#define LOG_INFO_LIMITED(__msgid, ...)                                            \
+    do {                                                                          \
+        static LogChannel s_logChannel(__msgid);                                  \
+        if (isWAMLogEnabled(kPmLogLevel_Info) && s_logChannel.allow())            \
+            PmLogInfo(GetWAMPmLogContext(), __msgid, ##__VA_ARGS__);              \
+    } while (0)
+
+#ifdef DISABLE_DEBUG_LOG
+// Debug logs are compiled out, the arguments are still type checked
+#define LOG_DEBUG(...)                                      \
+    do {                                                    \
+        if (0)                                              \
+            PmLogDebug(GetWAMPmLogContext(), ##__VA_ARGS__); \
+    } while (0)
+#else
+// With the binary logger running, debug logs only copy the format id and
+// the arguments into the ring of the thread, see BinaryLogger.h
+#define LOG_DEBUG(__format, ...)                                                 \
+    do {                                                                         \
+        if (BinaryLogger::isEnabled()) {                                         \
+            static const uint16_t s_logFormatId =                                \
+                BinaryLogger::registerFormat(kPmLogLevel_Debug, "", __format);   \
+            BinaryLogger::write(s_logFormatId, ##__VA_ARGS__);                   \
+        } else if (isWAMLogEnabled(kPmLogLevel_Debug)) {                         \
+            PmLogDebug(GetWAMPmLogContext(), __format, ##__VA_ARGS__);           \
+        }                                                                        \
+    } while (0)
+#endif
 
 #endif // LOGMANAGERPMLOG_H
@@ -128,6 +128,22 @@
 #define MSGID_CLEANRESOURCE_COMPLETED       "CLEANRESOURCE_COMPLETED" /** Complete clean resource by callback or unload event*/
 #define MSGID_START_LAUNCHURL               "START_LAUNCHURL" /** Start LaunchUrl on WebAppManager */
 #define MSGID_CLOSE_APP_INTERNAL            "CLOSE_APP_INTERNAL" /** Close App */
+#define MSGID_APP_CLOSE_TIME                "APP_CLOSE_TIME" /** Time from close request to WebApp deletion */
+#define MSGID_APP_HIBERNATED                "APP_HIBERNATED" /** Closed app is hidden and kept for reopen */
+#define MSGID_APP_REVIVED                   "APP_REVIVED" /** Hibernated app is reused for a new launch */
+#define MSGID_HIBERNATED_APP_EVICTED        "HIBERNATED_APP_EVICTED" /** Hibernated app is closed for good */
+#define MSGID_LOG_SUPPRESSED                "LOG_SUPPRESSED" /** Messages dropped by a rate limited log channel */
+#define MSGID_BINARY_LOG_FAIL               "BINARY_LOG_FAIL" /** Binary log file could not be opened */
+#define MSGID_METRICS_WRITE_FAIL            "METRICS_WRITE_FAIL" /** Metrics text file could not be written */
+#define MSGID_METRICS_TYPE_MISMATCH         "METRICS_TYPE_MISMATCH" /** Metric name is already registered with another type */
+#define MSGID_TRACE_DUMPED                  "TRACE_DUMPED" /** Recorded trace events were written */
+#define MSGID_TRACE_DUMP_FAIL               "TRACE_DUMP_FAIL" /** Trace event dump could not be written */
+#define MSGID_APP_LAUNCH_TIMELINE           "APP_LAUNCH_TIMELINE" /** Launch reached its last phase */
+#define MSGID_MAINLOOP_STALL                "MAINLOOP_STALL" /** Main loop is blocked longer than the watchdog threshold */
+#define MSGID_MAINLOOP_STALL_END            "MAINLOOP_STALL_END" /** Blocked main loop is running again */
+#define MSGID_SLOW_INPUT_EVENT              "SLOW_INPUT_EVENT" /** Input event took long to reach a frame */
+#define MSGID_LUNA_TRACE_FAIL               "LUNA_TRACE_FAIL" /** Luna trace file could not be opened */
+#define MSGID_RUNNING_APPS_PAGE_FAIL        "RUNNING_APPS_PAGE_FAIL" /** Shared memory page of running apps could not be created */
 #define MSGID_WEBPAGE_LOAD                  "WEBPAGE_LOAD" /** Webpage load starts */
 #define MSGID_WEBPAGE_LOAD_FINISHED         "WEBPAGE_LOAD_FINISHED" /** WebPage load finished */
 #define MSGID_WEBPAGE_LOAD_FAILED           "WEBPAGE_LOAD_FAILED" /** WebPage load failed */
@@ -0,0 +1,123 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "LunaTrace.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "LogManager.h"
+
+const char LunaTrace::kFileMagic[8] = { 'W', 'A', 'M', 'L', 'U', 'N', 'A', '1' };
+
+FILE* LunaTrace::s_file = 0;
+std::string LunaTrace::s_path;
+int64_t LunaTrace::s_startUs = 0;
+
+bool LunaTrace::start(const std::string& path)
+{
+    // The configuration is applied again when WAM starts running
+    if (s_file && path == s_path)
+        return true;
+
+    stop();
+    if (path.empty())
+        return true;
+
+    s_file = fopen(path.c_str(), "wb");
+    if (!s_file || fwrite(kFileMagic, sizeof(kFileMagic), 1, s_file) != 1) {
+        LOG_WARNING(MSGID_LUNA_TRACE_FAIL, 1, PMLOGKS("PATH", path.c_str()), "");
+        stop();
+        return false;
+    }
+
+    s_path = path;
+    s_startUs = g_get_monotonic_time();
+    return true;
+}
+
+void LunaTrace::stop()
+{
+    if (s_file)
+        fclose(s_file);
+    s_file = 0;
+    s_path.clear();
+}
+
+void LunaTrace::record(Kind kind, const char* method, const char* payload)
+{
+    if (!s_file)
+        return;
+
+    uint8_t encodedKind = kind;
+    uint32_t timeMs = static_cast<uint32_t>((g_get_monotonic_time() - s_startUs) / 1000);
+    uint16_t methodLength = method ? static_cast<uint16_t>(strnlen(method, UINT16_MAX)) : 0;
+    uint32_t payloadLength = payload ? static_cast<uint32_t>(strlen(payload)) : 0;
+
+    fwrite(&encodedKind, sizeof(encodedKind), 1, s_file);
+    fwrite(&timeMs, sizeof(timeMs), 1, s_file);
+    fwrite(&methodLength, sizeof(methodLength), 1, s_file);
+    fwrite(method, 1, methodLength, s_file);
+    fwrite(&payloadLength, sizeof(payloadLength), 1, s_file);
+    fwrite(payload, 1, payloadLength, s_file);
+
+    // Calls are rare enough, and a trace of a crashed WAM is the interesting one
+    fflush(s_file);
+}
+
+LunaTrace::Reader::Reader()
+    : m_file(0)
+{
+}
+
+LunaTrace::Reader::~Reader()
+{
+    if (m_file)
+        fclose(m_file);
+}
+
+bool LunaTrace::Reader::open(const std::string& path)
+{
+    m_file = fopen(path.c_str(), "rb");
+    if (!m_file)
+        return false;
+
+    char magic[sizeof(kFileMagic)];
+    return fread(magic, sizeof(magic), 1, m_file) == 1 && !memcmp(magic, kFileMagic, sizeof(magic));
+}
+
+bool LunaTrace::Reader::next(Record& record)
+{
+    uint8_t kind;
+    uint16_t methodLength;
+    uint32_t payloadLength;
+
+    if (!m_file || fread(&kind, sizeof(kind), 1, m_file) != 1
+        || fread(&record.timeMs, sizeof(record.timeMs), 1, m_file) != 1
+        || fread(&methodLength, sizeof(methodLength), 1, m_file) != 1)
+        return false;
+
+    record.kind = static_cast<Kind>(kind);
+    record.method.resize(methodLength);
+    if (methodLength && fread(&record.method[0], 1, methodLength, m_file) != methodLength)
+        return false;
+
+    if (fread(&payloadLength, sizeof(payloadLength), 1, m_file) != 1)
+        return false;
+    record.payload.resize(payloadLength);
+    return !payloadLength || fread(&record.payload[0], 1, payloadLength, m_file) == payloadLength;
+}
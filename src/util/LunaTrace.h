@@ -0,0 +1,74 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef LUNATRACE_H
+#define LUNATRACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+
+// Records the luna calls WAM handles with the time they arrived, so a
+// launch storm captured on a device can be replayed later, e.g. against
+// the stub engine by wam-lunareplay.
+//
+// A trace file starts with kFileMagic followed by records:
+//   uint8 kind, uint32 ms since the recording started,
+//   uint16 length, method, uint32 length, payload
+// All values are in host byte order.
+class LunaTrace {
+public:
+    enum Kind {
+        Call = 'C',
+        Subscription = 'S'
+    };
+
+    struct Record {
+        Kind kind;
+        uint32_t timeMs;
+        std::string method;
+        std::string payload;
+    };
+
+    // Records into path from now on, an empty path stops recording
+    static bool start(const std::string& path);
+    static void stop();
+    static bool isRecording() { return s_file != 0; }
+
+    static void record(Kind kind, const char* method, const char* payload);
+
+    // Reads the records of a trace file in the order they were recorded
+    class Reader {
+    public:
+        Reader();
+        ~Reader();
+
+        bool open(const std::string& path);
+        bool next(Record& record);
+
+    private:
+        FILE* m_file;
+    };
+
+    static const char kFileMagic[8];
+
+private:
+    static FILE* s_file;
+    static std::string s_path;
+    static int64_t s_startUs;
+};
+
+#endif // LUNATRACE_H
@@ -0,0 +1,260 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "MainLoopWatchdog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <errno.h>
+#include <execinfo.h>
+#include <mutex>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include <glib.h>
+
+#include "LogManager.h"
+#include "Metrics.h"
+
+// Ignored by default and not used by WAM or the web engine
+static const int kBacktraceSignal = SIGURG;
+static const int kMaxFrames = 32;
+static const int kBacktraceWaitMs = 100;
+static const int kMinHeartbeatMs = 10;
+static const int kMinPollMs = 5;
+// Callbacks longer than a 60 Hz frame, the last of them are kept
+static const int64_t kSlowCallbackUs = 16000;
+static const int kMaxSlowCallbacks = 16;
+
+std::atomic<const char*> MainLoopWatchdog::s_current(0);
+
+static std::atomic<gint64> s_lastBeatUs(0);
+// Callback the watchdog thread caught in the stall, taken by the heartbeat
+static std::atomic<const char*> s_stallCallback(0);
+
+// Written by the signal handler on the main thread
+static void* s_frames[kMaxFrames];
+static std::atomic<int> s_frameCount(0);
+
+// Set before the watchdog thread starts and fixed while it runs
+static int s_thresholdMs = 0;
+static int s_heartbeatMs = 0;
+static bool s_backtrace = false;
+static pthread_t s_mainThread;
+
+static std::mutex s_mutex;
+static std::condition_variable s_wakeup;
+static std::thread* s_thread = 0;
+static bool s_stopping = false;
+
+static guint s_heartbeatSource = 0;
+static bool s_handlerInstalled = false;
+
+struct SlowCallback {
+    const char* name;
+    int64_t endUs;
+    int durationUs;
+};
+
+// Main thread only
+static SlowCallback s_slowCallbacks[kMaxSlowCallbacks];
+static unsigned s_slowCallbackCount = 0;
+
+static void backtraceHandler(int)
+{
+    int savedErrno = errno;
+    s_frameCount.store(backtrace(s_frames, kMaxFrames));
+    errno = savedErrno;
+}
+
+static std::string captureMainThreadBacktrace()
+{
+    s_frameCount.store(-1);
+    if (pthread_kill(s_mainThread, kBacktraceSignal))
+        return std::string();
+
+    for (int waited = 0; s_frameCount.load() < 0 && waited < kBacktraceWaitMs; waited++)
+        usleep(1000);
+
+    int count = s_frameCount.load();
+    if (count <= 0)
+        return std::string();
+
+    std::string result;
+    char** symbols = backtrace_symbols(s_frames, count);
+    for (int i = 0; i < count; i++) {
+        if (i)
+            result += " <- ";
+        result += symbols ? symbols[i] : "?";
+    }
+    free(symbols);
+    return result;
+}
+
+static void watchLoop()
+{
+    int pollMs = std::max(s_thresholdMs / 4, kMinPollMs);
+    gint64 reportedBeat = 0;
+
+    std::unique_lock<std::mutex> lock(s_mutex);
+    while (!s_stopping) {
+        s_wakeup.wait_for(lock, std::chrono::milliseconds(pollMs));
+        if (s_stopping)
+            break;
+
+        gint64 lastBeat = s_lastBeatUs.load();
+        gint64 blockedMs = (g_get_monotonic_time() - lastBeat) / 1000 - s_heartbeatMs;
+        if (blockedMs < s_thresholdMs || lastBeat == reportedBeat)
+            continue;
+
+        // Once per stall, the heartbeat reports the total when the loop is back
+        reportedBeat = lastBeat;
+        const char* callback = MainLoopWatchdog::currentCallback();
+        if (!callback)
+            callback = "untagged";
+        s_stallCallback.store(callback);
+
+        std::string frames = s_backtrace ? captureMainThreadBacktrace() : std::string();
+        LOG_WARNING(MSGID_MAINLOOP_STALL, 2, PMLOGKFV("BLOCKED_MS", "%lld", (long long)blockedMs),
+            PMLOGKS("CALLBACK", callback), "%s", frames.c_str());
+    }
+}
+
+static gboolean heartbeat(gpointer)
+{
+    static Histogram* s_stallDuration = Metrics::histogram("wam_mainloop_stall_duration_ms",
+        "Main loop stalls longer than the watchdog threshold",
+        Metrics::kDurationBucketsMs, Metrics::kDurationBucketsMsCount);
+
+    gint64 now = g_get_monotonic_time();
+    gint64 lateMs = (now - s_lastBeatUs.exchange(now)) / 1000 - s_heartbeatMs;
+    if (lateMs < s_thresholdMs)
+        return G_SOURCE_CONTINUE;
+
+    // A stall just over the threshold can end before the watchdog thread looks
+    const char* callback = s_stallCallback.exchange(0);
+    if (!callback)
+        callback = "unknown";
+
+    Metrics::counter("wam_mainloop_stalls_total", "Main loop stalls by the callback running at the time",
+        "callback", callback)->increment();
+    s_stallDuration->observe(lateMs);
+
+    LOG_WARNING(MSGID_MAINLOOP_STALL_END, 2, PMLOGKFV("STALL_MS", "%lld", (long long)lateMs),
+        PMLOGKS("CALLBACK", callback), "");
+    return G_SOURCE_CONTINUE;
+}
+
+void MainLoopWatchdog::start(int thresholdMs, bool backtrace)
+{
+    if (thresholdMs == s_thresholdMs && backtrace == s_backtrace)
+        return;
+
+    stop();
+    if (thresholdMs <= 0)
+        return;
+
+    if (backtrace && !s_handlerInstalled) {
+        // The first backtrace() loads libgcc, which is not safe in a signal handler
+        void* frame;
+        ::backtrace(&frame, 1);
+
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = backtraceHandler;
+        action.sa_flags = SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        sigaction(kBacktraceSignal, &action, 0);
+        s_handlerInstalled = true;
+    }
+
+    s_thresholdMs = thresholdMs;
+    s_heartbeatMs = std::max(thresholdMs / 2, kMinHeartbeatMs);
+    s_backtrace = backtrace;
+    s_mainThread = pthread_self();
+
+    s_lastBeatUs.store(g_get_monotonic_time());
+    s_heartbeatSource = g_timeout_add(s_heartbeatMs, heartbeat, 0);
+
+    s_stopping = false;
+    s_thread = new std::thread(watchLoop);
+}
+
+void MainLoopWatchdog::stop()
+{
+    if (!s_thread)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        s_stopping = true;
+    }
+    s_wakeup.notify_one();
+    s_thread->join();
+    delete s_thread;
+    s_thread = 0;
+
+    g_source_remove(s_heartbeatSource);
+    s_heartbeatSource = 0;
+    s_thresholdMs = 0;
+    s_backtrace = false;
+}
+
+const char* MainLoopWatchdog::persistentName(const char* name)
+{
+    // Callers keep the result in a static, the set of names is bounded
+    return strdup(name ? name : "unknown");
+}
+
+int64_t MainLoopWatchdog::now()
+{
+    return g_get_monotonic_time();
+}
+
+void MainLoopWatchdog::callbackFinished(const char* name, int64_t startUs)
+{
+    int64_t endUs = g_get_monotonic_time();
+    if (endUs - startUs < kSlowCallbackUs)
+        return;
+
+    SlowCallback& entry = s_slowCallbacks[s_slowCallbackCount++ % kMaxSlowCallbacks];
+    entry.name = name;
+    entry.endUs = endUs;
+    entry.durationUs = static_cast<int>(endUs - startUs);
+}
+
+const char* MainLoopWatchdog::slowestCallbackSince(int64_t sinceUs, int* durationUs)
+{
+    const SlowCallback* slowest = 0;
+    unsigned first = s_slowCallbackCount > kMaxSlowCallbacks ? s_slowCallbackCount - kMaxSlowCallbacks : 0;
+    for (unsigned i = first; i < s_slowCallbackCount; i++) {
+        const SlowCallback& entry = s_slowCallbacks[i % kMaxSlowCallbacks];
+        if (entry.endUs >= sinceUs && (!slowest || entry.durationUs > slowest->durationUs))
+            slowest = &entry;
+    }
+
+    if (!slowest)
+        return 0;
+    if (durationUs)
+        *durationUs = slowest->durationUs;
+    return slowest->name;
+}
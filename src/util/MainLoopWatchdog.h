@@ -0,0 +1,85 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef MAINLOOPWATCHDOG_H
+#define MAINLOOPWATCHDOG_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// Watches the glib main loop from its own thread. A heartbeat source on
+// the main loop stamps the time it last ran; when it has not run for the
+// threshold, the watchdog logs the callback that is running right now and
+// optionally a backtrace of the main thread. The heartbeat measures how
+// late it ran and exports the stalls as metrics.
+// Main thread callbacks (Timer, Luna callbacks and replies) tag themselves
+// with a WatchdogScope, so a stall is attributed to its culprit. Tagged
+// callbacks that run longer than a frame are remembered even while the
+// watchdog is off, for slowestCallbackSince().
+class MainLoopWatchdog {
+public:
+    // 0 stops the watchdog. Starting it again with the same settings is a no-op.
+    // The backtrace is taken by a SIGURG handler on the main thread, which
+    // cuts short a sleep or poll of the stalled callback that is not restarted
+    static void start(int thresholdMs, bool backtrace);
+    static void stop();
+
+    static const char* currentCallback() { return s_current.load(std::memory_order_relaxed); }
+    static const char* exchangeCallback(const char* name) { return s_current.exchange(name, std::memory_order_relaxed); }
+    static void setCallback(const char* name) { s_current.store(name, std::memory_order_relaxed); }
+
+    // Copy of name kept for the life of the process, for tags that are not literals
+    static const char* persistentName(const char* name);
+
+    static int64_t now();
+    static void callbackFinished(const char* name, int64_t startUs);
+    // Slowest recent tagged callback that ended after sinceUs (g_get_monotonic_time), or 0
+    static const char* slowestCallbackSince(int64_t sinceUs, int* durationUs);
+
+private:
+    static std::atomic<const char*> s_current;
+};
+
+// name must outlive the scope, e.g. a string literal
+class WatchdogScope {
+public:
+    explicit WatchdogScope(const char* name)
+        : m_name(name)
+        , m_previous(MainLoopWatchdog::exchangeCallback(name))
+        , m_startUs(MainLoopWatchdog::now())
+    {
+    }
+
+    ~WatchdogScope()
+    {
+        MainLoopWatchdog::setCallback(m_previous);
+        MainLoopWatchdog::callbackFinished(m_name, m_startUs);
+    }
+
+private:
+    const char* m_name;
+    const char* m_previous;
+    int64_t m_startUs;
+
+    // Prevent heap allocation
+    void operator delete(void*);
+    void* operator new(size_t);
+    WatchdogScope(const WatchdogScope&);
+    WatchdogScope& operator=(const WatchdogScope&);
+};
+
+#endif // MAINLOOPWATCHDOG_H
@@ -0,0 +1,374 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "Metrics.h"
+
+#include <map>
+#include <mutex>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <QJsonArray>
+#include <QJsonObject>
+
+#include "LogManager.h"
+#include "Timer.h"
+
+const int64_t Metrics::kLatencyBucketsUs[] = { 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 1000000 };
+const int Metrics::kLatencyBucketsUsCount = sizeof(kLatencyBucketsUs) / sizeof(kLatencyBucketsUs[0]);
+const int64_t Metrics::kDurationBucketsMs[] = { 50, 100, 250, 500, 1000, 2000, 3000, 5000, 10000, 30000 };
+const int Metrics::kDurationBucketsMsCount = sizeof(kDurationBucketsMs) / sizeof(kDurationBucketsMs[0]);
+
+enum MetricType {
+    MetricCounter,
+    MetricGauge,
+    MetricHistogram
+};
+
+static const char* const kMetricTypeNames[] = { "counter", "gauge", "histogram" };
+
+struct MetricEntry {
+    MetricType type;
+    const char* help;
+    std::string labelName;
+    std::string labelValue;
+    void* metric;
+};
+
+// Entries of the same name stay together and in registration order
+typedef std::multimap<std::string, MetricEntry> MetricMap;
+
+static std::mutex s_mutex;
+
+static MetricMap& metricMap()
+{
+    static MetricMap metrics;
+    return metrics;
+}
+
+int MetricShard::current()
+{
+    static std::atomic<int> s_nextShard(0);
+    static thread_local int t_shard = -1;
+    if (t_shard < 0)
+        t_shard = s_nextShard.fetch_add(1, std::memory_order_relaxed) % kCount;
+    return t_shard;
+}
+
+// Shards are cache line aligned, which plain new does not guarantee in C++11
+template <typename T, typename... Args>
+static T* createAligned(Args... args)
+{
+    void* memory = 0;
+    if (posix_memalign(&memory, alignof(T), sizeof(T)))
+        abort();
+    return new (memory) T(args...);
+}
+
+Counter::Counter()
+{
+    for (int i = 0; i < MetricShard::kCount; i++)
+        m_shards[i].value.store(0, std::memory_order_relaxed);
+}
+
+uint64_t Counter::value() const
+{
+    uint64_t total = 0;
+    for (int i = 0; i < MetricShard::kCount; i++)
+        total += m_shards[i].value.load(std::memory_order_relaxed);
+    return total;
+}
+
+Histogram::Histogram(const int64_t* bounds, int count)
+    : m_bounds(bounds)
+    , m_boundCount(count < kMaxBuckets ? count : kMaxBuckets)
+{
+    for (int i = 0; i < MetricShard::kCount; i++) {
+        for (int j = 0; j <= kMaxBuckets; j++)
+            m_shards[i].buckets[j].store(0, std::memory_order_relaxed);
+        m_shards[i].count.store(0, std::memory_order_relaxed);
+        m_shards[i].sum.store(0, std::memory_order_relaxed);
+    }
+}
+
+void Histogram::observe(int64_t value)
+{
+    int bucket = 0;
+    while (bucket < m_boundCount && value > m_bounds[bucket])
+        bucket++;
+
+    Shard& shard = m_shards[MetricShard::current()];
+    shard.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    shard.count.fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+uint64_t Histogram::bucketValue(int i) const
+{
+    uint64_t total = 0;
+    for (int j = 0; j < MetricShard::kCount; j++)
+        total += m_shards[j].buckets[i].load(std::memory_order_relaxed);
+    return total;
+}
+
+uint64_t Histogram::count() const
+{
+    uint64_t total = 0;
+    for (int i = 0; i < MetricShard::kCount; i++)
+        total += m_shards[i].count.load(std::memory_order_relaxed);
+    return total;
+}
+
+int64_t Histogram::sum() const
+{
+    int64_t total = 0;
+    for (int i = 0; i < MetricShard::kCount; i++)
+        total += m_shards[i].sum.load(std::memory_order_relaxed);
+    return total;
+}
+
+// All label values of a name share its type
+static bool hasType(const char* name, MetricType type)
+{
+    MetricMap::const_iterator it = metricMap().find(name);
+    return it == metricMap().end() || it->second.type == type;
+}
+
+static void warnTypeMismatch(const char* name)
+{
+    LOG_WARNING(MSGID_METRICS_TYPE_MISMATCH, 1, PMLOGKS("NAME", name), "");
+}
+
+static MetricEntry* findEntry(const char* name, const char* labelName, const std::string& labelValue)
+{
+    std::pair<MetricMap::iterator, MetricMap::iterator> range = metricMap().equal_range(name);
+    for (MetricMap::iterator it = range.first; it != range.second; ++it) {
+        if (it->second.labelName == (labelName ? labelName : "") && it->second.labelValue == labelValue)
+            return &it->second;
+    }
+    return 0;
+}
+
+static void addEntry(const char* name, MetricType type, const char* help,
+    const char* labelName, const std::string& labelValue, void* metric)
+{
+    MetricEntry entry;
+    entry.type = type;
+    entry.help = help;
+    entry.labelName = labelName ? labelName : "";
+    entry.labelValue = labelValue;
+    entry.metric = metric;
+    metricMap().insert(std::make_pair(std::string(name), entry));
+}
+
+Counter* Metrics::counter(const char* name, const char* help, const char* labelName, const std::string& labelValue)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (!hasType(name, MetricCounter)) {
+        // Not in the map, so updates go nowhere
+        warnTypeMismatch(name);
+        static Counter* s_unexported = createAligned<Counter>();
+        return s_unexported;
+    }
+    if (MetricEntry* entry = findEntry(name, labelName, labelValue))
+        return static_cast<Counter*>(entry->metric);
+
+    Counter* counter = createAligned<Counter>();
+    addEntry(name, MetricCounter, help, labelName, labelValue, counter);
+    return counter;
+}
+
+Gauge* Metrics::gauge(const char* name, const char* help, const char* labelName, const std::string& labelValue)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (!hasType(name, MetricGauge)) {
+        warnTypeMismatch(name);
+        static Gauge* s_unexported = new Gauge;
+        return s_unexported;
+    }
+    if (MetricEntry* entry = findEntry(name, labelName, labelValue))
+        return static_cast<Gauge*>(entry->metric);
+
+    Gauge* gauge = new Gauge;
+    addEntry(name, MetricGauge, help, labelName, labelValue, gauge);
+    return gauge;
+}
+
+Histogram* Metrics::histogram(const char* name, const char* help, const int64_t* bounds, int count,
+    const char* labelName, const std::string& labelValue)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (!hasType(name, MetricHistogram)) {
+        warnTypeMismatch(name);
+        static Histogram* s_unexported = createAligned<Histogram>(kLatencyBucketsUs, kLatencyBucketsUsCount);
+        return s_unexported;
+    }
+    if (MetricEntry* entry = findEntry(name, labelName, labelValue))
+        return static_cast<Histogram*>(entry->metric);
+
+    Histogram* histogram = createAligned<Histogram>(bounds, count);
+    addEntry(name, MetricHistogram, help, labelName, labelValue, histogram);
+    return histogram;
+}
+
+QJsonObject Metrics::toJson()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    QJsonArray metrics;
+    for (MetricMap::const_iterator it = metricMap().begin(); it != metricMap().end(); ++it) {
+        const MetricEntry& entry = it->second;
+        QJsonObject metric;
+        metric["name"] = QString::fromStdString(it->first);
+        metric["type"] = kMetricTypeNames[entry.type];
+        if (!entry.labelName.empty()) {
+            QJsonObject labels;
+            labels[QString::fromStdString(entry.labelName)] = QString::fromStdString(entry.labelValue);
+            metric["labels"] = labels;
+        }
+
+        if (entry.type == MetricCounter) {
+            metric["value"] = static_cast<double>(static_cast<Counter*>(entry.metric)->value());
+        } else if (entry.type == MetricGauge) {
+            metric["value"] = static_cast<double>(static_cast<Gauge*>(entry.metric)->value());
+        } else {
+            const Histogram* histogram = static_cast<Histogram*>(entry.metric);
+            QJsonArray buckets;
+            for (int i = 0; i < histogram->bucketCount(); i++) {
+                QJsonObject bucket;
+                if (i < histogram->bucketCount() - 1)
+                    bucket["le"] = static_cast<double>(histogram->bound(i));
+                else
+                    bucket["le"] = QStringLiteral("+Inf");
+                bucket["count"] = static_cast<double>(histogram->bucketValue(i));
+                buckets.append(bucket);
+            }
+            metric["count"] = static_cast<double>(histogram->count());
+            metric["sum"] = static_cast<double>(histogram->sum());
+            metric["buckets"] = buckets;
+        }
+        metrics.append(metric);
+    }
+
+    QJsonObject result;
+    result["metrics"] = metrics;
+    return result;
+}
+
+static std::string labelText(const MetricEntry& entry, const char* le = 0)
+{
+    std::string text;
+    if (!entry.labelName.empty())
+        text += entry.labelName + "=\"" + entry.labelValue + "\"";
+    if (le) {
+        if (!text.empty())
+            text += ",";
+        text += std::string("le=\"") + le + "\"";
+    }
+    return text.empty() ? text : "{" + text + "}";
+}
+
+static void appendSample(std::string& out, const std::string& name, const std::string& labels, const char* format, long long value)
+{
+    char number[32];
+    snprintf(number, sizeof(number), format, value);
+    out += name + labels + " " + number + "\n";
+}
+
+std::string Metrics::toText()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    std::string out;
+    const std::string* lastName = 0;
+    for (MetricMap::const_iterator it = metricMap().begin(); it != metricMap().end(); ++it) {
+        const std::string& name = it->first;
+        const MetricEntry& entry = it->second;
+        if (!lastName || *lastName != name) {
+            out += "# HELP " + name + " " + entry.help + "\n";
+            out += "# TYPE " + name + " " + kMetricTypeNames[entry.type] + "\n";
+            lastName = &name;
+        }
+
+        if (entry.type == MetricCounter) {
+            appendSample(out, name, labelText(entry), "%llu", static_cast<Counter*>(entry.metric)->value());
+        } else if (entry.type == MetricGauge) {
+            appendSample(out, name, labelText(entry), "%lld", static_cast<Gauge*>(entry.metric)->value());
+        } else {
+            const Histogram* histogram = static_cast<Histogram*>(entry.metric);
+            uint64_t cumulative = 0;
+            for (int i = 0; i < histogram->bucketCount(); i++) {
+                char le[32];
+                if (i < histogram->bucketCount() - 1)
+                    snprintf(le, sizeof(le), "%lld", static_cast<long long>(histogram->bound(i)));
+                else
+                    snprintf(le, sizeof(le), "+Inf");
+                cumulative += histogram->bucketValue(i);
+                appendSample(out, name + "_bucket", labelText(entry, le), "%llu", cumulative);
+            }
+            appendSample(out, name + "_sum", labelText(entry), "%lld", histogram->sum());
+            appendSample(out, name + "_count", labelText(entry), "%llu", histogram->count());
+        }
+    }
+    return out;
+}
+
+bool Metrics::writeTextFile(const std::string& path)
+{
+    // Written aside and renamed, so a collector never reads a partial file
+    std::string text = toText();
+    std::string temporaryPath = path + ".tmp";
+    FILE* file = fopen(temporaryPath.c_str(), "w");
+    if (!file) {
+        LOG_WARNING(MSGID_METRICS_WRITE_FAIL, 1, PMLOGKS("PATH", path.c_str()), "");
+        return false;
+    }
+    bool written = fwrite(text.data(), 1, text.size(), file) == text.size();
+    written = fclose(file) == 0 && written;
+    if (!written || rename(temporaryPath.c_str(), path.c_str())) {
+        LOG_WARNING(MSGID_METRICS_WRITE_FAIL, 1, PMLOGKS("PATH", path.c_str()), "");
+        remove(temporaryPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+class MetricsFileWriter {
+public:
+    void start(const std::string& path, int intervalMs)
+    {
+        if (m_timer.isRunning())
+            m_timer.stop();
+
+        m_path = path;
+        if (m_path.empty() || intervalMs <= 0)
+            return;
+        m_timer.start(intervalMs, this, &MetricsFileWriter::write);
+    }
+
+    void write() { Metrics::writeTextFile(m_path); }
+
+private:
+    std::string m_path;
+    RepeatingTimer<MetricsFileWriter> m_timer;
+};
+
+void Metrics::setTextFile(const std::string& path, int intervalMs)
+{
+    static MetricsFileWriter s_writer;
+    s_writer.start(path, intervalMs);
+}
@@ -0,0 +1,127 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <stdint.h>
+#include <string>
+
+class QJsonObject;
+
+// Process wide counters, gauges and fixed bucket histograms, exported by
+// the getMetrics Luna method and as a Prometheus text file.
+// A metric is created once per call site and lives until exit, so the
+// returned pointer is meant to be kept in a static:
+//
+//     static Counter* s_launches = Metrics::counter("wam_app_launches_total", "Apps launched");
+//     s_launches->increment();
+//
+// Updates take no lock. Counters and histograms keep one cache line per
+// shard, every thread writes to its own shard and the shards are summed
+// only on export.
+class MetricShard {
+public:
+    static const int kCount = 8;
+    static int current();
+};
+
+class Counter {
+public:
+    Counter();
+
+    void increment(uint64_t n = 1) { m_shards[MetricShard::current()].value.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value;
+    };
+    Shard m_shards[MetricShard::kCount];
+};
+
+class Gauge {
+public:
+    Gauge()
+        : m_value(0)
+    {
+    }
+
+    void set(int64_t value) { m_value.store(value, std::memory_order_relaxed); }
+    void add(int64_t delta) { m_value.fetch_add(delta, std::memory_order_relaxed); }
+    int64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> m_value;
+};
+
+class Histogram {
+public:
+    static const int kMaxBuckets = 16;
+
+    // bounds are the ascending upper bounds of the buckets, an overflow
+    // bucket is added after the last one
+    Histogram(const int64_t* bounds, int count);
+
+    void observe(int64_t value);
+
+    int bucketCount() const { return m_boundCount + 1; }
+    int64_t bound(int i) const { return m_bounds[i]; }
+    uint64_t bucketValue(int i) const;
+    uint64_t count() const;
+    int64_t sum() const;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> buckets[kMaxBuckets + 1];
+        std::atomic<uint64_t> count;
+        std::atomic<int64_t> sum;
+    };
+
+    const int64_t* m_bounds;
+    int m_boundCount;
+    Shard m_shards[MetricShard::kCount];
+};
+
+class Metrics {
+public:
+    // Latency buckets in us and ms for the common cases
+    static const int64_t kLatencyBucketsUs[];
+    static const int kLatencyBucketsUsCount;
+    static const int64_t kDurationBucketsMs[];
+    static const int kDurationBucketsMsCount;
+
+    // Registering the same name and label again returns the same metric.
+    // A metric has at most one label, e.g. method="launchApp". Registering
+    // it again with another type logs a warning and returns a metric that
+    // is not exported, so callers never get a null pointer.
+    static Counter* counter(const char* name, const char* help,
+        const char* labelName = 0, const std::string& labelValue = std::string());
+    static Gauge* gauge(const char* name, const char* help,
+        const char* labelName = 0, const std::string& labelValue = std::string());
+    static Histogram* histogram(const char* name, const char* help, const int64_t* bounds, int count,
+        const char* labelName = 0, const std::string& labelValue = std::string());
+
+    static QJsonObject toJson();
+    static std::string toText();
+
+    static bool writeTextFile(const std::string& path);
+    // Rewrites the text file every intervalMs, an empty path stops it
+    static void setTextFile(const std::string& path, int intervalMs);
+};
+
+#endif // METRICS_H
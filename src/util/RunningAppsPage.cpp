@@ -0,0 +1,155 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "RunningAppsPage.h"
+
+#include <algorithm>
+#include <atomic>
+#include <errno.h>
+#include <fcntl.h>
+#include <sstream>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "LogManager.h"
+#include "Metrics.h"
+
+// Not every toolchain has the memfd declarations yet
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS 1033
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW 0x0004
+#endif
+#ifndef F_SEAL_FUTURE_WRITE
+#define F_SEAL_FUTURE_WRITE 0x0010
+#endif
+
+static int s_fd = -1;
+static wam_running_apps_page* s_page = 0;
+
+static int createMemfd(const char* name)
+{
+#ifdef SYS_memfd_create
+    return syscall(SYS_memfd_create, name, MFD_CLOEXEC | MFD_ALLOW_SEALING);
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+bool RunningAppsPage::start()
+{
+    if (s_page)
+        return true;
+
+    int fd = createMemfd("wam-running-apps");
+    if (fd < 0 || ftruncate(fd, sizeof(wam_running_apps_page)) < 0) {
+        LOG_WARNING(MSGID_RUNNING_APPS_PAGE_FAIL, 1, PMLOGKS("ERROR", strerror(errno)), "");
+        if (fd >= 0)
+            close(fd);
+        return false;
+    }
+
+    void* page = mmap(0, sizeof(wam_running_apps_page), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (page == MAP_FAILED) {
+        LOG_WARNING(MSGID_RUNNING_APPS_PAGE_FAIL, 1, PMLOGKS("ERROR", strerror(errno)), "");
+        close(fd);
+        return false;
+    }
+
+    // Readers can trust the size, and since 5.1 can not map it writable either
+    fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW);
+    fcntl(fd, F_ADD_SEALS, F_SEAL_FUTURE_WRITE);
+
+    s_fd = fd;
+    s_page = static_cast<wam_running_apps_page*>(page);
+    s_page->magic = WAM_RUNNING_APPS_MAGIC;
+    s_page->version = WAM_RUNNING_APPS_VERSION;
+    s_page->size = sizeof(wam_running_apps_page);
+    s_page->updated_ms = nowMs();
+    return true;
+}
+
+void RunningAppsPage::stop()
+{
+    if (!s_page)
+        return;
+
+    __atomic_or_fetch(&s_page->flags, WAM_RUNNING_APPS_FLAG_CLOSED, __ATOMIC_RELEASE);
+    munmap(s_page, sizeof(wam_running_apps_page));
+    close(s_fd);
+    s_page = 0;
+    s_fd = -1;
+}
+
+bool RunningAppsPage::isStarted()
+{
+    return s_page != 0;
+}
+
+void RunningAppsPage::publish(const std::vector<wam_running_app>& apps)
+{
+    static Counter* s_updates = Metrics::counter("wam_running_apps_page_updates_total", "Rewrites of the shared memory page of running apps");
+
+    if (!s_page)
+        return;
+
+    uint32_t count = std::min<size_t>(apps.size(), WAM_RUNNING_APPS_MAX);
+    uint32_t sequence = s_page->sequence;
+
+    // Odd sequence first, so a reader never accepts a half written page
+    __atomic_store_n(&s_page->sequence, sequence + 1, __ATOMIC_RELAXED);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    if (count)
+        memcpy(s_page->apps, &apps[0], count * sizeof(wam_running_app));
+    if (count < s_page->count)
+        memset(s_page->apps + count, 0, (s_page->count - count) * sizeof(wam_running_app));
+    s_page->count = count;
+    s_page->updated_ms = nowMs();
+
+    __atomic_store_n(&s_page->sequence, sequence + 2, __ATOMIC_RELEASE);
+    s_updates->increment();
+}
+
+std::string RunningAppsPage::path()
+{
+    if (!s_page)
+        return std::string();
+
+    std::ostringstream stream;
+    stream << "/proc/" << getpid() << "/fd/" << s_fd;
+    return stream.str();
+}
+
+uint32_t RunningAppsPage::size()
+{
+    return sizeof(wam_running_apps_page);
+}
+
+uint64_t RunningAppsPage::nowMs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000 + now.tv_nsec / 1000000;
+}
@@ -0,0 +1,48 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef RUNNINGAPPSPAGE_H
+#define RUNNINGAPPSPAGE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "RunningAppsPageLayout.h"
+
+// Writer of the running apps page, see RunningAppsPageLayout.h. The page
+// lives in a sealed memfd that readers map read only through path(), so
+// they never block WAM nor need a Luna call per look. Main thread only.
+class RunningAppsPage {
+public:
+    // False if the kernel has no memfd, the page is then never published
+    static bool start();
+    // Marks the page closed, readers that still map it see that
+    static void stop();
+    static bool isStarted();
+
+    // Rewrites the page, apps beyond WAM_RUNNING_APPS_MAX are left out
+    static void publish(const std::vector<wam_running_app>& apps);
+
+    // /proc path of the memfd, readers open it to map the page
+    static std::string path();
+    static uint32_t size();
+
+    // Clock of the times in the page
+    static uint64_t nowMs();
+};
+
+#endif // RUNNINGAPPSPAGE_H
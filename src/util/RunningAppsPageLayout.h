@@ -0,0 +1,72 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef RUNNINGAPPSPAGELAYOUT_H
+#define RUNNINGAPPSPAGELAYOUT_H
+
+#include <stdint.h>
+
+/*
+ * Layout of the running apps page, which WAM keeps in a memfd so local
+ * readers can see the running apps without a Luna round trip. Shared by
+ * RunningAppsPage, the writer, and the C reader library (libwam-running-apps),
+ * so it is plain C.
+ *
+ * The page is guarded by a seqlock: sequence is odd while WAM rewrites the
+ * page and even otherwise. A reader copies what it needs between two loads of
+ * sequence and retries unless both loaded the same even value.
+ * The layout only changes together with WAM_RUNNING_APPS_VERSION.
+ * All values are in host byte order, times are CLOCK_MONOTONIC milliseconds.
+ */
+
+#define WAM_RUNNING_APPS_MAGIC 0x504d4157u /* "WAMP" */
+#define WAM_RUNNING_APPS_VERSION 1
+
+#define WAM_RUNNING_APPS_MAX 64
+#define WAM_RUNNING_APPS_APP_ID_SIZE 128
+#define WAM_RUNNING_APPS_INSTANCE_ID_SIZE 32
+
+/* Set once WAM has stopped updating the page */
+#define WAM_RUNNING_APPS_FLAG_CLOSED 0x1u
+
+enum wam_app_state {
+    WAM_APP_STATE_UNKNOWN = 0,
+    WAM_APP_STATE_PRELOADED = 1,  /* launched in the background, not shown yet */
+    WAM_APP_STATE_FOREGROUND = 2, /* its window is activated */
+    WAM_APP_STATE_BACKGROUND = 3
+};
+
+struct wam_running_app {
+    char app_id[WAM_RUNNING_APPS_APP_ID_SIZE];           /* NUL terminated */
+    char instance_id[WAM_RUNNING_APPS_INSTANCE_ID_SIZE]; /* NUL terminated */
+    uint32_t pid;            /* of the web process */
+    uint32_t state;          /* enum wam_app_state */
+    uint64_t memory_kb;      /* VmRSS of the web process, shared by its apps */
+    uint64_t last_active_ms; /* 0 if the app was never activated */
+};
+
+struct wam_running_apps_page {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;     /* of the whole page */
+    uint32_t flags;
+    uint32_t sequence; /* odd while the page is being written */
+    uint32_t count;    /* entries of apps in use */
+    uint64_t updated_ms; /* of the last rewrite */
+    struct wam_running_app apps[WAM_RUNNING_APPS_MAX];
+};
+
+#endif /* RUNNINGAPPSPAGELAYOUT_H */
@@ -17,6 +17,8 @@
 #include "Timer.h"
 #include <glib.h>
 
+int Timer::s_liveCount = 0;
+
 int timeout_cb(void* data)
 {
     Timer* timer = (Timer*) data;
@@ -17,6 +17,8 @@
 #ifndef TIMER_H
 #define TIMER_H
 
+#include "MainLoopWatchdog.h"
+
 int timeout_cb(void* data);
 int timeout_cb_destroy(void* data);
 
@@ -29,8 +31,12 @@ public:
         , m_isRunning(false)
         , m_isRepeating(isRepeating)
     {
+        s_liveCount++;
     }
-    virtual ~Timer() {}
+    virtual ~Timer() { s_liveCount--; }
+
+    // Timer objects alive on the main thread, e.g. for leak checks
+    static int liveCount() { return s_liveCount; }
 
     // Timer
     virtual void handleCallback() = 0;
@@ -44,6 +50,8 @@ protected:
     void running(bool isRunning) { m_isRunning = isRunning; }
 
 private:
+    static int s_liveCount;
+
     int m_sourceId;
     bool m_isRunning;
     bool m_isRepeating;
@@ -67,6 +75,8 @@ public:
 
     void handleCallback() override
     {
+        // Names the receiver type, e.g. [with Receiver = WebAppWayland; ...]
+        WatchdogScope watchdogScope(__PRETTY_FUNCTION__);
         running(kIsRepeating);
         (m_receiver->*m_method)();
     }
@@ -0,0 +1,226 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "TraceEventRecorder.h"
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+#include <glib.h>
+#include <glib-unix.h>
+
+#include "LogManager.h"
+
+static const size_t kMaxEvents = 16384;
+static const size_t kMaxArgLength = 63;
+
+struct TraceEvent {
+    const char* name;
+    const char* argName;
+    uint64_t timestampUs;
+    uint64_t asyncId;
+    uint32_t threadId;
+    char phase;
+    char argValue[kMaxArgLength + 1];
+};
+
+std::atomic<bool> TraceEventRecorder::s_enabled(false);
+
+static std::mutex s_mutex;
+static std::vector<TraceEvent> s_events;
+static size_t s_nextEvent = 0;
+static size_t s_eventCount = 0;
+static uint64_t s_nextAsyncId = 1;
+// Ids of the async begins without an end yet, oldest first
+static std::map<std::string, std::deque<uint64_t> > s_openAsyncIds;
+static std::string s_dumpPath = "/tmp/wam-trace.json";
+static bool s_dumpSignalInstalled = false;
+
+static gboolean onDumpSignal(gpointer)
+{
+    TraceEventRecorder::dump();
+    return G_SOURCE_CONTINUE;
+}
+
+static uint32_t currentThreadId()
+{
+    static thread_local uint32_t t_threadId = 0;
+    if (!t_threadId)
+        t_threadId = static_cast<uint32_t>(syscall(SYS_gettid));
+    return t_threadId;
+}
+
+void TraceEventRecorder::setEnabled(bool enabled)
+{
+    // The signal is handled on the main loop, not in the signal handler
+    if (enabled && !s_dumpSignalInstalled) {
+        g_unix_signal_add(SIGUSR2, onDumpSignal, 0);
+        s_dumpSignalInstalled = true;
+    }
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (enabled && s_events.empty())
+        s_events.resize(kMaxEvents);
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+// Called with s_mutex held
+static uint64_t asyncId(TraceEventRecorder::Phase phase, const char* name)
+{
+    std::deque<uint64_t>& open = s_openAsyncIds[name];
+    if (phase == TraceEventRecorder::AsyncBegin) {
+        // Begins that never end must not grow the list forever
+        if (open.size() >= kMaxEvents)
+            open.pop_front();
+        open.push_back(s_nextAsyncId);
+        return s_nextAsyncId++;
+    }
+
+    // An end without a begin still gets an id of its own
+    if (open.empty())
+        return s_nextAsyncId++;
+    uint64_t id = open.front();
+    open.pop_front();
+    return id;
+}
+
+void TraceEventRecorder::add(Phase phase, const char* name, const char* argName, const char* argValue)
+{
+    uint64_t now = g_get_monotonic_time();
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (s_events.empty())
+        return;
+
+    TraceEvent& event = s_events[s_nextEvent];
+    event.name = name;
+    event.phase = phase;
+    event.timestampUs = now;
+    event.threadId = currentThreadId();
+    event.asyncId = 0;
+    if (phase == AsyncBegin || phase == AsyncEnd)
+        event.asyncId = asyncId(phase, name);
+    event.argName = argValue ? argName : 0;
+    if (event.argName) {
+        strncpy(event.argValue, argValue, kMaxArgLength);
+        event.argValue[kMaxArgLength] = '\0';
+    }
+
+    s_nextEvent = (s_nextEvent + 1) % s_events.size();
+    if (s_eventCount < s_events.size())
+        s_eventCount++;
+}
+
+int TraceEventRecorder::eventCount()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return static_cast<int>(s_eventCount);
+}
+
+static void appendEscaped(std::string& out, const char* text)
+{
+    for (const char* c = text; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            out += '\\';
+            out += *c;
+        } else if (static_cast<unsigned char>(*c) < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", *c);
+            out += escaped;
+        } else {
+            out += *c;
+        }
+    }
+}
+
+bool TraceEventRecorder::dump()
+{
+    std::vector<TraceEvent> events;
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        path = s_dumpPath;
+        size_t first = (s_nextEvent + s_events.size() - s_eventCount) % std::max<size_t>(s_events.size(), 1);
+        for (size_t i = 0; i < s_eventCount; i++)
+            events.push_back(s_events[(first + i) % s_events.size()]);
+    }
+
+    char buffer[128];
+    int pid = getpid();
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    snprintf(buffer, sizeof(buffer), "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"WebAppManager\"}}", pid);
+    out += buffer;
+
+    for (std::vector<TraceEvent>::const_iterator it = events.begin(); it != events.end(); ++it) {
+        out += ",{\"name\":\"";
+        appendEscaped(out, it->name);
+        snprintf(buffer, sizeof(buffer), "\",\"cat\":\"wam\",\"ph\":\"%c\",\"ts\":%llu,\"pid\":%d,\"tid\":%u",
+            it->phase, static_cast<unsigned long long>(it->timestampUs), pid, it->threadId);
+        out += buffer;
+        // Async events are matched by category, name and id
+        if (it->phase == AsyncBegin || it->phase == AsyncEnd) {
+            snprintf(buffer, sizeof(buffer), ",\"id\":\"0x%llx\"", static_cast<unsigned long long>(it->asyncId));
+            out += buffer;
+        }
+        if (it->phase == Instant)
+            out += ",\"s\":\"t\"";
+        if (it->argName) {
+            out += ",\"args\":{\"";
+            appendEscaped(out, it->argName);
+            out += "\":\"";
+            appendEscaped(out, it->argValue);
+            out += "\"}";
+        }
+        out += "}";
+    }
+    out += "]}\n";
+
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) {
+        LOG_WARNING(MSGID_TRACE_DUMP_FAIL, 1, PMLOGKS("PATH", path.c_str()), "");
+        return false;
+    }
+    bool written = fwrite(out.data(), 1, out.size(), file) == out.size();
+    written = fclose(file) == 0 && written;
+    if (!written) {
+        LOG_WARNING(MSGID_TRACE_DUMP_FAIL, 1, PMLOGKS("PATH", path.c_str()), "");
+        return false;
+    }
+
+    LOG_INFO(MSGID_TRACE_DUMPED, 2, PMLOGKS("PATH", path.c_str()), PMLOGKFV("EVENTS", "%d", static_cast<int>(events.size())), "");
+    return true;
+}
+
+void TraceEventRecorder::setDumpPath(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_dumpPath = path;
+}
+
+std::string TraceEventRecorder::dumpPath()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_dumpPath;
+}
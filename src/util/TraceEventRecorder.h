@@ -0,0 +1,108 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef TRACEEVENTRECORDER_H
+#define TRACEEVENTRECORDER_H
+
+#include <atomic>
+#include <stddef.h>
+#include <string>
+
+// In memory recorder for the PMTRACE points (see WebAppManagerTracer.h) and
+// the TRACE_EVENT_* macros below, dumped as Chrome trace event JSON which
+// Perfetto and chrome://tracing open as is.
+// Events go to a fixed size ring, the oldest are overwritten. While the
+// recorder is off every trace point costs one branch and its arguments are
+// not evaluated.
+class TraceEventRecorder {
+public:
+    enum Phase {
+        Begin = 'B',
+        End = 'E',
+        Instant = 'i',
+        AsyncBegin = 'b',
+        AsyncEnd = 'e'
+    };
+
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+    // Once recording was enabled, SIGUSR2 dumps the events to dumpPath()
+    static void setEnabled(bool enabled);
+
+    // name must be a string literal, argValue is copied (and truncated).
+    // An AsyncEnd closes the oldest open AsyncBegin of the same name, each
+    // pair gets an id of its own.
+    static void add(Phase phase, const char* name, const char* argName = 0, const char* argValue = 0);
+
+    // Writes dumpPath(), callers never choose the file
+    static bool dump();
+    static int eventCount();
+
+    static void setDumpPath(const std::string& path);
+    static std::string dumpPath();
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+class TraceEventScope {
+public:
+    TraceEventScope(const char* name, bool begun)
+        : m_name(name)
+        , m_begun(begun)
+    {
+    }
+
+    ~TraceEventScope()
+    {
+        if (m_begun)
+            TraceEventRecorder::add(TraceEventRecorder::End, m_name);
+    }
+
+    static bool begin(const char* name, const char* argName = 0, const char* argValue = 0)
+    {
+        TraceEventRecorder::add(TraceEventRecorder::Begin, name, argName, argValue);
+        return true;
+    }
+
+private:
+    const char* m_name;
+    bool m_begun;
+
+    // Prevent heap allocation
+    void operator delete(void*);
+    void* operator new(size_t);
+    TraceEventScope(const TraceEventScope&);
+    TraceEventScope& operator=(const TraceEventScope&);
+};
+
+#define TRACE_EVENT_CONCAT_INNER(a, b) a##b
+#define TRACE_EVENT_CONCAT(a, b) TRACE_EVENT_CONCAT_INNER(a, b)
+
+// Duration of the enclosing scope, the arguments are evaluated only while
+// recording, e.g.
+//     TRACE_EVENT_SCOPE("WebAppManager::launch", "appId", desc->id().c_str());
+// It expands to a single declaration.
+#define TRACE_EVENT_SCOPE(__name, ...)                                           \
+    TraceEventScope TRACE_EVENT_CONCAT(__traceEventScope, __LINE__)(__name,      \
+        TraceEventRecorder::isEnabled() && TraceEventScope::begin(__name, ##__VA_ARGS__))
+
+#define TRACE_EVENT_INSTANT(__name, ...)                                         \
+    do {                                                                         \
+        if (TraceEventRecorder::isEnabled())                                     \
+            TraceEventRecorder::add(TraceEventRecorder::Instant, __name, ##__VA_ARGS__); \
+    } while (0)
+
+#endif // TRACEEVENTRECORDER_H
@@ -15,8 +15,116 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "PalmServiceBase.h"
+
+#include <QJsonArray>
+
 #include "LogManager.h"
 
+// Serializes a method reply on a worker thread and sends it on the main loop
+class LunaReplyJob : public JsonWorkerPool::Job {
+public:
+    LunaReplyJob(LSMessage* message, const QJsonObject& reply)
+        : m_reply(message)
+        , m_object(reply)
+    {
+    }
+
+    void run() override
+    {
+        m_payload = lunaPayload(m_object);
+    }
+
+    void finished() override
+    {
+        m_reply.reply(m_payload.constData());
+    }
+
+private:
+    LSDeferredReply m_reply;
+    QJsonObject m_object;
+    QByteArray m_payload;
+};
+
+// Serializes a subscription update on a worker thread and posts it on the main loop
+class LunaPostJob : public JsonWorkerPool::Job {
+public:
+    LunaPostJob(LSHandle* handle, const char* category, const char* subscription, const QJsonObject& reply)
+        : m_handle(handle)
+        , m_category(category)
+        , m_subscription(subscription)
+        , m_object(reply)
+    {
+    }
+
+    void run() override
+    {
+        m_payload = lunaPayload(m_object);
+    }
+
+    void finished() override
+    {
+        LSErrorSafe lsError;
+        LSSubscriptionPost(m_handle, m_category.c_str(), m_subscription.c_str(), m_payload.constData(), &lsError);
+    }
+
+private:
+    LSHandle* m_handle;
+    std::string m_category;
+    std::string m_subscription;
+    QJsonObject m_object;
+    QByteArray m_payload;
+};
+
+// Rough size of the serialized value, counted only until it reaches limit
+static size_t estimatePayloadSize(const QJsonValue& value, size_t limit)
+{
+    switch (value.type()) {
+    case QJsonValue::String:
+        return value.toString().size() + 2;
+    case QJsonValue::Array: {
+        QJsonArray array = value.toArray();
+        size_t size = 2;
+        for (QJsonArray::const_iterator it = array.constBegin(); it != array.constEnd() && size < limit; ++it)
+            size += estimatePayloadSize(*it, limit - size) + 1;
+        return size;
+    }
+    case QJsonValue::Object: {
+        QJsonObject object = value.toObject();
+        size_t size = 2;
+        for (QJsonObject::const_iterator it = object.constBegin(); it != object.constEnd() && size < limit; ++it)
+            size += it.key().size() + 4 + estimatePayloadSize(it.value(), limit - size);
+        return size;
+    }
+    default:
+        return 5;
+    }
+}
+
+// Whether a reply goes to the pool. Only a large payload is measured, the
+// work of a busy stream goes there whatever its size.
+static bool offloadLunaPayload(const QJsonObject& reply, LunaPayloadSize size, const void* stream)
+{
+    if (JsonWorkerPool::isBusy(stream))
+        return true;
+    if (size != LargePayload || !JsonWorkerPool::isRunning())
+        return false;
+    size_t threshold = JsonWorkerPool::threshold();
+    return JsonWorkerPool::shouldOffload(estimatePayloadSize(reply, threshold), stream);
+}
+
+bool replyLunaMessage(LSHandle* handle, LSMessage* message, const QJsonObject& reply, LunaPayloadSize size, const void* stream)
+{
+    if (offloadLunaPayload(reply, size, stream)) {
+        JsonWorkerPool::submit(new LunaReplyJob(message, reply), stream);
+        return true;
+    }
+
+    QByteArray payload = lunaPayload(reply);
+
+    LSErrorSafe lsError;
+    return LSMessageReply(handle, message, payload.constData(), &lsError);
+}
+
 PalmServiceBase::PalmServiceBase()
     : m_serviceHandle(0)
     , m_serviceHandlePublic(0)
@@ -93,7 +201,7 @@ bool PalmServiceBase::call(
         if(context) {
             callRet = LSCallFromApplication(handle,
                     what,
-                    QJsonDocument(parameters).toJson().data(),
+                    lunaPayload(parameters).constData(),
                     applicationId,
                     LSCallbackHandler::callback,
                     static_cast<LSCallbackHandler*>(context),
@@ -104,7 +212,7 @@ bool PalmServiceBase::call(
             //caller does not care about reply from call
             callRet = LSCallFromApplication(handle,
                     what,
-                    QJsonDocument(parameters).toJson().data(),
+                    lunaPayload(parameters).constData(),
                     applicationId,
                     0, 0, 0,
                     &lsError);
@@ -113,7 +221,7 @@ bool PalmServiceBase::call(
         if(context) {
             callRet = LSCallFromApplicationOneReply(handle,
                     what,
-                    QJsonDocument(parameters).toJson().data(),
+                    lunaPayload(parameters).constData(),
                     applicationId,
                     LSCallbackHandler::callback,
                     static_cast<LSCallbackHandler*>(context),
@@ -124,7 +232,7 @@ bool PalmServiceBase::call(
             //caller does not care about reply from call
             callRet = LSCallFromApplicationOneReply(handle,
                     what,
-                    QJsonDocument(parameters).toJson().data(),
+                    lunaPayload(parameters).constData(),
                     applicationId,
                     0, 0, 0,
                     &lsError);
@@ -139,6 +247,46 @@ bool PalmServiceBase::call(
     return true;
 }
 
+PalmServiceBase::SubscriptionPosts& PalmServiceBase::subscriptionPosts(const char* subscription)
+{
+    std::map<std::string, SubscriptionPosts>::iterator it = m_subscriptionPosts.find(subscription);
+    if (it == m_subscriptionPosts.end()) {
+        SubscriptionPosts posts;
+        posts.latency = Metrics::histogram("wam_luna_post_duration_us", "Luna subscription updates on the main loop, serialization included",
+            Metrics::kLatencyBucketsUs, Metrics::kLatencyBucketsUsCount, "subscription", subscription);
+        it = m_subscriptionPosts.insert(std::make_pair(std::string(subscription), posts)).first;
+    }
+
+    return it->second;
+}
+
+const void* PalmServiceBase::subscriptionStream(const char* subscription)
+{
+    return &subscriptionPosts(subscription);
+}
+
+bool PalmServiceBase::postSubscription(LSHandle* handle, const char* subscription, const QJsonObject& reply, LunaPayloadSize size)
+{
+    SubscriptionPosts& posts = subscriptionPosts(subscription);
+    gint64 startTime = g_get_monotonic_time();
+    bool posted = true;
+
+    // Large updates, e.g. listRunningApps, are serialized on a worker
+    // thread. The updates of a subscription, and the first reply to each
+    // of its subscribers, are posted in order.
+    if (offloadLunaPayload(reply, size, &posts)) {
+        JsonWorkerPool::submit(new LunaPostJob(handle, category(), subscription, reply), &posts);
+    } else {
+        QByteArray payload = lunaPayload(reply);
+
+        LSErrorSafe lsError;
+        posted = LSSubscriptionPost(handle, category(), subscription, payload.constData(), &lsError);
+    }
+
+    posts.latency->observe(g_get_monotonic_time() - startTime);
+    return posted;
+}
+
 GMainLoop* PalmServiceBase::mainLoop() const {
   static GMainLoop* s_mainLoop = NULL;
   if (!s_mainLoop)
@@ -19,11 +19,19 @@
 
 #include <glib.h>
 
+#include <map>
+#include <string>
+
 #include <QJsonDocument>
 #include <QJsonObject>
-#include <QObject>
 #include <luna-service2/lunaservice.h>
 
+#include "JsonWorkerPool.h"
+#include "LunaTrace.h"
+#include "MainLoopWatchdog.h"
+#include "Metrics.h"
+#include "TraceEventRecorder.h"
+
 class LSHandle;
 class LSMessage;
 class LSPalmService;
@@ -46,32 +54,38 @@ public:
     }
 };
 
+/*
+ * Luna payloads are parsed straight from the message buffer and written
+ * without indentation, which keeps the bus traffic and the copies down
+ */
+inline QJsonObject parseLunaPayload(const char* payload)
+{
+    if (!payload)
+        return QJsonObject();
+    return QJsonDocument::fromJson(QByteArray::fromRawData(payload, qstrlen(payload))).object();
+}
+
+inline QJsonObject parseLunaPayload(LSMessage* message)
+{
+    return parseLunaPayload(LSMessageGetPayload(message));
+}
+
+inline QByteArray lunaPayload(const QJsonObject& object)
+{
+    return QJsonDocument(object).toJson(QJsonDocument::Compact);
+}
+
 /*
  * This class allows us to call into LS2 and have the reply be forwarded to a
- * Qt slot or Q_INVOKABLE function of some object of the signature
- * QJsonObject handlerFunc(QJsonObject payload)
+ * subclass implementing QJsonObject called(QJsonObject payload)
  *
  * */
-class LSCallbackHandler : public QObject {
-    Q_OBJECT
+class LSCallbackHandler {
 public:
-    LSCallbackHandler(QObject* receiver, const char* slot)
-        : m_receiver(receiver)
-        , m_slot(slot)
-    {
-    }
-
     virtual ~LSCallbackHandler() {}
 
 protected:
-    QJsonObject called(QJsonObject payload)
-    {
-        QJsonObject retVal;
-        QMetaObject::invokeMethod(m_receiver, m_slot,
-            Q_RETURN_ARG(QJsonObject, retVal),
-            Q_ARG(QJsonObject, payload));
-        return retVal;
-    }
+    virtual QJsonObject called(QJsonObject payload) = 0;
 
     static bool callback(LSHandle* handle, LSMessage* message, void* user_data)
     {
@@ -83,19 +97,13 @@ protected:
             return true;
         }
 
-        QJsonObject request = QJsonDocument::fromJson(LSMessageGetPayload(message)).object();
-        QJsonObject reply;
-
-        reply = static_cast<LSCallbackHandler*>(user_data)->called(request);
+        QJsonObject reply = static_cast<LSCallbackHandler*>(user_data)->called(parseLunaPayload(message));
 
         if (!reply.isEmpty())
-            return LSMessageReply(handle, message, QJsonDocument(reply).toJson().data(), &lsError);
+            return LSMessageReply(handle, message, lunaPayload(reply).constData(), &lsError);
         else
             return true;
     }
-
-    QObject* m_receiver;
-    const char* m_slot;
 };
 
 /**
@@ -105,9 +113,8 @@ class LSCalloutContext : public LSCallbackHandler {
     friend class PalmServiceBase;
 
 public:
-    LSCalloutContext(QObject* receiver, const char* slot)
-        : LSCallbackHandler(receiver, slot)
-        , m_service(0)
+    LSCalloutContext()
+        : m_service(0)
         , m_token(LSMESSAGE_TOKEN_INVALID){};
 
     ~LSCalloutContext()
@@ -134,7 +141,89 @@ private:
  *
  * */
 
-template <class CLASS, QJsonObject (CLASS::*FUNCTION)(QJsonObject)>
+inline Histogram* lunaMethodLatency(LSMessage* message)
+{
+    const char* method = LSMessageGetMethod(message);
+    return Metrics::histogram("wam_luna_method_duration_us", "Luna method calls on the main loop, payload parsing and reply included",
+        Metrics::kLatencyBucketsUs, Metrics::kLatencyBucketsUsCount, "method", method ? method : "unknown");
+}
+
+// The handler of the template instance, the "...::getAppStatusCallback]" at
+// the end of its __PRETTY_FUNCTION__, kept for the life of the process
+inline const char* lunaCallbackName(const char* prettyFunction)
+{
+    std::string name(prettyFunction);
+    size_t end = name.rfind(']');
+    size_t begin = end != std::string::npos ? name.rfind("::", end) : std::string::npos;
+    if (begin != std::string::npos)
+        name = name.substr(begin + 2, end - begin - 2);
+    return MainLoopWatchdog::persistentName(name.c_str());
+}
+
+inline Histogram* lunaCallbackLatency(const char* name)
+{
+    return Metrics::histogram("wam_luna_callback_duration_us", "Luna call replies on the main loop, payload parsing included",
+        Metrics::kLatencyBucketsUs, Metrics::kLatencyBucketsUsCount, "callback", name);
+}
+
+/*
+ * What a method reply or subscription update carries, decided per method
+ * and subscription. A large one, e.g. the running app list, is measured
+ * and serialized on a JsonWorkerPool thread, and sent later, when it
+ * reaches the pool threshold.
+ */
+enum LunaPayloadSize {
+    SmallPayload,
+    LargePayload
+};
+
+/*
+ * Replies to a method call. A large reply is serialized in the pool once it
+ * measures up to the JsonWorkerPool threshold. Replies are ordered only
+ * against the work of the given stream, e.g. the first reply to a
+ * subscriber against the updates of its subscription; any other small one
+ * is sent right away even while large ones are in the pool.
+ */
+bool replyLunaMessage(LSHandle* handle, LSMessage* message, const QJsonObject& reply, LunaPayloadSize size, const void* stream = 0);
+
+/*
+ * Parses a large reply to a call on a JsonWorkerPool thread and hands it
+ * to the receiver on the main loop
+ */
+template <class CLASS, void (CLASS::*FUNCTION)(QJsonObject)>
+class LunaCallbackJob : public JsonWorkerPool::Job {
+public:
+    LunaCallbackJob(CLASS* receiver, const char* payload, size_t size, const char* name, Histogram* latency)
+        : m_receiver(receiver)
+        , m_payload(payload, size)
+        , m_name(name)
+        , m_latency(latency)
+    {
+    }
+
+    void run() override
+    {
+        m_object = QJsonDocument::fromJson(m_payload).object();
+    }
+
+    void finished() override
+    {
+        WatchdogScope watchdogScope(m_name);
+        gint64 startTime = g_get_monotonic_time();
+        TRACE_EVENT_SCOPE("LunaReply", "callback", m_name);
+        (m_receiver->*FUNCTION)(m_object);
+        m_latency->observe(g_get_monotonic_time() - startTime);
+    }
+
+private:
+    CLASS* m_receiver;
+    QByteArray m_payload;
+    QJsonObject m_object;
+    const char* m_name;
+    Histogram* m_latency;
+};
+
+template <class CLASS, QJsonObject (CLASS::*FUNCTION)(QJsonObject), LunaPayloadSize SIZE = SmallPayload>
 static bool bus_callback_qjson(LSHandle* handle, LSMessage* message, void* user_data)
 {
     LSErrorSafe lsError;
@@ -145,18 +234,28 @@ static bool bus_callback_qjson(LSHandle* handle, LSMessage* message, void* user_
         return true;
     }
 
-    QJsonObject request = QJsonDocument::fromJson(LSMessageGetPayload(message)).object();
+    // One histogram and watchdog tag per method, this function is instantiated per method
+    static Histogram* s_latency = lunaMethodLatency(message);
+    static const char* s_watchdogTag = MainLoopWatchdog::persistentName(LSMessageGetMethod(message));
+    WatchdogScope watchdogScope(s_watchdogTag);
+    gint64 startTime = g_get_monotonic_time();
+    TRACE_EVENT_SCOPE("Luna", "method", LSMessageGetMethod(message));
+
+    if (LunaTrace::isRecording())
+        LunaTrace::record(LunaTrace::Call, LSMessageGetMethod(message), LSMessageGetPayload(message));
+
+    QJsonObject request = parseLunaPayload(message);
     QJsonObject reply;
 
     reply = (static_cast<CLASS*>(user_data)->*FUNCTION)(request);
 
-    if (!LSMessageReply(handle, message, QJsonDocument(reply).toJson().data(), &lsError))
-        return false;
+    bool replied = replyLunaMessage(handle, message, reply, SIZE);
+    s_latency->observe(g_get_monotonic_time() - startTime);
 
-    return true;
+    return replied;
 };
 
-template <class CLASS, QJsonObject (CLASS::*FUNCTION)(QJsonObject, bool subscribed)>
+template <class CLASS, QJsonObject (CLASS::*FUNCTION)(QJsonObject, bool subscribed), LunaPayloadSize SIZE = SmallPayload>
 static bool bus_subscription_callback_qjson(LSHandle* handle, LSMessage* message, void* user_data)
 {
     LSErrorSafe lsError;
@@ -167,13 +266,22 @@ static bool bus_subscription_callback_qjson(LSHandle* handle, LSMessage* message
         return true;
     }
 
+    static Histogram* s_latency = lunaMethodLatency(message);
+    static const char* s_watchdogTag = MainLoopWatchdog::persistentName(LSMessageGetMethod(message));
+    WatchdogScope watchdogScope(s_watchdogTag);
+    gint64 startTime = g_get_monotonic_time();
+    TRACE_EVENT_SCOPE("Luna", "method", LSMessageGetMethod(message));
+
     bool subscribed = false;
     if (LSMessageIsSubscription(message)) {
         if (!LSSubscriptionProcess(handle, message, &subscribed, &lsError))
             return false;
     }
 
-    QJsonObject request = QJsonDocument::fromJson(LSMessageGetPayload(message)).object();
+    if (LunaTrace::isRecording())
+        LunaTrace::record(subscribed ? LunaTrace::Subscription : LunaTrace::Call, LSMessageGetMethod(message), LSMessageGetPayload(message));
+
+    QJsonObject request = parseLunaPayload(message);
     QJsonObject reply;
 
     reply = (static_cast<CLASS*>(user_data)->*FUNCTION)(request, subscribed);
@@ -181,24 +289,109 @@ static bool bus_subscription_callback_qjson(LSHandle* handle, LSMessage* message
     if (subscribed)
         reply["subscribed"] = true;
 
-    if (!LSMessageReply(handle, message, QJsonDocument(reply).toJson().data(), &lsError))
-        return false;
+    // The first reply goes out ahead of the updates that follow it
+    const void* stream = subscribed ? static_cast<CLASS*>(user_data)->subscriptionStream(LSMessageGetMethod(message)) : 0;
+    bool replied = replyLunaMessage(handle, message, reply, SIZE, stream);
+    s_latency->observe(g_get_monotonic_time() - startTime);
 
-    return true;
+    return replied;
+};
+
+/*
+ * same as bus_callback_qjson, but the function is given the message as well and
+ * may return an empty object to reply later through an LSDeferredReply
+ */
+template <class CLASS, QJsonObject (CLASS::*FUNCTION)(QJsonObject, LSMessage*)>
+static bool bus_deferrable_callback_qjson(LSHandle* handle, LSMessage* message, void* user_data)
+{
+    LSErrorSafe lsError;
+
+    if (!message) {
+        if (!LSMessageReply(handle, message, "{\"returnValue\": false}", &lsError))
+            return false;
+        return true;
+    }
+
+    static Histogram* s_latency = lunaMethodLatency(message);
+    static const char* s_watchdogTag = MainLoopWatchdog::persistentName(LSMessageGetMethod(message));
+    WatchdogScope watchdogScope(s_watchdogTag);
+    gint64 startTime = g_get_monotonic_time();
+    TRACE_EVENT_SCOPE("Luna", "method", LSMessageGetMethod(message));
+
+    if (LunaTrace::isRecording())
+        LunaTrace::record(LunaTrace::Call, LSMessageGetMethod(message), LSMessageGetPayload(message));
+
+    QJsonObject reply = (static_cast<CLASS*>(user_data)->*FUNCTION)(parseLunaPayload(message), message);
+
+    bool replied = reply.isEmpty() || replyLunaMessage(handle, message, reply, SmallPayload);
+    s_latency->observe(g_get_monotonic_time() - startTime);
+
+    return replied;
+};
+
+/*
+ * Holds a reference to a message so that it can be replied to after its
+ * handler returned to the main loop. The reply is sent right away, like a
+ * small one of replyLunaMessage(), so it may overtake subscription updates
+ * still in the JsonWorkerPool.
+ */
+class LSDeferredReply {
+public:
+    explicit LSDeferredReply(LSMessage* message)
+        : m_message(message)
+    {
+        LSMessageRef(m_message);
+    }
+
+    ~LSDeferredReply()
+    {
+        LSMessageUnref(m_message);
+    }
+
+    bool reply(const QJsonObject& payload)
+    {
+        return reply(lunaPayload(payload).constData());
+    }
+
+    bool reply(const char* payload)
+    {
+        LSErrorSafe lsError;
+        return LSMessageRespond(m_message, payload, &lsError);
+    }
+
+private:
+    LSMessage* m_message;
 };
 
 /*
- * same as above, but for a void function handling the reply
+ * same as bus_callback_qjson, but for a void function handling the reply
  */
 template <class CLASS, void (CLASS::*FUNCTION)(QJsonObject)>
 static bool bus_callback_qjson(LSHandle* handle, LSMessage* message, void* user_data)
 {
+    // One name, histogram and watchdog tag per handler, this function is instantiated per handler
+    static const char* s_name = lunaCallbackName(__PRETTY_FUNCTION__);
+    static Histogram* s_latency = lunaCallbackLatency(s_name);
+    WatchdogScope watchdogScope(s_name);
+    gint64 startTime = g_get_monotonic_time();
+    TRACE_EVENT_SCOPE("LunaReply", "callback", s_name);
+
+    // Large replies, e.g. listApps of SAM, are parsed on a worker thread
+    const char* payload = message ? LSMessageGetPayload(message) : 0;
+    // Replies to one handler are handed over in order
+    size_t size = qstrlen(payload);
+    if (JsonWorkerPool::shouldOffload(size, s_name)) {
+        JsonWorkerPool::submit(new LunaCallbackJob<CLASS, FUNCTION>(static_cast<CLASS*>(user_data), payload, size, s_name, s_latency), s_name);
+        return true;
+    }
+
     QJsonObject reply;
     if (message) {
-        reply = QJsonDocument::fromJson(LSMessageGetPayload(message)).object();
+        reply = parseLunaPayload(payload);
     }
 
     (static_cast<CLASS*>(user_data)->*FUNCTION)(reply);
+    s_latency->observe(g_get_monotonic_time() - startTime);
 
     return true;
 };
@@ -233,28 +426,19 @@ public:
     /*
  * methods to post subscription updates TODO make subscriptions represented through objects
  **/
-    bool postSubscriptionPrivate(const char* subscription, QJsonObject reply)
+    bool postSubscriptionPrivate(const char* subscription, QJsonObject reply, LunaPayloadSize size = SmallPayload)
     {
-        LSErrorSafe lsError;
-        return LSSubscriptionPost(
-            m_serviceHandlePrivate,
-            category(),
-            subscription,
-            QJsonDocument(reply).toJson().data(),
-            &lsError);
+        return postSubscription(m_serviceHandlePrivate, subscription, reply, size);
     }
 
-    bool postSubscriptionPublic(const char* subscription, QJsonObject reply)
+    bool postSubscriptionPublic(const char* subscription, QJsonObject reply, LunaPayloadSize size = SmallPayload)
     {
-        LSErrorSafe lsError;
-        return LSSubscriptionPost(
-            m_serviceHandlePublic,
-            category(),
-            subscription,
-            QJsonDocument(reply).toJson().data(),
-            &lsError);
+        return postSubscription(m_serviceHandlePublic, subscription, reply, size);
     }
 
+    // Keeps the replies to new subscribers in order with the updates
+    const void* subscriptionStream(const char* subscription);
+
     virtual void didConnect() = 0;
 
 protected:
@@ -274,13 +458,13 @@ protected:
         bool err = false;
         if (parameters.value("subscribe").toBool() || parameters.value("watch").toBool()) {
             err = LSCall(m_serviceHandlePrivate, what,
-                QJsonDocument(parameters).toJson().data(),
+                lunaPayload(parameters).constData(),
                 bus_callback_qjson<HANDLER_CLASS, CALLBACK_METHOD>,
                 callback_receiver, NULL, &lsError);
         } else {
             err = LSCallOneReply(m_serviceHandlePrivate,
                 what,
-                QJsonDocument(parameters).toJson().data(),
+                lunaPayload(parameters).constData(),
                 bus_callback_qjson<HANDLER_CLASS, CALLBACK_METHOD>,
                 callback_receiver, NULL, &lsError);
         }
@@ -300,13 +484,13 @@ protected:
         bool err = false;
         if (parameters.value("subscribe").toBool() || parameters.value("watch").toBool()) {
             err = LSCall(m_serviceHandlePublic, what,
-                QJsonDocument(parameters).toJson().data(),
+                lunaPayload(parameters).constData(),
                 bus_callback_qjson<HANDLER_CLASS, CALLBACK_METHOD>,
                 callback_receiver, NULL, &lsError);
         } else {
             err = LSCallOneReply(m_serviceHandlePrivate,
                 what,
-                QJsonDocument(parameters).toJson().data(),
+                lunaPayload(parameters).constData(),
                 bus_callback_qjson<HANDLER_CLASS, CALLBACK_METHOD>,
                 callback_receiver, NULL, &lsError);
         }
@@ -327,12 +511,20 @@ protected:
     LSHandle* m_serviceHandlePrivate;
 
 private:
+    struct SubscriptionPosts {
+        Histogram* latency;
+    };
+
     static bool serviceConnectCallback(LSHandle* sh, LSMessage* message, void* ctx);
+    SubscriptionPosts& subscriptionPosts(const char* subscription);
+    bool postSubscription(LSHandle* handle, const char* subscription, const QJsonObject& reply, LunaPayloadSize size);
     bool call(LSHandle* service,
         const char* what,
         QJsonObject parameters,
         const char* applicationId,
         LSCalloutContext* context);
+
+    std::map<std::string, SubscriptionPosts> m_subscriptionPosts;
 };
 
 #endif /* PalmServiceBase_H */
@@ -57,19 +57,7 @@ void ServiceSenderLuna::launchContainerApp(const QString& id)
 
 void ServiceSenderLuna::postlistRunningApps(std::vector<ApplicationInfo> &apps)
 {
-    QJsonObject reply;
-    QJsonArray runningApps;
-    for (auto it = apps.begin(); it != apps.end(); ++it) {
-        QJsonObject app;
-        app["id"] = it->appId;
-        app["processid"] = it->instanceId;
-        app["webprocessid"] = QString::number(it->pid);
-        runningApps.append(app);
-    }
-    reply["running"] = runningApps;
-    reply["returnValue"] = true;
-
-    WebAppManagerServiceLuna::instance()->postSubscriptionPrivate("listRunningApps", reply);
+    WebAppManagerServiceLuna::instance()->postSubscriptionPrivate("listRunningApps", WebAppManagerService::runningAppsReply(apps), LargePayload);
 }
 
 void ServiceSenderLuna::postWebProcessCreated(const QString& appId, uint32_t pid)
@@ -86,7 +74,7 @@ void ServiceSenderLuna::serviceCall(const QString& url, const QString& payload,
 {
     bool ret = WebAppManagerServiceLuna::instance()->callPrivate(
                 url.toLatin1().constData(),
-                QJsonDocument::fromJson(payload.toStdString().c_str()).object(),
+                QJsonDocument::fromJson(payload.toUtf8()).object(),
                 appId.toLatin1().constData());
     if (!ret) {
         LOG_WARNING(MSGID_SERVICE_CALL_FAIL, 2, PMLOGKS("APP_ID", qPrintable(appId)), PMLOGKS("URL", qPrintable(url)), "ServiceSenderLuna::serviceCall; callPrivate() return false");
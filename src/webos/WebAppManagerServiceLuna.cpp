@@ -17,7 +17,13 @@
 
 #include "WebAppManagerServiceLuna.h"
 
+#include "BinaryLogger.h"
+#include "FlightRecorder.h"
+#include "LaunchTimeline.h"
 #include "LogManager.h"
+#include "RunningAppsPage.h"
+#include "StagedLaunch.h"
+#include "TraceEventRecorder.h"
 #include <QByteArray>
 #include <QJsonArray>
 #include <QStringList>
@@ -28,8 +34,13 @@
 // just to save some typing, the template filled out with the name of this class
 #define QCB(FUNC) bus_callback_qjson<WebAppManagerServiceLuna, &WebAppManagerServiceLuna::FUNC>
 #define QCB_subscription(FUNC) bus_subscription_callback_qjson<WebAppManagerServiceLuna, &WebAppManagerServiceLuna::FUNC>
+#define QCB_deferrable(FUNC) bus_deferrable_callback_qjson<WebAppManagerServiceLuna, &WebAppManagerServiceLuna::FUNC>
 #define LS2_METHOD_ENTRY(FUNC) {#FUNC, QCB(FUNC)}
 #define LS2_SUBSCRIPTION_ENTRY(FUNC) {#FUNC, QCB_subscription(FUNC)}
+#define LS2_DEFERRABLE_METHOD_ENTRY(FUNC) {#FUNC, QCB_deferrable(FUNC)}
+// Methods whose replies are serialized off the main loop
+#define LS2_LARGE_METHOD_ENTRY(FUNC) {#FUNC, bus_callback_qjson<WebAppManagerServiceLuna, &WebAppManagerServiceLuna::FUNC, LargePayload>}
+#define LS2_LARGE_SUBSCRIPTION_ENTRY(FUNC) {#FUNC, bus_subscription_callback_qjson<WebAppManagerServiceLuna, &WebAppManagerServiceLuna::FUNC, LargePayload>}
 
 #define GET_LS2_SERVER_STATUS(FUNC, PARAMS) callPrivate<WebAppManagerServiceLuna, &WebAppManagerServiceLuna::FUNC>("palm://com.palm.lunabus/signal/registerServerStatus", PARAMS, this)
 #define LS2_PRIVATE_CALL(FUNC, SERVICE, PARAMS) callPrivate<WebAppManagerServiceLuna, &WebAppManagerServiceLuna::FUNC>(SERVICE, PARAMS, this)
@@ -39,16 +50,23 @@ LSMethod WebAppManagerServiceLuna::s_publicMethods[] = {
 };
 
 LSMethod WebAppManagerServiceLuna::s_privateMethods[] = {
-    LS2_METHOD_ENTRY(launchApp),
+    LS2_DEFERRABLE_METHOD_ENTRY(launchApp),
+    LS2_METHOD_ENTRY(launchApps),
     LS2_METHOD_ENTRY(killApp),
+    LS2_METHOD_ENTRY(closeApps),
     LS2_METHOD_ENTRY(closeAllApps),
     LS2_METHOD_ENTRY(setInspectorEnable),
     LS2_METHOD_ENTRY(logControl),
     LS2_METHOD_ENTRY(discardCodeCache),
-    LS2_METHOD_ENTRY(getWebProcessSize),
+    LS2_LARGE_METHOD_ENTRY(getWebProcessSize),
+    LS2_LARGE_METHOD_ENTRY(getMetrics),
+    LS2_METHOD_ENTRY(traceControl),
+    LS2_LARGE_METHOD_ENTRY(getLaunchTimeline),
+    LS2_LARGE_METHOD_ENTRY(getFlightRecorder),
+    LS2_METHOD_ENTRY(getRunningAppsPage),
     LS2_METHOD_ENTRY(closeByProcessId),
     LS2_METHOD_ENTRY(clearBrowsingData),
-    LS2_SUBSCRIPTION_ENTRY(listRunningApps),
+    LS2_LARGE_SUBSCRIPTION_ENTRY(listRunningApps),
     LS2_SUBSCRIPTION_ENTRY(webProcessCreated),
     { 0, 0 }
 };
@@ -69,83 +87,56 @@ bool WebAppManagerServiceLuna::startService()
     return PalmServiceBase::startService();
 }
 
-QJsonObject WebAppManagerServiceLuna::launchApp(QJsonObject request)
-{
-    int errCode;
-    std::string errMsg;
-    QJsonObject reply;
-
-    if (  !request["appDesc"].isObject()
-       || !request["parameters"].isObject()
-       || !request["launchingAppId"].isString()
-       || !request["launchingProcId"].isString()) {
-        reply["returnValue"] = false;
-        reply["errorCode"] = ERR_CODE_LAUNCHAPP_MISS_PARAM;
-        reply["errorText"] = QString::fromStdString(err_missParam);
-        return reply;
+// Replies to a launchApp call once its staged launch has created the app
+class LaunchAppDeferredReply : public StagedLaunch::Client {
+public:
+    LaunchAppDeferredReply(LSMessage* message, const QJsonValue& appId)
+        : m_reply(message)
+        , m_appId(appId)
+    {
     }
 
-    QJsonDocument doc(request["parameters"].toObject());
-    QJsonObject jsonParams = doc.object();
-    if(request["launchHidden"].toBool()) {
-        jsonParams["launchedHidden"] = true;
+    void launchFinished(const std::string& instanceId, int errCode, const std::string& errMsg) override
+    {
+        if (!instanceId.empty())
+            LaunchTimeline::mark(QString::fromStdString(instanceId), LaunchTimeline::PhaseReplied);
+        m_reply.reply(launchAppReply(m_appId, instanceId, errCode, errMsg));
+        delete this;
     }
 
-    // if "preload" parameter is not "full" or "partial" or "minimal", there is no preload parameter.
-    if (request["preload"].isString()) {
-        jsonParams["preload"] = request["preload"].toString();
-    }
+private:
+    LSDeferredReply m_reply;
+    QJsonValue m_appId;
+};
 
-    if(request["keepAlive"].toBool()) {
-        jsonParams["keepAlive"] = true;
-    }
-    doc.setObject(jsonParams);
-    QString params(doc.toJson());
+QJsonObject WebAppManagerServiceLuna::launchApp(QJsonObject request)
+{
+    return launchApp(request, 0);
+}
 
-    std::string appId = request["appDesc"].toObject()["id"].toString().toStdString();
-    LOG_INFO_WITH_CLOCK(MSGID_APPLAUNCH_START, 3,
-                        PMLOGKS("PerfType","AppLaunch"),
-                        PMLOGKS("PerfGroup", appId.c_str()),
-                        PMLOGKS("APP_ID", appId.c_str()), "params : %s", qPrintable(params));
+QJsonObject WebAppManagerServiceLuna::launchApp(QJsonObject request, LSMessage* message)
+{
+    // Called from the bus, a cold launch is answered by its stages later on
+    StagedLaunch* staged = 0;
+    QJsonObject reply = WebAppManagerService::onLaunchAppRequest(request, message ? &staged : 0);
+    if (staged)
+        staged->setClient(new LaunchAppDeferredReply(message, request["appDesc"].toObject()["id"]));
+    return reply;
+}
 
-    std::string instanceId;
-    instanceId = WebAppManagerService::onLaunch(
-                    QJsonDocument(request["appDesc"].toObject()).toJson().data(),
-                    params.toStdString(),
-                    request["launchingAppId"].toString().toStdString(),
-                    errCode, errMsg);
+QJsonObject WebAppManagerServiceLuna::launchApps(QJsonObject request)
+{
+    return WebAppManagerService::onLaunchAppsRequest(request);
+}
 
-    if (instanceId.empty()) {
-        reply["returnValue"] = false;
-        reply["errorCode"] = errCode;
-        reply["errorText"] = QString::fromStdString(errMsg);
-    }
-    else {
-        reply["returnValue"] = true;
-        reply["appId"] = request["appDesc"].toObject()["id"];
-        reply["procId"] = QString::fromStdString(instanceId);
-    }
-    return reply;
+QJsonObject WebAppManagerServiceLuna::closeApps(QJsonObject request)
+{
+    return WebAppManagerService::onCloseAppsRequest(request);
 }
 
 QJsonObject WebAppManagerServiceLuna::killApp(QJsonObject request)
 {
-    bool instances;
-    instances = WebAppManagerService::onKillApp(request["appId"].toString().toStdString());
-
-    QJsonObject reply;
-    if(instances)
-    {
-        reply["appId"] = request["appId"].toString();
-        reply["returnValue"] = true;
-    }
-    else
-    {
-        reply["returnValue"] = false;
-        reply["errorCode"] = ERR_CODE_KILLAPP_NO_APP;
-        reply["errorText"] = QString::fromStdString(err_noRunningApp);
-    }
-    return reply;
+    return WebAppManagerService::onKillAppRequest(request);
 }
 
 QJsonObject WebAppManagerServiceLuna::setInspectorEnable(QJsonObject request)
@@ -233,26 +224,107 @@ QJsonObject WebAppManagerServiceLuna::getWebProcessSize(QJsonObject request)
     return reply;
 }
 
-QJsonObject WebAppManagerServiceLuna::listRunningApps(QJsonObject request, bool subscribed)
+QJsonObject WebAppManagerServiceLuna::getMetrics(QJsonObject request)
 {
-    bool includeSysApps = request["includeSysApps"].toBool();
+    // "format": "text" returns the Prometheus text exposition instead of
+    // JSON, close, broadcast and frame timing statistics are JSON only
+    QJsonObject reply = WebAppManagerService::onGetMetrics(request["format"].toString() == QLatin1String("text"));
+    reply["returnValue"] = true;
+    return reply;
+}
 
-    std::vector<ApplicationInfo> apps = WebAppManagerService::list(includeSysApps);
+QJsonObject WebAppManagerServiceLuna::traceControl(QJsonObject request)
+{
+    // {"enable": true|false} starts or stops recording, {"dump": true}
+    // writes the recorded events as Chrome trace JSON to WAM_TRACE_EVENTS_FILE
+    QJsonObject reply;
+    if (request.contains("dump") && !request["dump"].isBool()) {
+        reply["returnValue"] = false;
+        reply["errorText"] = QStringLiteral("dump takes true, the file is configured by WAM_TRACE_EVENTS_FILE");
+        return reply;
+    }
+
+    if (request["enable"].isBool())
+        TraceEventRecorder::setEnabled(request["enable"].toBool());
+
+    if (request["dump"].toBool()) {
+        if (!TraceEventRecorder::dump()) {
+            reply["returnValue"] = false;
+            reply["errorText"] = QStringLiteral("Failed to write trace events");
+            return reply;
+        }
+        reply["path"] = QString::fromStdString(TraceEventRecorder::dumpPath());
+    }
+
+    reply["enabled"] = TraceEventRecorder::isEnabled();
+    reply["events"] = TraceEventRecorder::eventCount();
+    reply["returnValue"] = true;
+    return reply;
+}
+
+QJsonObject WebAppManagerServiceLuna::getLaunchTimeline(QJsonObject request)
+{
+    // {"count": N} limits the launches to the last N, {"appId": id} to one app
+    int count = request["count"].isDouble() ? request["count"].toInt() : 10;
+
+    QJsonObject reply = LaunchTimeline::toJson(count, request["appId"].toString());
+    reply["returnValue"] = true;
+    return reply;
+}
+
+QJsonObject WebAppManagerServiceLuna::getFlightRecorder(QJsonObject request)
+{
+    // {"dump": true} also writes the events to WAM_FLIGHT_RECORDER_FILE and,
+    // while the binary log is on, its recent records to WAM_BINARY_LOG_DUMP_FILE
+    QJsonObject reply;
+    if (request.contains("dump") && !request["dump"].isBool()) {
+        reply["returnValue"] = false;
+        reply["errorText"] = QStringLiteral("dump takes true, the file is configured by WAM_FLIGHT_RECORDER_FILE");
+        return reply;
+    }
+
+    if (request["dump"].toBool()) {
+        if (!FlightRecorder::dump()) {
+            reply["returnValue"] = false;
+            reply["errorText"] = QStringLiteral("Failed to write flight recorder events");
+            return reply;
+        }
+        reply["path"] = QString::fromUtf8(FlightRecorder::dumpPath());
+        if (BinaryLogger::isEnabled() && BinaryLogger::dump())
+            reply["binaryLogPath"] = QString::fromStdString(BinaryLogger::dumpPath());
+    }
 
+    reply["events"] = FlightRecorder::toJson();
+    reply["returnValue"] = true;
+    return reply;
+}
+
+QJsonObject WebAppManagerServiceLuna::getRunningAppsPage(QJsonObject request)
+{
+    // Luna can not carry the memfd itself, so readers open its /proc path,
+    // see src/client/wam_running_apps.h
     QJsonObject reply;
-    QJsonArray runningApps;
-    for (auto it = apps.begin(); it != apps.end(); ++it) {
-        QJsonObject app;
-        app["id"] = it->appId;
-        app["processid"] = it->instanceId;
-        app["webprocessid"] = QString::number(it->pid);
-        runningApps.append(app);
-    }
-    reply["running"] = runningApps;
+    if (!RunningAppsPage::isStarted()) {
+        reply["returnValue"] = false;
+        reply["errorText"] = QStringLiteral("Running apps page is not available");
+        return reply;
+    }
+
+    WebAppManagerService::onRunningAppsPageRequested();
+    reply["path"] = QString::fromStdString(RunningAppsPage::path());
+    reply["size"] = static_cast<int>(RunningAppsPage::size());
+    reply["version"] = WAM_RUNNING_APPS_VERSION;
     reply["returnValue"] = true;
     return reply;
 }
 
+QJsonObject WebAppManagerServiceLuna::listRunningApps(QJsonObject request, bool subscribed)
+{
+    bool includeSysApps = request["includeSysApps"].toBool();
+
+    return WebAppManagerService::runningAppsReply(WebAppManagerService::list(includeSysApps));
+}
+
 QJsonObject WebAppManagerServiceLuna::closeByProcessId(QJsonObject request)
 {
     QJsonObject reply = WebAppManagerService::closeByInstanceId(request["processId"].toString());
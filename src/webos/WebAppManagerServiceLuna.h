@@ -41,9 +41,19 @@ public:
     QJsonObject listRunningApps(QJsonObject request, bool subscribed) override;
     QJsonObject closeByProcessId(QJsonObject request) override;
     QJsonObject getWebProcessSize(QJsonObject request) override;
+    QJsonObject getMetrics(QJsonObject request) override;
     QJsonObject clearBrowsingData(QJsonObject request) override;
     QJsonObject webProcessCreated(QJsonObject request, bool subscribed) override;
 
+    // WebAppManagerServiceLuna
+    QJsonObject launchApp(QJsonObject request, LSMessage* message);
+    QJsonObject launchApps(QJsonObject request);
+    QJsonObject closeApps(QJsonObject request);
+    QJsonObject traceControl(QJsonObject request);
+    QJsonObject getLaunchTimeline(QJsonObject request);
+    QJsonObject getFlightRecorder(QJsonObject request);
+    QJsonObject getRunningAppsPage(QJsonObject request);
+
     // PlamServiceBase
     void didConnect() override;
 
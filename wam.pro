@@ -21,5 +21,31 @@ wamcorelib.file = wamcorelib.pri
 wamlib.file = wamlib.pri
 wamplugin.file = wamplugin.pri
 wam.file = wam.pri
+wamrunningapps.file = wamrunningapps.pri
 
-SUBDIRS += wamcorelib wamlib wamplugin wam
+# EXTRA_QMAKEVARS_PRE += "CONFIG_BUILD+=headless"
+# Only core and the benchmarks, which run it on the stub engine
+contains(CONFIG_BUILD, headless) {
+    SUBDIRS += wamcorelib
+    CONFIG_BUILD += benchmark
+} else {
+    SUBDIRS += wamcorelib wamlib wamplugin wam
+}
+
+# Reader library for local services, built in every configuration
+SUBDIRS += wamrunningapps
+
+# EXTRA_QMAKEVARS_PRE += "CONFIG_BUILD+=benchmark"
+contains(CONFIG_BUILD, benchmark) {
+    wambenchmark.file = wambenchmark.pri
+    wamlunareplay.file = wamlunareplay.pri
+    wamsoak.file = wamsoak.pri
+    SUBDIRS += wambenchmark wamlunareplay wamsoak
+}
+
+# EXTRA_QMAKEVARS_PRE += "CONFIG_BUILD+=tools"
+contains(CONFIG_BUILD, tools) {
+    wamlogdecoder.file = wamlogdecoder.pri
+    wamlunaload.file = wamlunaload.pri
+    SUBDIRS += wamlogdecoder wamlunaload
+}
@@ -19,16 +19,32 @@ TEMPLATE = lib
 include(common.pri)
 
 SOURCES += \
+        AppCloseStatistics.cpp \
         ApplicationDescription.cpp \
+        BinaryLogFormat.cpp \
+        BinaryLogger.cpp \
+        BroadcastService.cpp \
         ContainerAppManager.cpp \
         DeviceInfo.cpp \
+        FlightRecorder.cpp \
+        HibernatedAppManager.cpp \
+        JsInjectionQueue.cpp \
+        JsonWorkerPool.cpp \
+        LaunchTimeline.cpp \
+        LogChannel.cpp \
         LogManager.cpp \
         LogManagerPmLog.cpp \
+        LunaTrace.cpp \
+        MainLoopWatchdog.cpp \
+        Metrics.cpp \
         NetworkStatus.cpp \
         NetworkStatusManager.cpp \
         PalmSystemBase.cpp \
         PlugInService.cpp \
+        RunningAppsPage.cpp \
+        StagedLaunch.cpp \
         Timer.cpp \
+        TraceEventRecorder.cpp \
         WebAppBase.cpp \
         WebAppFactoryManager.cpp \
         WebAppManager.cpp \
@@ -40,20 +56,37 @@ SOURCES += \
         WebProcessManager.cpp
 
 HEADERS += \
+        AppCloseStatistics.h \
         ApplicationDescription.h \
+        BinaryLogFormat.h \
+        BinaryLogger.h \
+        BroadcastService.h \
         ContainerAppManager.h \
         DeviceInfo.h \
+        FlightRecorder.h \
+        HibernatedAppManager.h \
+        JsInjectionQueue.h \
+        JsonWorkerPool.h \
+        LaunchTimeline.h \
+        LogChannel.h \
         LogManager.h \
         LogManagerPmLog.h \
         LogMsgId.h \
+        LunaTrace.h \
+        MainLoopWatchdog.h \
+        Metrics.h \
         NetworkStatus.h \
         NetworkStatusManager.h \
         ObserverList.h \
         PalmSystemBase.h \
         PlatformModuleFactory.h \
         PlugInService.h \
+        RunningAppsPage.h \
+        RunningAppsPageLayout.h \
         ServiceSender.h \
+        StagedLaunch.h \
         Timer.h \
+        TraceEventRecorder.h \
         WebAppBase.h \
         WebAppFactoryInterface.h \
         WebAppFactoryManager.h \
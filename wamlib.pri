@@ -26,6 +26,8 @@ SOURCES += \
     BlinkWebView.cpp \
     BlinkWebViewProfileHelper.cpp \
     DeviceInfoImpl.cpp \
+    FrameTimingCollector.cpp \
+    InputLatencyTracker.cpp \
     PalmServiceBase.cpp \
     PalmSystemBlink.cpp \
     PalmSystemWebOS.cpp \
@@ -44,6 +46,8 @@ HEADERS += \
     BlinkWebView.h \
     BlinkWebViewProfileHelper.h \
     DeviceInfoImpl.h \
+    FrameTimingCollector.h \
+    InputLatencyTracker.h \
     PalmServiceBase.h \
     PalmSystemBlink.h \
     PalmSystemWebOS.h \
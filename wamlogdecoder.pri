@@ -0,0 +1,37 @@
+# Copyright (c) 2018 LG Electronics, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+TEMPLATE = app
+
+# Offline tool, only shares the record layout with libWebAppMgrCore
+CONFIG -= qt
+QMAKE_CXXFLAGS += -std=c++11 -Wall -Werror
+
+VPATH += ./src/tools ./src/util
+INCLUDEPATH += ./src/util
+
+SOURCES += \
+        BinaryLogDecoder.cpp \
+        BinaryLogFormat.cpp
+
+HEADERS += \
+        BinaryLogFormat.h
+
+TARGET = wam-logdecode
+
+target.path = $${PREFIX}/bin
+
+INSTALLS += target
@@ -0,0 +1,39 @@
+# Copyright (c) 2018 LG Electronics, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+TEMPLATE = app
+
+# Luna client only, talks to a running WAM over the bus
+CONFIG += link_pkgconfig
+QT = core
+QMAKE_CXXFLAGS += -std=c++11 -Wall -Werror
+
+# Registers on the private bus with the pub/prv API, like wamlib
+DEFINES += SECURITY_COMPATIBILITY
+
+VPATH += ./src/tools
+
+SOURCES += \
+        LunaLoadGenerator.cpp
+
+PKGCONFIG += glib-2.0
+LIBS += -llunaservice
+
+TARGET = wam-lunaload
+
+target.path = $${PREFIX}/bin
+
+INSTALLS += target
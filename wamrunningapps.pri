@@ -0,0 +1,47 @@
+# Copyright (c) 2018 LG Electronics, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+TEMPLATE = lib
+
+# C reader of the running apps page, needs neither Qt nor the rest of WAM
+CONFIG -= qt
+QMAKE_CFLAGS += -std=gnu99 -Wall -Werror
+
+VPATH += ./src/client ./src/util
+INCLUDEPATH += ./src/client ./src/util
+
+SOURCES += \
+        wam_running_apps.c
+
+HEADERS += \
+        RunningAppsPageLayout.h \
+        wam_running_apps.h
+
+TARGET = wam-running-apps
+
+headers.files = $$HEADERS
+headers.path = $${PREFIX}/include/webappmanager
+target.path = $${PREFIX}/lib
+
+# All of the three are needed to create to .pc file
+CONFIG += create_pc create_prl no_install_prl
+QMAKE_PKGCONFIG_NAME = libwam-running-apps
+QMAKE_PKGCONFIG_DESCRIPTION = Reader of the running apps page of Web Application Manager
+QMAKE_PKGCONFIG_LIBDIR = $$target.path
+QMAKE_PKGCONFIG_INCDIR = $$headers.path
+QMAKE_PKGCONFIG_DESTDIR = pkgconfig
+
+INSTALLS += target headers